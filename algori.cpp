@@ -6,32 +6,61 @@
 * Simulation code for sorting and searching algorithms in C++ and SFML.
 *
 * The sorting algorithms Bubble Sort, Quick Sort, Insertion Sort,
-* Selection Sort, Merge Sort, Heap Sort, Bucket Sort, Gnome Sort, Tim Sort and Cycle Sort are included.
+* Selection Sort, Merge Sort, Heap Sort (classic, hole-based, bottom-up and 4-/8-ary variants), Bucket Sort, Gnome Sort, Tim Sort, Cycle Sort,
+* Multiway Merge Sort (k-way merges through a loser tree) and SIMD Sort (AVX2 bitonic networks and
+* vector partitioning, with a scalar fallback), a parallel Sample Sort and an in-place stable
+* Block Merge Sort (GrailSort-style, internal buffer) are included, as is an Auto Sort that
+* profiles its input and runs the candidate a calibrated cost model predicts to be fastest.
 * Additionally, the search algorithms Linear Search, Binary Search and
-* Ternary Search are included. The tree traversal algorithms BFS and DFS are also included.
+* Ternary Search are included, as are selection and top-k algorithms: Quickselect, Introselect
+* (median-of-medians fallback), Floyd–Rivest, a bounded-heap top-k and a streaming top-k that
+* filters candidates with AVX2 compares. The tree traversal algorithms BFS and DFS are also included, as are
+* weighted shortest paths: Dijkstra over binary, 4-ary, pairing and radix heaps, and A* on grid maps,
+* plus parallel connected components (lock-free union-find, Afforest) and a parallel Kahn topological order,
+* on seeded trees, grids and random graphs generated in parallel.
+* An online sort keeps streamed keys (generated, from a file or a pipe) sorted as they arrive, in a
+* B-tree or an LSM-style buffer of merged runs, and reports insert latency and visible throughput.
 *
 * The simulation allows the sorting and searching process to be visualized in real time.
 * The simulation can be paused, resumed and restarted at any time. In addition, the algorithm to be visualized and the type of visualization (sorting,
-* searching or tree traversal) can be selected from a simple 'drop-down' menu.
+* searching, selection, streaming or tree traversal) can be selected from a simple 'drop-down' menu.
 
 * The code is structured as follows:
 * 1. Global variables and constants.
-* 2. Utility functions.
-* 3. Sorting functions.
-* 4. Search functions.
-* 5. Tree traversal functions.
-* 6. Initialization and reset functions.
-* 7. Main function.
+* 2. Trace events (Chrome/Perfetto timeline export).
+* 3. Event streaming (WebSocket server for remote viewers).
+* 4. Element types, parallel helpers, scratch arena and seeded input generators.
+* 5. Utility functions.
+* 6. Loser tree, sorting networks and algorithm policies (native and visual instrumentation).
+* 7. Sorting functions.
+* 8. Vectorized sort.
+* 9. Parallel sample sort.
+* 10. In-place block merge sort.
+* 11. Search functions.
+* 12. Selection functions (quickselect, introselect, Floyd–Rivest and top-k).
+* 13. Algorithm registry.
+* 14. Adaptive sort (input profile and a calibrated cost model).
+* 15. Weighted graphs (CSR graphs, grid maps, priority queues, Dijkstra and A*).
+* 16. Graph analysis (edge lists, parallel connected components and topological order).
+* 17. Graph generators (seeded trees, grids, Erdős–Rényi, R-MAT and Barabási–Albert graphs, binary cache).
+* 18. Online sort (stream sources, B-tree and LSM buffers, insert latency histogram).
+* 19. Tree traversal functions.
+* 20. Initialization and reset functions.
+* 21. UI widgets (data-driven button table and cached chrome).
+* 22. Frame pacing.
+* 23. Benchmark mode.
+* 24. Memory-mapped datasets.
+* 25. External merge sort.
+* 26. Streaming mode (headless online sort).
+* 27. Main function.
 *
-* The code is designed to be as simple and clear as possible. Regarding its operation,
-* it may be that due to the handling of threads and data synchronization, the simulation does not take
-* so you have to press start twice for it to start working, but they are all
-* functional, perhaps in a future update the code can be improved so that it
-* works correctly in that aspect.
+* The code is designed to be as simple and clear as possible. Every algorithm is a template over
+* a policy: the visual policy animates the bars and honours pause/reset, the native policy compiles
+* to a plain implementation that the headless benchmark (--bench) times.
 
 * Requirements:
 * - SFML library.
-* - C++11 or higher.
+* - C++17 or higher.
 * - A C++ compiler.
 * Arial named font file in the same directory as the code.
 *
@@ -52,10 +81,64 @@
 #include <unordered_map>
 #include <random>
 #include <iostream>
+#include <fstream>
 #include <cmath>
 #include <list>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <ctime>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <iterator>
+#include <cerrno>
+#include <future>
+#include <memory>
+#include <limits>
+#include <deque>
+#include <cctype>
+#include <cassert>
+#include <filesystem>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <time.h>
+#endif
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+// AVX2 kernels are compiled per function (target attribute), so the binary still starts on CPUs
+// without AVX2 and picks them at runtime.
+#if defined(__x86_64__) || defined(_M_X64)
+#define ALGORI_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define ALGORI_AVX2
+#else
+#define ALGORI_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define ALGORI_X86 0
+#endif
 
 
 //.....................................| Constants & global variabless |.....................................//
@@ -72,9 +155,11 @@ const int BOX_SPACING = 5;
 const int ARRAY_START_X = 100;
 const int ARRAY_START_Y = 700;
 const int MAX_ARRAY_SIZE = (WINDOW_WIDTH - ARRAY_START_X) / (BOX_SIZE + BOX_SPACING);
+const int ANIMATION_FPS = 60; // -> frame cap while an algorithm is animating, idle frames block on events
 
 std::thread currentThread;
-std::vector<int> array(NUM_BARS);
+std::vector<int> array(NUM_BARS);       // -> values behind the sorting bars
+std::vector<int> searchArray(MAX_ARRAY_SIZE); // -> sorted values behind the search boxes
 std::vector<sf::RectangleShape> bars(NUM_BARS);
 std::vector<sf::CircleShape> nodes;
 std::vector<sf::VertexArray> edges;
@@ -83,1448 +168,9171 @@ std::vector<sf::RectangleShape> boxes;
 std::vector<sf::Text> boxTexts;
 std::atomic<bool> isSorting(false);
 std::atomic<bool> isPaused(false);
-std::atomic<bool> resetRequested(false);
+std::atomic<unsigned> runGeneration(0); // -> bumped by resetAll(), runs from an older generation stop at their next check
+std::atomic<unsigned long long> visualOps(0); // -> steps of the animated runs: compares, writes, probes, relaxations, expansions
 std::string currentAlgorithm = "bubble";
 std::atomic<bool> isSearching(false);
 int searchValue = 0;
 std::atomic<bool> isTreeTraversal(false);
 std::vector<std::vector<int>> tree;
-std::vector<bool> visited;
 std::string visualizationType = "sort";
 bool showDropdown = false;
 sf::Font font;
 int targetNode = -1;
-std::vector<int> traversalPath;
-int currentTraversalIndex = 0;
 bool isArraySorted = false;
 bool isSearchArraySorted = true;
 std::atomic<bool> searchCompleted(false);
 std::atomic<bool> traversalCompleted(false);
-std::mutex mtx;
-
-//.....................................| Utility functions |.....................................//
-void resetArray() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dist(50, 700);
-    for (int i = 0; i < NUM_BARS; ++i) {
-        array[i] = dist(gen);
-        bars[i].setSize(sf::Vector2f(BAR_WIDTH, array[i]));
-        bars[i].setPosition(i * BAR_WIDTH, WINDOW_HEIGHT - array[i]);
-        bars[i].setFillColor(sf::Color::White);
+std::uint64_t visualSeed = 0;     // -> --seed, printed at startup so a session can be replayed
+std::uint64_t visualResets = 0;
+std::atomic<bool> sceneDirty(true); // -> set whenever the bars, boxes or nodes change outside of an animation
+std::mutex runWakeMutex;           // -> with runWake: sleeping and paused runs wake up on a reset or resume
+std::condition_variable runWake;
+
+typedef std::ptrdiff_t Index; // -> element positions, wide enough for the headless benchmark sizes
+
+//.....................................| Trace events |.....................................//
+// Chrome/Perfetto trace export (--trace out.json, open it in ui.perfetto.dev or chrome://tracing).
+// Every thread appends to a buffer of its own: the owner writes the next slot and publishes it with
+// a release store of the size, so recording never takes a lock and the exporter can read any
+// buffer at any time. A buffer holds TRACE_CAPACITY events, later ones are counted as dropped.
+// Threads that end hand their buffer back and the next thread with the same name reuses it, so
+// short-lived workers share a few timeline tracks. Names must be string literals (or otherwise
+// outlive the trace), only their pointers are stored.
+const std::size_t TRACE_CAPACITY = 1 << 16;
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    char phase;          // -> 'X' complete span, 'C' counter
+    std::uint64_t begin; // -> ns since traceEpoch
+    std::uint64_t duration;
+    double value;
+};
+
+struct TraceBuffer {
+    std::unique_ptr<TraceEvent[]> events{new TraceEvent[TRACE_CAPACITY]};
+    std::atomic<std::size_t> size{0};
+    std::atomic<std::size_t> dropped{0};
+    const char* name = "thread";
+    bool inUse = false; // -> guarded by traceRegistryMutex, only taken when a thread records its first event
+};
+
+std::atomic<bool> traceEnabled(false);
+const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+std::vector<std::unique_ptr<TraceBuffer>> traceBuffers;
+std::mutex traceRegistryMutex;
+
+struct TraceThread { // -> thread-local handle, returns the buffer when the thread exits
+    TraceBuffer* buffer = nullptr;
+    const char* name = "thread";
+    ~TraceThread() {
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(traceRegistryMutex);
+            buffer->inUse = false;
+        }
     }
-    isArraySorted = false;
-}
-
-void resetTree() {
-    std::lock_guard<std::mutex> lock(mtx);
-    
-    nodes.clear();
-    edges.clear();
-    nodePositions.clear();
-    visited.assign(tree.size(), false);
-    traversalPath.clear();
-    currentTraversalIndex = 0;
-    traversalCompleted = false;
-    isTreeTraversal = false;
+};
+thread_local TraceThread traceThread;
 
-    std::queue<std::pair<int, sf::Vector2f>> q;
-    q.push({0, sf::Vector2f(WINDOW_WIDTH / 2, TREE_START_Y)});
-    while (!q.empty()) {
-        auto [node, pos] = q.front();
-        q.pop();
-        sf::CircleShape nodeShape(NODE_RADIUS);
-        nodeShape.setFillColor(sf::Color::White);
-        nodeShape.setPosition(pos - sf::Vector2f(NODE_RADIUS, NODE_RADIUS));
-        nodePositions[node] = pos;
-        nodes.push_back(nodeShape);
+std::uint64_t traceNow() {
+    return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count());
+}
 
-        int childCount = tree[node].size();
-        float startX = pos.x - (childCount - 1) * NODE_SPACING / 2;
-        for (int i = 0; i < childCount; ++i) {
-            int child = tree[node][i];
-            sf::Vector2f childPos(startX + i * NODE_SPACING, pos.y + NODE_SPACING);
-            q.push({child, childPos});
+void traceThreadName(const char* name) { // -> call before the thread records anything
+    traceThread.name = name;
+}
 
-            sf::VertexArray edge(sf::Lines, 2);
-            edge[0].position = pos;
-            edge[1].position = childPos;
-            edge[0].color = sf::Color::White;
-            edge[1].color = sf::Color::White;
-            edges.push_back(edge);
+TraceBuffer* traceBuffer() {
+    if (!traceThread.buffer) {
+        std::lock_guard<std::mutex> lock(traceRegistryMutex);
+        for (auto& buffer : traceBuffers) {
+            if (!buffer->inUse && std::strcmp(buffer->name, traceThread.name) == 0) {
+                traceThread.buffer = buffer.get();
+                break;
+            }
+        }
+        if (!traceThread.buffer) {
+            traceBuffers.emplace_back(new TraceBuffer());
+            traceThread.buffer = traceBuffers.back().get();
+            traceThread.buffer->name = traceThread.name;
         }
+        traceThread.buffer->inUse = true;
     }
+    return traceThread.buffer;
 }
 
-void resetBoxes() { // -> reseting array boxes
-    boxes.clear();
-    boxTexts.clear();
-    for (int i = 0; i < MAX_ARRAY_SIZE; ++i) {
-        sf::RectangleShape box(sf::Vector2f(BOX_SIZE, BOX_SIZE));
-        box.setPosition(ARRAY_START_X + i * (BOX_SIZE + BOX_SPACING), ARRAY_START_Y);
-        box.setFillColor(sf::Color::White);
-        boxes.push_back(box);
-
-        sf::Text text;
-        text.setFont(font);
-        text.setString(std::to_string(array[i]));
-        text.setCharacterSize(20);
-        text.setFillColor(sf::Color::Black);
-        text.setPosition(ARRAY_START_X + i * (BOX_SIZE + BOX_SPACING) + BOX_SIZE / 4, ARRAY_START_Y + BOX_SIZE / 4);
-        boxTexts.push_back(text);
+void traceRecord(const TraceEvent& event) {
+    TraceBuffer* buffer = traceBuffer();
+    std::size_t slot = buffer->size.load(std::memory_order_relaxed);
+    if (slot == TRACE_CAPACITY) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
     }
-    searchCompleted = false;
+    buffer->events[slot] = event;
+    buffer->size.store(slot + 1, std::memory_order_release);
 }
 
-void resetSearchArray() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dist(1, 150);
-    array.resize(MAX_ARRAY_SIZE);
-    for (int i = 0; i < MAX_ARRAY_SIZE; ++i) {
-        array[i] = dist(gen);
+void traceCounter(const char* name, double value) {
+    if (traceEnabled.load(std::memory_order_relaxed)) {
+        traceRecord(TraceEvent{name, "counter", 'C', traceNow(), 0, value});
     }
-    std::sort(array.begin(), array.end());
-    isSearchArraySorted = true;
-    resetBoxes();
 }
 
-void drawArray(sf::RenderWindow& window) {// -> drawing the array
-    for (int i = 0; i < NUM_BARS; ++i) {
-        window.draw(bars[i]);
+class TraceSpan { // -> scoped span, one complete event written when it closes
+public:
+    explicit TraceSpan(const char* name, const char* category = "algorithm")
+        : name(name), category(category), begin(traceEnabled.load(std::memory_order_relaxed) ? traceNow() : 0),
+          active(traceEnabled.load(std::memory_order_relaxed)) {}
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+    ~TraceSpan() {
+        if (active) {
+            traceRecord(TraceEvent{name, category, 'X', begin, traceNow() - begin, 0});
+        }
     }
-}
 
-void drawTree(sf::RenderWindow& window) {
-    for (const auto& edge : edges) {
-        window.draw(edge);
+private:
+    const char* name;
+    const char* category;
+    std::uint64_t begin;
+    bool active;
+};
+
+bool writeTrace(const std::string& path) { // -> Chrome trace JSON, one track per buffer
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        return false;
     }
-    for (int i = 0; i < nodes.size(); ++i) {
-        window.draw(nodes[i]);
-        sf::Text text;
-        text.setFont(font);
-        text.setString(std::to_string(i));
-        text.setCharacterSize(20);
-        text.setFillColor(sf::Color::Black);
-        text.setPosition(nodePositions[i] - sf::Vector2f(NODE_RADIUS / 2, NODE_RADIUS / 2));
-        window.draw(text);
+    std::lock_guard<std::mutex> lock(traceRegistryMutex);
+    std::fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    auto separator = [&] {
+        std::fprintf(out, first ? "" : ",\n");
+        first = false;
+    };
+    std::size_t dropped = 0;
+    for (std::size_t tid = 0; tid < traceBuffers.size(); ++tid) {
+        const TraceBuffer& buffer = *traceBuffers[tid];
+        separator();
+        std::fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s %zu\"}}", tid,
+                     buffer.name, tid);
+        std::size_t size = buffer.size.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < size; ++i) {
+            const TraceEvent& event = buffer.events[i];
+            separator();
+            if (event.phase == 'X') {
+                std::fprintf(out, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+                             event.name, event.category, tid, event.begin / 1000.0, event.duration / 1000.0);
+            } else {
+                std::fprintf(out, "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"args\":{\"value\":%g}}",
+                             event.name, tid, event.begin / 1000.0, event.value);
+            }
+        }
+        dropped += buffer.dropped.load(std::memory_order_relaxed);
     }
+    std::fprintf(out, "\n]}\n");
+    std::fclose(out);
+    if (dropped > 0) {
+        std::cerr << "trace: " << dropped << " events dropped, buffers hold " << TRACE_CAPACITY << " per thread\n";
+    }
+    return true;
 }
 
-void drawBoxes(sf::RenderWindow& window) {
-    for (const auto& box : boxes) {
-        window.draw(box);
+//.....................................| Event streaming |.....................................//
+// `--serve PORT` streams the sort visualization to any number of WebSocket clients on 127.0.0.1,
+// so a run can be watched from other browsers instead of a shared screen. http://127.0.0.1:PORT/
+// serves a small canvas viewer; any other client can speak the protocol directly.
+//
+// The algorithm side only appends events to a vector under a short lock. A server thread swaps the
+// vector out once per tick, applies it to its own copy of the bars and sends it to every client as
+// one binary message. Messages, all little-endian:
+//   snapshot: u8 1, u32 tick, u16 n, u16 value[n], u8 label length, label
+//   delta:    u8 2, u32 tick, u32 count, then count times { u8 op, u16 a, u16 b }
+//             op 1 compare(a, b), 2 swap(a, b), 3 write(position a, value b)
+// A client gets a snapshot when it connects and then every delta. A client that stops reading
+// builds up a backlog; past STREAM_CLIENT_BACKLOG its queued deltas are dropped and it is resent
+// a snapshot, so a slow viewer costs neither the algorithm nor the other viewers anything.
+enum class StreamOp : std::uint8_t { Compare = 1, Swap = 2, Write = 3 };
+
+struct StreamEvent {
+    StreamOp op;
+    std::uint16_t a;
+    std::uint16_t b;
+};
+
+const int STREAM_TICK_MS = 16;
+const std::size_t STREAM_CLIENT_BACKLOG = 1 << 20; // -> bytes queued for one client before it is resynchronized
+
+std::atomic<bool> streamEnabled{false};
+std::mutex streamMutex; // -> guards the three below
+std::vector<StreamEvent> streamPending;
+std::atomic<std::size_t> streamDepth{0}; // -> size of streamPending, readable without the lock
+std::vector<std::uint16_t> streamPendingSnapshot;
+std::string streamPendingLabel;
+bool streamSnapshotPending = false;
+
+void streamEvent(StreamOp op, Index a, Index b) {
+    if (streamEnabled) {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        streamPending.push_back({op, std::uint16_t(a), std::uint16_t(b)});
+        streamDepth.store(streamPending.size(), std::memory_order_relaxed);
     }
-    for (const auto& text : boxTexts) {
-        window.draw(text);
+}
+
+void streamSnapshot(const int* values, Index n, const std::string& label) { // -> replaces the stream state, earlier events are superseded
+    if (streamEnabled) {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        streamPending.clear();
+        streamPendingSnapshot.assign(values, values + n);
+        streamPendingLabel = label;
+        streamSnapshotPending = true;
     }
 }
 
-//.....................................| Funciones de Ordenamiento |.....................................//
-void bubbleSort() {
-    for (int i = 0; i < NUM_BARS - 1; ++i) {
-        for (int j = 0; j < NUM_BARS - i - 1; ++j) {
-            if (array[j] > array[j + 1]) {
-                std::swap(array[j], array[j + 1]);
-                bars[j].setFillColor(sf::Color::Red);
-                bars[j + 1].setFillColor(sf::Color::Red);
-                bars[j].setSize(sf::Vector2f(BAR_WIDTH, array[j]));
-                bars[j].setPosition(j * BAR_WIDTH, WINDOW_HEIGHT - array[j]);
-                bars[j + 1].setSize(sf::Vector2f(BAR_WIDTH, array[j + 1]));
-                bars[j + 1].setPosition((j + 1) * BAR_WIDTH, WINDOW_HEIGHT - array[j + 1]);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                bars[j].setFillColor(sf::Color::White);
-                bars[j + 1].setFillColor(sf::Color::White);
-            }
-            if (isPaused) {
-                while (isPaused) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                }
-            }
-            if (resetRequested) {
-                resetRequested = false;
-                return;
-            }
+// SHA-1 and base64, only for the Sec-WebSocket-Accept header of the handshake.
+std::string sha1(const std::string& message) {
+    std::uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string padded = message + char(0x80);
+    while (padded.size() % 64 != 56) {
+        padded += char(0);
+    }
+    std::uint64_t bits = std::uint64_t(message.size()) * 8;
+    for (int i = 7; i >= 0; --i) {
+        padded += char((bits >> (8 * i)) & 0xFF);
+    }
+    auto rotl = [](std::uint32_t x, int s) { return (x << s) | (x >> (32 - s)); };
+    for (std::size_t chunk = 0; chunk < padded.size(); chunk += 64) {
+        std::uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = std::uint32_t(std::uint8_t(padded[chunk + 4 * i])) << 24 | std::uint32_t(std::uint8_t(padded[chunk + 4 * i + 1])) << 16 |
+                   std::uint32_t(std::uint8_t(padded[chunk + 4 * i + 2])) << 8 | std::uint32_t(std::uint8_t(padded[chunk + 4 * i + 3]));
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            std::uint32_t f = i < 20 ? ((b & c) | (~b & d)) + 0x5A827999
+                            : i < 40 ? (b ^ c ^ d) + 0x6ED9EBA1
+                            : i < 60 ? ((b & c) | (b & d) | (c & d)) + 0x8F1BBCDC
+                                     : (b ^ c ^ d) + 0xCA62C1D6;
+            std::uint32_t t = rotl(a, 5) + f + e + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    std::string digest;
+    for (std::uint32_t word : h) {
+        for (int i = 3; i >= 0; --i) {
+            digest += char((word >> (8 * i)) & 0xFF);
         }
     }
-    isArraySorted = true;
+    return digest;
 }
 
-void insertionSort() {
-    for (int i = 1; i < NUM_BARS; ++i) {
-        int key = array[i];
-        int j = i - 1;
-        while (j >= 0 && array[j] > key) {
-            array[j + 1] = array[j];
-            bars[j + 1].setFillColor(sf::Color::Red);
-            bars[j + 1].setSize(sf::Vector2f(BAR_WIDTH, array[j + 1]));
-            bars[j + 1].setPosition((j + 1) * BAR_WIDTH, WINDOW_HEIGHT - array[j + 1]);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            bars[j + 1].setFillColor(sf::Color::White);
-            j--;
-            if (isPaused) {
-                while (isPaused) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                }
-            }
-            if (resetRequested) {
-                resetRequested = false;
-                return;
-            }
-        }
-        array[j + 1] = key;
-        bars[j + 1].setSize(sf::Vector2f(BAR_WIDTH, array[j + 1]));
-        bars[j + 1].setPosition((j + 1) * BAR_WIDTH, WINDOW_HEIGHT - array[j + 1]);
+std::string base64(const std::string& bytes) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (std::size_t i = 0; i < bytes.size(); i += 3) {
+        std::uint32_t group = std::uint32_t(std::uint8_t(bytes[i])) << 16;
+        if (i + 1 < bytes.size()) group |= std::uint32_t(std::uint8_t(bytes[i + 1])) << 8;
+        if (i + 2 < bytes.size()) group |= std::uint32_t(std::uint8_t(bytes[i + 2]));
+        out += alphabet[(group >> 18) & 63];
+        out += alphabet[(group >> 12) & 63];
+        out += i + 1 < bytes.size() ? alphabet[(group >> 6) & 63] : '=';
+        out += i + 2 < bytes.size() ? alphabet[group & 63] : '=';
     }
-    isArraySorted = true;
+    return out;
 }
 
-void selectionSort() {
-    for (int i = 0; i < NUM_BARS - 1; ++i) {
-        int minIndex = i;
-        for (int j = i + 1; j < NUM_BARS; ++j) {
-            if (array[j] < array[minIndex]) {
-                minIndex = j;
-            }
+const char* STREAM_VIEWER_PAGE = R"HTML(<!doctype html>
+<html><head><title>algori stream</title><style>body{margin:0;background:#000;color:#aaa;font:14px sans-serif}</style></head>
+<body><div id="status">connecting</div><canvas id="bars" width="1200" height="700"></canvas><script>
+const canvas = document.getElementById('bars'), ctx = canvas.getContext('2d'), status = document.getElementById('status');
+let values = [], flash = new Map(), label = '', tick = 0;
+const ws = new WebSocket('ws://' + location.host + '/');
+ws.binaryType = 'arraybuffer';
+ws.onclose = () => status.textContent = 'disconnected';
+ws.onmessage = (message) => {
+  const view = new DataView(message.data);
+  tick = view.getUint32(1, true);
+  if (view.getUint8(0) === 1) {
+    const n = view.getUint16(5, true);
+    values = Array.from({length: n}, (_, i) => view.getUint16(7 + 2 * i, true));
+    const length = view.getUint8(7 + 2 * n);
+    label = new TextDecoder().decode(new Uint8Array(message.data, 8 + 2 * n, length));
+    flash.clear();
+    return;
+  }
+  const count = view.getUint32(5, true);
+  for (let e = 0, at = 9; e < count; ++e, at += 5) {
+    const op = view.getUint8(at), a = view.getUint16(at + 1, true), b = view.getUint16(at + 3, true);
+    if (op === 1) { flash.set(a, '#ff0'); flash.set(b, '#ff0'); }
+    if (op === 2) { [values[a], values[b]] = [values[b], values[a]]; flash.set(a, '#f00'); flash.set(b, '#f00'); }
+    if (op === 3) { values[a] = b; flash.set(a, '#f00'); }
+  }
+};
+function draw() {
+  ctx.clearRect(0, 0, canvas.width, canvas.height);
+  const width = canvas.width / Math.max(1, values.length);
+  values.forEach((v, i) => { ctx.fillStyle = flash.get(i) || '#fff'; ctx.fillRect(i * width, canvas.height - v, width - 1, v); });
+  flash.clear();
+  status.textContent = label + ' | tick ' + tick;
+  requestAnimationFrame(draw);
+}
+draw();
+</script></body></html>
+)HTML";
+
+#if defined(_WIN32)
+bool startStreamServer(int) {
+    std::cerr << "--serve needs POSIX sockets, it is not available on this platform\n";
+    return false;
+}
+void stopStreamServer() {}
+#else
+#if defined(MSG_NOSIGNAL)
+const int STREAM_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int STREAM_SEND_FLAGS = 0;
+#endif
+
+struct StreamClient {
+    int fd = -1;
+    bool upgraded = false; // -> past the WebSocket handshake
+    bool closing = false; // -> close once the outbox is flushed
+    bool needsSnapshot = false;
+    std::string inbox;
+    std::deque<std::string> outbox;
+    std::size_t sentOfFront = 0; // -> bytes of outbox.front() already written, a frame is never cut short
+    std::size_t queued = 0;
+};
+
+class StreamServer {
+public:
+    bool start(int port) {
+        listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listener < 0) {
+            std::perror("stream socket");
+            return false;
         }
-        std::swap(array[i], array[minIndex]);
-        bars[i].setFillColor(sf::Color::Red);
-        bars[minIndex].setFillColor(sf::Color::Red);
-        bars[i].setSize(sf::Vector2f(BAR_WIDTH, array[i]));
-        bars[i].setPosition(i * BAR_WIDTH, WINDOW_HEIGHT - array[i]);
-        bars[minIndex].setSize(sf::Vector2f(BAR_WIDTH, array[minIndex]));
-        bars[minIndex].setPosition(minIndex * BAR_WIDTH, WINDOW_HEIGHT - array[minIndex]);
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        bars[i].setFillColor(sf::Color::White);
-        bars[minIndex].setFillColor(sf::Color::White);
-        if (isPaused) {
-            while (isPaused) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
+        int yes = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(std::uint16_t(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 16) != 0) {
+            std::perror("stream bind");
+            ::close(listener);
+            return false;
         }
-        if (resetRequested) {
-            resetRequested = false;
-            return;
+        fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+        running = true;
+        worker = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        if (worker.joinable()) {
+            worker.join();
+        }
+        for (auto& client : clients) {
+            ::close(client.fd);
+        }
+        clients.clear();
+        if (listener >= 0) {
+            ::close(listener);
         }
     }
-    isArraySorted = true;
-}
 
-void quickSort(int low, int high) {
-    if (low < high) {
-        int pivot = array[high];
-        int i = low - 1;
-        for (int j = low; j < high; ++j) {
-            if (array[j] < pivot) {
-                i++;
-                std::swap(array[i], array[j]);
-                bars[i].setFillColor(sf::Color::Red);
-                bars[j].setFillColor(sf::Color::Red);
-                bars[i].setSize(sf::Vector2f(BAR_WIDTH, array[i]));
-                bars[i].setPosition(i * BAR_WIDTH, WINDOW_HEIGHT - array[i]);
-                bars[j].setSize(sf::Vector2f(BAR_WIDTH, array[j]));
-                bars[j].setPosition(j * BAR_WIDTH, WINDOW_HEIGHT - array[j]);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                bars[i].setFillColor(sf::Color::White);
-                bars[j].setFillColor(sf::Color::White);
-            }
-            if (isPaused) {
-                while (isPaused) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                }
+private:
+    void run() {
+        traceThreadName("stream");
+        auto nextTick = std::chrono::steady_clock::now();
+        while (running) {
+            std::vector<pollfd> fds = {{listener, POLLIN, 0}};
+            for (const auto& client : clients) {
+                fds.push_back({client.fd, short(POLLIN | (client.outbox.empty() ? 0 : POLLOUT)), 0});
             }
-            if (resetRequested) {
-                resetRequested = false;
-                return;
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextTick - std::chrono::steady_clock::now()).count();
+            ::poll(fds.data(), fds.size(), int(std::max<long long>(0, wait)));
+            if (fds[0].revents & POLLIN) {
+                accept();
             }
-        }
-        std::swap(array[i + 1], array[high]);
-        bars[i + 1].setFillColor(sf::Color::Red);
-        bars[high].setFillColor(sf::Color::Red);
-        bars[i + 1].setSize(sf::Vector2f(BAR_WIDTH, array[i + 1]));
-        bars[i + 1].setPosition((i + 1) * BAR_WIDTH, WINDOW_HEIGHT - array[i + 1]);
-        bars[high].setSize(sf::Vector2f(BAR_WIDTH, array[high]));
-        bars[high].setPosition(high * BAR_WIDTH, WINDOW_HEIGHT - array[high]);
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        bars[i + 1].setFillColor(sf::Color::White);
-        bars[high].setFillColor(sf::Color::White);
-        int pi = i + 1;
-        quickSort(low, pi - 1);
-        quickSort(pi + 1, high);
-    }
-    isArraySorted = true;
-}
-
-void mergeSort(int left, int right) {
-    if (left < right) {
-        int mid = left + (right - left) / 2;
-        mergeSort(left, mid);
-        mergeSort(mid + 1, right);
-        std::vector<int> temp(right - left + 1);
-        int i = left, j = mid + 1, k = 0;
-        while (i <= mid && j <= right) {
-            if (array[i] <= array[j]) {
-                temp[k++] = array[i++];
-            } else {
-                temp[k++] = array[j++];
+            for (std::size_t c = 0; c + 1 < fds.size(); ++c) {
+                if (fds[c + 1].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    receive(clients[c]);
+                }
             }
-        }
-        while (i <= mid) {
-            temp[k++] = array[i++];
-        }
-        while (j <= right) {
-            temp[k++] = array[j++];
-        }
-        for (int i = left; i <= right; ++i) {
-            array[i] = temp[i - left];
-            bars[i].setFillColor(sf::Color::Red);
-            bars[i].setSize(sf::Vector2f(BAR_WIDTH, array[i]));
-            bars[i].setPosition(i * BAR_WIDTH, WINDOW_HEIGHT - array[i]);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            bars[i].setFillColor(sf::Color::White);
-            if (isPaused) {
-                while (isPaused) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (std::chrono::steady_clock::now() >= nextTick) {
+                TraceSpan span("stream tick", "stream");
+                tick();
+                nextTick += std::chrono::milliseconds(STREAM_TICK_MS);
+                if (nextTick < std::chrono::steady_clock::now()) { // -> fell behind, do not burst to catch up
+                    nextTick = std::chrono::steady_clock::now() + std::chrono::milliseconds(STREAM_TICK_MS);
                 }
             }
-            if (resetRequested) {
-                resetRequested = false;
-                return;
+            for (auto& client : clients) {
+                flush(client);
+            }
+            std::size_t before = clients.size();
+            clients.erase(std::remove_if(clients.begin(), clients.end(), [](const StreamClient& client) {
+                if (client.fd >= 0 && !(client.closing && client.outbox.empty())) {
+                    return false;
+                }
+                if (client.fd >= 0) {
+                    ::close(client.fd);
+                }
+                return true;
+            }), clients.end());
+            if (clients.size() != before) {
+                std::cout << "stream: " << viewers() << " viewer(s)" << std::endl;
             }
         }
     }
-    isArraySorted = true;
-}
-
-void heapify(int n, int i) {
-    int largest = i;
-    int left = 2 * i + 1;
-    int right = 2 * i + 2;
-
-    if (left < n && array[left] > array[largest]) {
-        largest = left;
-    }
-
-    if (right < n && array[right] > array[largest]) {
-        largest = right;
-    }
 
-    if (largest != i) {
-        std::swap(array[i], array[largest]);
-        bars[i].setFillColor(sf::Color::Red);
-        bars[largest].setFillColor(sf::Color::Red);
-        bars[i].setSize(sf::Vector2f(BAR_WIDTH, array[i]));
-        bars[i].setPosition(i * BAR_WIDTH, WINDOW_HEIGHT - array[i]);
-        bars[largest].setSize(sf::Vector2f(BAR_WIDTH, array[largest]));
-        bars[largest].setPosition(largest * BAR_WIDTH, WINDOW_HEIGHT - array[largest]);
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        bars[i].setFillColor(sf::Color::White);
-        bars[largest].setFillColor(sf::Color::White);
-        heapify(n, largest);
+    std::size_t viewers() const {
+        return std::size_t(std::count_if(clients.begin(), clients.end(), [](const StreamClient& c) { return c.upgraded; }));
     }
-}
 
-void heapSort() {
-    for (int i = NUM_BARS / 2 - 1; i >= 0; i--) {
-        heapify(NUM_BARS, i);
+    void accept() {
+        for (int fd; (fd = ::accept(listener, nullptr, nullptr)) >= 0;) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            StreamClient client;
+            client.fd = fd;
+            clients.push_back(std::move(client));
+        }
     }
 
-    for (int i = NUM_BARS - 1; i > 0; i--) {
-        std::swap(array[0], array[i]);
-        bars[0].setFillColor(sf::Color::Red);
-        bars[i].setFillColor(sf::Color::Red);
-        bars[0].setSize(sf::Vector2f(BAR_WIDTH, array[0]));
-        bars[0].setPosition(0 * BAR_WIDTH, WINDOW_HEIGHT - array[0]);
-        bars[i].setSize(sf::Vector2f(BAR_WIDTH, array[i]));
-        bars[i].setPosition(i * BAR_WIDTH, WINDOW_HEIGHT - array[i]);
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        bars[0].setFillColor(sf::Color::White);
-        bars[i].setFillColor(sf::Color::White);
-        heapify(i, 0);
-        if (isPaused) {
-            while (isPaused) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    void tick() {
+        std::vector<StreamEvent> events;
+        bool snapshot = false;
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            events.swap(streamPending);
+            streamDepth.store(0, std::memory_order_relaxed);
+            if (streamSnapshotPending) {
+                model.swap(streamPendingSnapshot);
+                label = streamPendingLabel;
+                streamSnapshotPending = false;
+                snapshot = true;
             }
         }
-        if (resetRequested) {
-            resetRequested = false;
-            return;
+        ticks++;
+        if (snapshot) {
+            for (auto& client : clients) {
+                client.needsSnapshot = client.upgraded;
+            }
         }
-    }
-    isArraySorted = true;
-}
-
-void bucketSort() { // -> sorting algorithm, basically this implementation works like taking the array and dividing it into buckets.
-    int maxVal = *std::max_element(array.begin(), array.end());
-    int minVal = *std::min_element(array.begin(), array.end());
-    int bucketSize = 10;
-    int bucketCount = (maxVal - minVal) / bucketSize + 1;
-    std::vector<std::vector<int>> buckets(bucketCount);
-
-    for (int i = 0; i < NUM_BARS; ++i) {
-        int bucketIndex = (array[i] - minVal) / bucketSize;
-        if (bucketIndex >= bucketCount) bucketIndex = bucketCount - 1;
-        buckets[bucketIndex].push_back(array[i]);
-    }
-
-    int index = 0;
-    for (int i = 0; i < bucketCount; ++i) {
-        std::sort(buckets[i].begin(), buckets[i].end());
-        for (int j = 0; j < buckets[i].size(); ++j) {
-            array[index] = buckets[i][j];
-            bars[index].setFillColor(sf::Color::Red);
-            bars[index].setSize(sf::Vector2f(BAR_WIDTH, array[index]));
-            bars[index].setPosition(index * BAR_WIDTH, WINDOW_HEIGHT - array[index]);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            bars[index].setFillColor(sf::Color::White);
-            index++;
-            if (isPaused) {
-                while (isPaused) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                }
+        for (const StreamEvent& event : events) { // -> the model is what a client holds after this tick's delta
+            if (event.op == StreamOp::Swap && event.a < model.size() && event.b < model.size()) {
+                std::swap(model[event.a], model[event.b]);
+            } else if (event.op == StreamOp::Write && event.a < model.size()) {
+                model[event.a] = event.b;
             }
-            if (resetRequested) {
-                resetRequested = false;
-                return;
+        }
+        std::string delta;
+        if (!events.empty()) {
+            std::string payload;
+            payload += char(2);
+            put32(payload, ticks);
+            put32(payload, std::uint32_t(events.size()));
+            for (const StreamEvent& event : events) {
+                payload += char(event.op);
+                put16(payload, event.a);
+                put16(payload, event.b);
+            }
+            delta = frame(0x2, payload);
+        }
+        for (auto& client : clients) {
+            if (!client.upgraded) {
+                continue;
+            }
+            if (client.queued > STREAM_CLIENT_BACKLOG) { // -> backpressure: drop what it has not started reading, resync
+                dropBacklog(client);
+                client.needsSnapshot = true;
+            }
+            if (client.needsSnapshot) {
+                dropBacklog(client);
+                enqueue(client, snapshotFrame());
+                client.needsSnapshot = false;
+            } else if (!delta.empty()) {
+                enqueue(client, delta);
             }
         }
     }
-    isArraySorted = true;
-}
 
-void gnomeSort() {
-    int index = 0;
-    while (index < NUM_BARS) {
-        if (index == 0 || array[index] >= array[index - 1]) {
-            index++;
-        } else {
-            std::swap(array[index], array[index - 1]);
-            bars[index].setFillColor(sf::Color::Red);
-            bars[index - 1].setFillColor(sf::Color::Red);
-            bars[index].setSize(sf::Vector2f(BAR_WIDTH, array[index]));
-            bars[index].setPosition(index * BAR_WIDTH, WINDOW_HEIGHT - array[index]);
-            bars[index - 1].setSize(sf::Vector2f(BAR_WIDTH, array[index - 1]));
-            bars[index - 1].setPosition((index - 1) * BAR_WIDTH, WINDOW_HEIGHT - array[index - 1]);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            bars[index].setFillColor(sf::Color::White);
-            bars[index - 1].setFillColor(sf::Color::White);
-            index--;
+    std::string snapshotFrame() const {
+        std::string payload;
+        payload += char(1);
+        put32(payload, ticks);
+        put16(payload, std::uint16_t(model.size()));
+        for (std::uint16_t value : model) {
+            put16(payload, value);
         }
-        if (isPaused) {
-            while (isPaused) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::string name = label.substr(0, 255);
+        payload += char(name.size());
+        payload += name;
+        return frame(0x2, payload);
+    }
+
+    void receive(StreamClient& client) {
+        char buffer[4096];
+        ssize_t got = ::recv(client.fd, buffer, sizeof(buffer), 0);
+        if (got <= 0) {
+            if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                ::close(client.fd);
+                client.fd = -1;
             }
+            return;
         }
-        if (resetRequested) {
-            resetRequested = false;
+        client.inbox.append(buffer, std::size_t(got));
+        if (client.inbox.size() > 65536) { // -> nothing legitimate sends this much
+            ::close(client.fd);
+            client.fd = -1;
             return;
         }
-    }
-    isArraySorted = true;
-}
-
-void timSort() {
-    const int RUN = 32;
-    for (int i = 0; i < NUM_BARS; i += RUN) {
-        int left = i;
-        int right = std::min(i + RUN - 1, NUM_BARS - 1);
-        for (int j = left + 1; j <= right; ++j) {
-            int key = array[j];
-            int k = j - 1;
-            while (k >= left && array[k] > key) {
-                array[k + 1] = array[k];
-                bars[k + 1].setFillColor(sf::Color::Red);
-                bars[k + 1].setSize(sf::Vector2f(BAR_WIDTH, array[k + 1]));
-                bars[k + 1].setPosition((k + 1) * BAR_WIDTH, WINDOW_HEIGHT - array[k + 1]);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                bars[k + 1].setFillColor(sf::Color::White);
-                k--;
-                if (isPaused) {
-                    while (isPaused) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    }
-                }
-                if (resetRequested) {
-                    resetRequested = false;
-                    return;
-                }
-            }
-            array[k + 1] = key;
-            bars[k + 1].setSize(sf::Vector2f(BAR_WIDTH, array[k + 1]));
-            bars[k + 1].setPosition((k + 1) * BAR_WIDTH, WINDOW_HEIGHT - array[k + 1]);
+        if (!client.upgraded) {
+            handshake(client);
+        } else {
+            readFrames(client);
         }
     }
 
-    for (int size = RUN; size < NUM_BARS; size = 2 * size) {
-        for (int left = 0; left < NUM_BARS; left += 2 * size) {
-            int mid = left + size - 1;
-            int right = std::min(left + 2 * size - 1, NUM_BARS - 1);
-
-            int n1 = mid - left + 1;
-            int n2 = right - mid;
-
-            std::vector<int> L(n1), R(n2);
-
-            for (int i = 0; i < n1; ++i) {
-                L[i] = array[left + i];
-            }
-            for (int i = 0; i < n2; ++i) {
-                R[i] = array[mid + 1 + i];
-            }
+    void handshake(StreamClient& client) {
+        std::size_t end = client.inbox.find("\r\n\r\n");
+        if (end == std::string::npos) {
+            return;
+        }
+        std::string request = client.inbox.substr(0, end + 2);
+        client.inbox.erase(0, end + 4);
+        std::string lower = request;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+        std::size_t keyAt = lower.find("\r\nsec-websocket-key:");
+        if (lower.find("upgrade: websocket") == std::string::npos || keyAt == std::string::npos) {
+            std::string page = STREAM_VIEWER_PAGE;
+            enqueue(client, "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: " + std::to_string(page.size()) +
+                                "\r\nConnection: close\r\n\r\n" + page);
+            client.closing = true;
+            return;
+        }
+        std::size_t from = keyAt + 20, to = request.find("\r\n", from);
+        std::string key = request.substr(from, to - from);
+        key.erase(0, key.find_first_not_of(" \t"));
+        key.erase(key.find_last_not_of(" \t") + 1);
+        enqueue(client, "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: " +
+                            base64(sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11")) + "\r\n\r\n");
+        client.upgraded = true;
+        client.needsSnapshot = true; // -> a late joiner starts from the current state
+        std::cout << "stream: " << viewers() << " viewer(s)" << std::endl;
+    }
 
-            int i = 0, j = 0, k = left;
-            while (i < n1 && j < n2) {
-                if (L[i] <= R[j]) {
-                    array[k] = L[i];
-                    bars[k].setFillColor(sf::Color::Red);
-                    bars[k].setSize(sf::Vector2f(BAR_WIDTH, array[k]));
-                    bars[k].setPosition(k * BAR_WIDTH, WINDOW_HEIGHT - array[k]);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                    bars[k].setFillColor(sf::Color::White);
-                    i++;
-                } else {
-                    array[k] = R[j];
-                    bars[k].setFillColor(sf::Color::Red);
-                    bars[k].setSize(sf::Vector2f(BAR_WIDTH, array[k]));
-                    bars[k].setPosition(k * BAR_WIDTH, WINDOW_HEIGHT - array[k]);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                    bars[k].setFillColor(sf::Color::White);
-                    j++;
-                }
-                k++;
-                if (isPaused) {
-                    while (isPaused) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    }
-                }
-                if (resetRequested) {
-                    resetRequested = false;
+    void readFrames(StreamClient& client) { // -> clients only ever need close and ping handled
+        while (client.inbox.size() >= 2) {
+            const std::string& in = client.inbox;
+            int opcode = in[0] & 0x0F;
+            bool masked = (in[1] & 0x80) != 0;
+            std::uint64_t length = std::uint8_t(in[1]) & 0x7F;
+            std::size_t header = 2;
+            if (length >= 126) {
+                std::size_t extra = length == 126 ? 2 : 8;
+                if (in.size() < header + extra) {
                     return;
                 }
-            }
-
-            while (i < n1) {
-                array[k] = L[i];
-                bars[k].setFillColor(sf::Color::Red);
-                bars[k].setSize(sf::Vector2f(BAR_WIDTH, array[k]));
-                bars[k].setPosition(k * BAR_WIDTH, WINDOW_HEIGHT - array[k]);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                bars[k].setFillColor(sf::Color::White);
-                i++;
-                k++;
-                if (isPaused) {
-                    while (isPaused) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    }
-                }
-                if (resetRequested) {
-                    resetRequested = false;
-                    return;
+                length = 0;
+                for (std::size_t i = 0; i < extra; ++i) {
+                    length = length << 8 | std::uint8_t(in[header + i]);
                 }
+                header += extra;
             }
-
-            while (j < n2) {
-                array[k] = R[j];
-                bars[k].setFillColor(sf::Color::Red);
-                bars[k].setSize(sf::Vector2f(BAR_WIDTH, array[k]));
-                bars[k].setPosition(k * BAR_WIDTH, WINDOW_HEIGHT - array[k]);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                bars[k].setFillColor(sf::Color::White);
-                j++;
-                k++;
-                if (isPaused) {
-                    while (isPaused) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    }
-                }
-                if (resetRequested) {
-                    resetRequested = false;
-                    return;
-                }
+            std::size_t maskAt = header;
+            header += masked ? 4 : 0;
+            if (in.size() < header + length) {
+                return;
+            }
+            std::string payload = in.substr(header, std::size_t(length));
+            for (std::size_t i = 0; masked && i < payload.size(); ++i) {
+                payload[i] = char(payload[i] ^ in[maskAt + i % 4]);
+            }
+            client.inbox.erase(0, header + std::size_t(length));
+            if (opcode == 0x8) {
+                enqueue(client, frame(0x8, payload.substr(0, 2)));
+                client.closing = true;
+            } else if (opcode == 0x9) {
+                enqueue(client, frame(0xA, payload));
             }
         }
     }
-    isArraySorted = true;
-}
 
-void insertionSort(int left, int right) {
-    for (int i = left + 1; i <= right; ++i) {
-        int key = array[i];
-        int j = i - 1;
-        while (j >= left && array[j] > key) {
-            array[j + 1] = array[j];
-            bars[j + 1].setFillColor(sf::Color::Red);
-            bars[j + 1].setSize(sf::Vector2f(BAR_WIDTH, array[j + 1]));
-            bars[j + 1].setPosition((j + 1) * BAR_WIDTH, WINDOW_HEIGHT - array[j + 1]);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            bars[j + 1].setFillColor(sf::Color::White);
-            j--;
-            if (isPaused) {
-                while (isPaused) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    void flush(StreamClient& client) {
+        while (client.fd >= 0 && !client.outbox.empty()) {
+            const std::string& front = client.outbox.front();
+            ssize_t sent = ::send(client.fd, front.data() + client.sentOfFront, front.size() - client.sentOfFront, STREAM_SEND_FLAGS);
+            if (sent < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    ::close(client.fd);
+                    client.fd = -1;
                 }
-            }
-            if (resetRequested) {
-                resetRequested = false;
                 return;
             }
+            client.sentOfFront += std::size_t(sent);
+            client.queued -= std::size_t(sent);
+            if (client.sentOfFront == front.size()) {
+                client.outbox.pop_front();
+                client.sentOfFront = 0;
+            }
         }
-        array[j + 1] = key;
-        bars[j + 1].setSize(sf::Vector2f(BAR_WIDTH, array[j + 1]));
-        bars[j + 1].setPosition((j + 1) * BAR_WIDTH, WINDOW_HEIGHT - array[j + 1]);
     }
-}
 
-void mergeSort(int left, int mid, int right) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-
-    std::vector<int> L(n1), R(n2);
-
-    for (int i = 0; i < n1; ++i) {
-        L[i] = array[left + i];
+    static void enqueue(StreamClient& client, std::string bytes) {
+        client.queued += bytes.size();
+        client.outbox.push_back(std::move(bytes));
     }
-    for (int i = 0; i < n2; ++i) {
-        R[i] = array[mid + 1 + i];
+
+    static void dropBacklog(StreamClient& client) { // -> keeps a frame that is half written, the stream must stay well formed
+        while (client.outbox.size() > (client.sentOfFront > 0 ? 1u : 0u)) {
+            client.queued -= client.outbox.back().size();
+            client.outbox.pop_back();
+        }
     }
 
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2) {
-        if (L[i] <= R[j]) {
-            array[k] = L[i];
-            bars[k].setFillColor(sf::Color::Red);
-            bars[k].setSize(sf::Vector2f(BAR_WIDTH, array[k]));
-            bars[k].setPosition(k * BAR_WIDTH, WINDOW_HEIGHT - array[k]);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            bars[k].setFillColor(sf::Color::White);
-            i++;
+    static std::string frame(int opcode, const std::string& payload) {
+        std::string out;
+        out += char(0x80 | opcode);
+        if (payload.size() < 126) {
+            out += char(payload.size());
+        } else if (payload.size() < 65536) {
+            out += char(126);
+            out += char(payload.size() >> 8);
+            out += char(payload.size() & 0xFF);
         } else {
-            array[k] = R[j];
-            bars[k].setFillColor(sf::Color::Red);
-            bars[k].setSize(sf::Vector2f(BAR_WIDTH, array[k]));
-            bars[k].setPosition(k * BAR_WIDTH, WINDOW_HEIGHT - array[k]);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            bars[k].setFillColor(sf::Color::White);
-            j++;
-        }
-        k++;
-        if (isPaused) {
-            while (isPaused) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            out += char(127);
+            for (int i = 7; i >= 0; --i) {
+                out += char((std::uint64_t(payload.size()) >> (8 * i)) & 0xFF);
             }
         }
-        if (resetRequested) {
-            resetRequested = false;
-            return;
-        }
+        return out + payload;
     }
 
-    while (i < n1) {
-        array[k] = L[i];
-        bars[k].setFillColor(sf::Color::Red);
-        bars[k].setSize(sf::Vector2f(BAR_WIDTH, array[k]));
-        bars[k].setPosition(k * BAR_WIDTH, WINDOW_HEIGHT - array[k]);
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        bars[k].setFillColor(sf::Color::White);
-        i++;
-        k++;
-        if (isPaused) {
-            while (isPaused) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
-        }
-        if (resetRequested) {
-            resetRequested = false;
-            return;
-        }
+    static void put16(std::string& out, std::uint16_t value) {
+        out += char(value & 0xFF);
+        out += char(value >> 8);
     }
 
-    while (j < n2) {
-        array[k] = R[j];
-        bars[k].setFillColor(sf::Color::Red);
-        bars[k].setSize(sf::Vector2f(BAR_WIDTH, array[k]));
-        bars[k].setPosition(k * BAR_WIDTH, WINDOW_HEIGHT - array[k]);
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        bars[k].setFillColor(sf::Color::White);
-        j++;
-        k++;
-        if (isPaused) {
-            while (isPaused) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
-        }
-        if (resetRequested) {
-            resetRequested = false;
-            return;
+    static void put32(std::string& out, std::uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out += char((value >> (8 * i)) & 0xFF);
         }
     }
-}
 
-void cycleSort() {
-    for (int cycleStart = 0; cycleStart < NUM_BARS - 1; ++cycleStart) {
-        int item = array[cycleStart];
-        int pos = cycleStart;
+    int listener = -1;
+    std::atomic<bool> running{false};
+    std::thread worker;
+    std::vector<StreamClient> clients;
+    std::vector<std::uint16_t> model;
+    std::string label;
+    std::uint32_t ticks = 0;
+};
 
-        for (int i = cycleStart + 1; i < NUM_BARS; ++i) {
-            if (array[i] < item) {
-                pos++;
-            }
-        }
+StreamServer streamServer;
 
-        if (pos == cycleStart) {
-            continue;
-        }
+bool startStreamServer(int port) {
+    if (!streamServer.start(port)) {
+        return false;
+    }
+    streamEnabled = true;
+    std::cout << "streaming on ws://127.0.0.1:" << port << "/ (viewer at http://127.0.0.1:" << port << "/)" << std::endl;
+    return true;
+}
 
-        while (item == array[pos]) {
-            pos++;
+void stopStreamServer() {
+    streamEnabled = false;
+    streamServer.stop();
+}
+#endif
+
+//.....................................| Element types |.....................................//
+// The visualizer sorts ints, but every algorithm is generic over the element type. ElementTraits
+// holds what an algorithm needs beyond the comparison operators (only bucketSort needs a numeric key).
+template <std::size_t Bytes>
+struct Record { // -> a 64-bit key followed by a payload that has to travel with it
+    static_assert(Bytes > sizeof(std::uint64_t), "a record needs room for a payload");
+    std::uint64_t key;
+    unsigned char payload[Bytes - sizeof(std::uint64_t)];
+
+    bool operator<(const Record& other) const { return key < other.key; }
+    bool operator>(const Record& other) const { return key > other.key; }
+    bool operator<=(const Record& other) const { return key <= other.key; }
+    bool operator>=(const Record& other) const { return key >= other.key; }
+    bool operator==(const Record& other) const { return key == other.key; }
+    bool operator!=(const Record& other) const { return key != other.key; }
+};
+
+template <typename T, typename Enable = void>
+struct ElementTraits { // -> integers and floating point
+    static constexpr double minBucketWidth = std::is_integral<T>::value ? 10.0 : 0.0;
+    static double bucketKey(const T& value) { return double(value); }
+};
+
+template <>
+struct ElementTraits<std::string> {
+    static constexpr double minBucketWidth = 0.0;
+    static double bucketKey(const std::string& value) { // -> the first 8 bytes, big endian, keep the lexicographic order
+        std::uint64_t prefix = 0;
+        for (std::size_t i = 0; i < 8; ++i) {
+            prefix = (prefix << 8) | (i < value.size() ? (unsigned char)value[i] : 0);
         }
+        return double(prefix);
+    }
+};
+
+template <std::size_t Bytes>
+struct ElementTraits<Record<Bytes>> {
+    static constexpr double minBucketWidth = 0.0;
+    static double bucketKey(const Record<Bytes>& value) { return double(value.key); }
+};
+
+// Element kinds used by the benchmark: a C++ type plus how to build one from a 64-bit key so that
+// the element order follows the key order.
+struct Int32Kind {
+    typedef std::int32_t type;
+    static const char* name() { return "int32"; }
+    static type make(std::uint64_t key) { return type(key & 0x7fffffff); }
+};
+
+struct UInt32Kind {
+    typedef std::uint32_t type;
+    static const char* name() { return "uint32"; }
+    static type make(std::uint64_t key) { return type(key); }
+};
+
+struct UInt64Kind {
+    typedef std::uint64_t type;
+    static const char* name() { return "uint64"; }
+    static type make(std::uint64_t key) { return key; }
+};
+
+struct DoubleKind {
+    typedef double type;
+    static const char* name() { return "double"; }
+    static type make(std::uint64_t key) { return double(key >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+struct ShortStringKind { // -> fits the small-string buffer, no heap traffic when moved
+    typedef std::string type;
+    static const char* name() { return "str15"; }
+    static type make(std::uint64_t key) {
+        char digits[32];
+        std::snprintf(digits, sizeof(digits), "%015llu", (unsigned long long)(key % 1000000000000000ULL));
+        return digits;
+    }
+};
+
+struct LongStringKind { // -> heap allocated, shares a long prefix so comparisons walk further
+    typedef std::string type;
+    static const char* name() { return "str48"; }
+    static type make(std::uint64_t key) {
+        char text[64];
+        std::snprintf(text, sizeof(text), "algori/key/%020llu/%016llx", (unsigned long long)key, (unsigned long long)(key * 0x9E3779B97F4A7C15ULL));
+        return text;
+    }
+};
+
+template <std::size_t Bytes>
+struct RecordKind {
+    typedef Record<Bytes> type;
+    static const char* name() {
+        static const std::string label = "rec" + std::to_string(Bytes);
+        return label.c_str();
+    }
+    static type make(std::uint64_t key) {
+        type record;
+        record.key = key;
+        std::memset(record.payload, int(key & 0xff), sizeof(record.payload));
+        return record;
+    }
+};
+
+struct BarKind { // -> the sorting bars, heights 50..700 with range 651
+    typedef int type;
+    static const char* name() { return "bars"; }
+    static type make(std::uint64_t key) { return 50 + int(key); }
+};
+
+struct BoxKind { // -> the search boxes, values 1..150 with range 150
+    typedef int type;
+    static const char* name() { return "boxes"; }
+    static type make(std::uint64_t key) { return 1 + int(key); }
+};
+
+//.....................................| Parallel helpers |.....................................//
+unsigned workerCount() {
+    unsigned count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
 
-        if (pos != cycleStart) {
-            std::swap(item, array[pos]);
-            bars[pos].setFillColor(sf::Color::Red);
-            bars[pos].setSize(sf::Vector2f(BAR_WIDTH, array[pos]));
-            bars[pos].setPosition(pos * BAR_WIDTH, WINDOW_HEIGHT - array[pos]);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            bars[pos].setFillColor(sf::Color::White);
+// Calls fn(chunk) for every chunk in [0, chunks) from a pool of workers that pull chunk numbers
+// from a shared counter. Chunks are the unit of determinism: what a chunk produces must not depend
+// on which thread runs it.
+template <typename Fn>
+void parallelFor(Index chunks, Fn fn, unsigned threads = workerCount()) {
+    threads = unsigned(std::max<Index>(1, std::min<Index>(threads, chunks)));
+    if (threads <= 1) {
+        for (Index chunk = 0; chunk < chunks; ++chunk) {
+            fn(chunk);
+        }
+        return;
+    }
+    std::atomic<Index> next(0);
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&] {
+            traceThreadName("worker");
+            for (Index chunk = next++; chunk < chunks; chunk = next++) {
+                fn(chunk);
+            }
+        });
+    }
+    for (auto& worker : pool) {
+        worker.join();
+    }
+}
+
+//.....................................| Scratch arena |.....................................//
+// Auxiliary memory of the algorithms (merge buffers, bucket storage, scatter targets) comes from a
+// per-thread bump arena instead of the heap. Buffers are scoped and released in reverse order, which
+// rewinds the arena and leaves its blocks for the next buffer, so once a run has warmed up its hot
+// loops make no allocator calls. The counters are process-wide and cleared at the start of a run:
+// bytes live in scratch buffers and their peak, total bytes handed out, and blocks taken from the heap.
+struct ScratchStats {
+    std::atomic<std::size_t> live{0};
+    std::atomic<std::size_t> peak{0};
+    std::atomic<std::size_t> total{0};
+    std::atomic<std::size_t> blocks{0};
+};
+
+ScratchStats scratchStats;
+const std::size_t SCRATCH_MIN_BLOCK = 64 * 1024;
+
+void resetScratchStats() {
+    scratchStats.peak = scratchStats.live.load();
+    scratchStats.total = 0;
+    scratchStats.blocks = 0;
+}
+
+class ScratchArena {
+public:
+    struct Mark {
+        std::size_t block;
+        std::size_t used;
+    };
+
+    void* allocate(std::size_t bytes, std::size_t align, Mark& mark) {
+        mark = {current, used};
+        for (;; ++current, used = 0) {
+            if (current == blocks.size()) {
+                std::size_t size = std::max({SCRATCH_MIN_BLOCK, bytes + align, blocks.empty() ? 0 : 2 * blocks.back().size});
+                blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+                scratchStats.blocks++;
+            }
+            std::uintptr_t base = reinterpret_cast<std::uintptr_t>(blocks[current].data.get());
+            std::size_t start = std::size_t((base + used + align - 1) / align * align - base);
+            if (start + bytes <= blocks[current].size) {
+                used = start + bytes;
+                std::size_t live = scratchStats.live += bytes;
+                scratchStats.total += bytes;
+                for (std::size_t peak = scratchStats.peak; live > peak && !scratchStats.peak.compare_exchange_weak(peak, live);) {
+                }
+                return blocks[current].data.get() + start;
+            }
+        }
+    }
+
+    void release(const Mark& mark, std::size_t bytes) { // -> must be the most recent live allocation
+        current = mark.block;
+        used = mark.used;
+        scratchStats.live -= bytes;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        std::size_t size;
+    };
+    std::vector<Block> blocks; // -> kept for the life of the thread, a block too small for a request is skipped over
+    std::size_t current = 0;
+    std::size_t used = 0;
+};
+
+thread_local ScratchArena scratchArena;
+
+// A scoped array of count default-constructed T in the calling thread's arena.
+template <typename T>
+class ScratchBuffer {
+public:
+    explicit ScratchBuffer(Index count) : count(std::max<Index>(count, 0)), bytes(sizeof(T) * std::size_t(this->count)) {
+        items = static_cast<T*>(scratchArena.allocate(bytes, alignof(T), mark));
+        std::uninitialized_default_construct_n(items, this->count);
+    }
+
+    ~ScratchBuffer() {
+        std::destroy_n(items, count);
+        scratchArena.release(mark, bytes);
+    }
+
+    ScratchBuffer(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+    T& operator[](Index i) { return items[i]; }
+    T* data() { return items; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    Index size() const { return count; }
+
+private:
+    Index count;
+    std::size_t bytes;
+    ScratchArena::Mark mark;
+    T* items;
+};
+
+//.....................................| Input generators |.....................................//
+// Every input is a pure function of (distribution, parameters, seed): the array is cut into fixed
+// size chunks and chunk c draws from its own SplitMix64 stream derived from (seed, c), so the result
+// is identical whether it is filled by one thread or by all of them.
+struct SplitMix64 {
+    std::uint64_t state;
+
+    explicit SplitMix64(std::uint64_t seed) : state(seed) {}
+
+    static std::uint64_t mix(std::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    static SplitMix64 stream(std::uint64_t seed, std::uint64_t stream) { // -> independent child stream
+        return SplitMix64(mix(seed + mix(stream + 0x9E3779B97F4A7C15ULL)));
+    }
+    std::uint64_t next() {
+        state += 0x9E3779B97F4A7C15ULL;
+        return mix(state);
+    }
+    std::uint64_t below(std::uint64_t bound) { // -> uniform in [0, bound)
+        return bound == 0 ? 0 : next() % bound;
+    }
+    double unit() { // -> uniform in [0, 1)
+        return double(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
+
+#define DISTRIBUTIONS(X) \
+    X(Uniform, "uniform") \
+    X(Sorted, "sorted") \
+    X(Reversed, "reversed") \
+    X(NearlySorted, "nearly") \
+    X(FewUnique, "few-unique") \
+    X(Zipf, "zipf") \
+    X(OrganPipe, "organ-pipe") \
+    X(Sawtooth, "sawtooth") \
+    X(SortedRuns, "runs")
+
+#define DISTRIBUTION_ID(id, name) id,
+#define DISTRIBUTION_NAME(id, name) name,
+enum class Distribution { DISTRIBUTIONS(DISTRIBUTION_ID) Count };
+const char* const distributionNames[] = { DISTRIBUTIONS(DISTRIBUTION_NAME) };
+#undef DISTRIBUTION_ID
+#undef DISTRIBUTION_NAME
+
+bool findDistribution(const std::string& name, Distribution& out) {
+    for (std::size_t i = 0; i < std::size_t(Distribution::Count); ++i) {
+        if (name == distributionNames[i]) {
+            out = Distribution(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+struct GeneratorParams {
+    std::uint64_t seed = 1;
+    std::uint64_t range = 1ULL << 30; // -> keys are drawn from [0, range)
+    Index swaps = -1;                 // -> nearly sorted: random swaps, -1 means n / 100
+    std::uint64_t uniqueValues = 16;  // -> few unique: distinct keys
+    double zipfSkew = 1.0;            // -> zipf: exponent s, P(rank r) ~ 1 / r^s
+    Index teeth = 8;                  // -> sawtooth: ascending ramps
+    Index runs = 16;                  // -> sorted runs: independently sorted segments
+};
+
+const Index GENERATOR_CHUNK = 1 << 16;
+Distribution visualDistribution = Distribution::Uniform; // -> --dist, the input shown by the bars and boxes
+
+// Zipf sampler by rejection-inversion (Hörmann & Derflinger), O(1) per draw and no table, so it
+// works for universes far larger than memory.
+struct ZipfSampler {
+    double skew, hX1, hN, threshold;
+    std::uint64_t universe;
+
+    ZipfSampler(std::uint64_t universe_, double skew_) : skew(skew_), universe(std::max<std::uint64_t>(1, universe_)) {
+        hX1 = H(1.5) - 1.0;
+        hN = H(double(universe) + 0.5);
+        threshold = 2.0 - Hinverse(H(2.5) - h(2.0));
+    }
+    static double expm1OverX(double x) { return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5; }
+    static double log1pOverX(double x) { return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * 0.5; }
+    double h(double x) const { return std::exp(-skew * std::log(x)); }
+    double H(double x) const { double lx = std::log(x); return expm1OverX((1.0 - skew) * lx) * lx; }
+    double Hinverse(double y) const {
+        double t = std::max(-1.0, y * (1.0 - skew));
+        return std::exp(log1pOverX(t) * y);
+    }
+    std::uint64_t operator()(SplitMix64& rng) const { // -> rank in [1, universe]
+        while (true) {
+            double u = hN + rng.unit() * (hX1 - hN);
+            double x = Hinverse(u);
+            double k = std::floor(x + 0.5);
+            k = std::min(std::max(k, 1.0), double(universe));
+            if (k - x <= threshold || u >= H(k + 0.5) - h(k)) {
+                return std::uint64_t(k);
+            }
+        }
+    }
+};
+
+template <typename Kind>
+void generateInput(typename Kind::type* out, Index n, Distribution distribution, const GeneratorParams& params) {
+    typedef typename Kind::type T;
+    if (n <= 0) {
+        return;
+    }
+    const std::uint64_t range = std::max<std::uint64_t>(1, params.range);
+    auto ramp = [range](Index i, Index length) { // -> i-th of `length` evenly spaced keys in [0, range)
+        return std::uint64_t((long double)i * range / std::max<Index>(1, length));
+    };
+    ZipfSampler zipf(std::min<std::uint64_t>(range, std::uint64_t(n)), params.zipfSkew);
+    Index tooth = std::max<Index>(1, (n + params.teeth - 1) / std::max<Index>(1, params.teeth));
+    Index runLength = std::max<Index>(1, (n + params.runs - 1) / std::max<Index>(1, params.runs));
+    Index half = (n + 1) / 2;
+
+    Index chunks = (n + GENERATOR_CHUNK - 1) / GENERATOR_CHUNK;
+    parallelFor(chunks, [&](Index chunk) {
+        SplitMix64 rng = SplitMix64::stream(params.seed, std::uint64_t(chunk));
+        Index begin = chunk * GENERATOR_CHUNK;
+        Index end = std::min(n, begin + GENERATOR_CHUNK);
+        for (Index i = begin; i < end; ++i) {
+            std::uint64_t key = 0;
+            switch (distribution) {
+                case Distribution::Uniform:
+                case Distribution::SortedRuns: key = rng.below(range); break;
+                case Distribution::Sorted:
+                case Distribution::NearlySorted: key = ramp(i, n); break;
+                case Distribution::Reversed: key = ramp(n - 1 - i, n); break;
+                case Distribution::FewUnique: key = ramp(Index(rng.below(params.uniqueValues)), Index(params.uniqueValues)); break;
+                case Distribution::Zipf: key = zipf(rng) - 1; break;
+                case Distribution::OrganPipe: key = ramp(i < half ? i : n - 1 - i, half); break;
+                case Distribution::Sawtooth: key = ramp(i % tooth, tooth); break;
+                case Distribution::Count: break;
+            }
+            out[i] = Kind::make(key);
+        }
+    });
+
+    if (distribution == Distribution::NearlySorted) { // -> k swaps, few enough to apply sequentially
+        SplitMix64 rng = SplitMix64::stream(params.seed, ~0ULL);
+        Index swaps = params.swaps < 0 ? n / 100 : params.swaps;
+        for (Index s = 0; s < swaps; ++s) {
+            std::swap(out[rng.below(n)], out[rng.below(n)]);
+        }
+    } else if (distribution == Distribution::SortedRuns) {
+        Index runCount = (n + runLength - 1) / runLength;
+        parallelFor(runCount, [&](Index run) {
+            T* begin = out + run * runLength;
+            std::sort(begin, out + std::min(n, (run + 1) * runLength));
+        });
+    }
+}
+
+//.....................................| Utility functions |.....................................//
+struct AtomicBits { // -> a fixed-size bit set that one thread writes while others read
+    std::unique_ptr<std::atomic<std::uint64_t>[]> words;
+
+    void assign(Index size) {
+        Index count = (size + 63) / 64;
+        words.reset(new std::atomic<std::uint64_t>[count]);
+        for (Index w = 0; w < count; ++w) {
+            words[w].store(0, std::memory_order_relaxed);
+        }
+    }
+    bool set(Index i) { // -> true if the bit was clear
+        std::uint64_t bit = 1ULL << (i & 63);
+        return (words[i >> 6].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+    }
+    bool test(Index i) const {
+        return (words[i >> 6].load(std::memory_order_relaxed) >> (i & 63)) & 1;
+    }
+};
+
+// What a BFS/DFS run shows, written by the run thread only: bit sets of discovered and expanded nodes,
+// the color of expanded nodes, and the discovery order as an append log whose entries are released by
+// a store of its length. The renderer colors the nodes from this every frame and never waits for the
+// run; resetTree() only rewrites it after the run thread has been joined.
+struct TraversalState {
+    AtomicBits discovered, expanded;
+    std::unique_ptr<int[]> order;
+    std::atomic<Index> length{0};
+    std::atomic<std::uint32_t> rgba{0xFFFFFFFF};
+
+    void assign(Index nodes) {
+        discovered.assign(nodes);
+        expanded.assign(nodes);
+        order.reset(new int[std::max<Index>(1, nodes)]);
+        length.store(0, std::memory_order_relaxed);
+    }
+    bool discover(int node) { // -> appends a newly discovered node to the order, false if it was seen before
+        if (!discovered.set(node)) {
+            return false;
+        }
+        Index at = length.load(std::memory_order_relaxed);
+        order[at] = node;
+        length.store(at + 1, std::memory_order_release);
+        return true;
+    }
+    void expand(int node, const sf::Color& color) {
+        visualOps++;
+        rgba.store(std::uint32_t(color.r) << 24 | std::uint32_t(color.g) << 16 | std::uint32_t(color.b) << 8 | color.a, std::memory_order_relaxed);
+        expanded.set(node);
+    }
+    sf::Color color() const {
+        std::uint32_t c = rgba.load(std::memory_order_relaxed);
+        return sf::Color(std::uint8_t(c >> 24), std::uint8_t(c >> 16), std::uint8_t(c >> 8), std::uint8_t(c));
+    }
+};
+
+TraversalState traversal;
+
+std::uint64_t nextVisualSeed() { // -> every reset draws the next input of a reproducible sequence
+    return SplitMix64::mix(visualSeed + visualResets++);
+}
+
+void resetArray() {
+    GeneratorParams params;
+    params.seed = nextVisualSeed();
+    params.range = 651;
+    generateInput<BarKind>(array.data(), NUM_BARS, visualDistribution, params);
+    for (int i = 0; i < NUM_BARS; ++i) {
+        bars[i].setSize(sf::Vector2f(BAR_WIDTH, array[i]));
+        bars[i].setPosition(i * BAR_WIDTH, WINDOW_HEIGHT - array[i]);
+        bars[i].setFillColor(sf::Color::White);
+    }
+    isArraySorted = false;
+    sceneDirty = true;
+    streamSnapshot(array.data(), NUM_BARS, currentAlgorithm);
+}
+
+void resetTree() {
+    nodes.clear();
+    edges.clear();
+    nodePositions.clear();
+    traversal.assign(Index(tree.size()));
+    traversalCompleted = false;
+    isTreeTraversal = false;
+
+    // Every node gets a share of the width in proportion to the leaves below it, at most NODE_SPACING
+    // per leaf, and one row per level, so generated trees of any shape fit the window.
+    std::vector<int> order{0}, depth(tree.size(), 0);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        for (int child : tree[order[i]]) {
+            depth[child] = depth[order[i]] + 1;
+            order.push_back(child);
+        }
+    }
+    std::vector<float> leaves(tree.size(), 0.0f), left(tree.size(), 0.0f);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        leaves[*it] = tree[*it].empty() ? 1.0f : leaves[*it];
+        for (int child : tree[*it]) {
+            leaves[*it] += leaves[child];
+        }
+    }
+    float slot = std::min<float>(NODE_SPACING, (WINDOW_WIDTH - 2 * NODE_RADIUS) / leaves[0]);
+    float row = std::min<float>(NODE_SPACING, float(WINDOW_HEIGHT - TREE_START_Y - 2 * NODE_RADIUS) / std::max(1, depth[order.back()]));
+    left[0] = (WINDOW_WIDTH - leaves[0] * slot) / 2;
+    nodes.assign(tree.size(), sf::CircleShape(NODE_RADIUS));
+    for (int node : order) {
+        sf::Vector2f pos(left[node] + leaves[node] * slot / 2, TREE_START_Y + depth[node] * row);
+        nodes[node].setFillColor(sf::Color::White);
+        nodes[node].setPosition(pos - sf::Vector2f(NODE_RADIUS, NODE_RADIUS));
+        nodePositions[node] = pos;
+        float childLeft = left[node];
+        for (int child : tree[node]) {
+            left[child] = childLeft;
+            childLeft += leaves[child] * slot;
+        }
+    }
+    for (int node : order) {
+        for (int child : tree[node]) {
+            sf::VertexArray edge(sf::Lines, 2);
+            edge[0].position = nodePositions[node];
+            edge[1].position = nodePositions[child];
+            edge[0].color = sf::Color::White;
+            edge[1].color = sf::Color::White;
+            edges.push_back(edge);
+        }
+    }
+    sceneDirty = true;
+}
+
+void resetBoxes() { // -> reseting array boxes
+    boxes.clear();
+    boxTexts.clear();
+    for (int i = 0; i < MAX_ARRAY_SIZE; ++i) {
+        sf::RectangleShape box(sf::Vector2f(BOX_SIZE, BOX_SIZE));
+        box.setPosition(ARRAY_START_X + i * (BOX_SIZE + BOX_SPACING), ARRAY_START_Y);
+        box.setFillColor(sf::Color::White);
+        boxes.push_back(box);
+
+        sf::Text text;
+        text.setFont(font);
+        text.setString(std::to_string(searchArray[i]));
+        text.setCharacterSize(20);
+        text.setFillColor(sf::Color::Black);
+        text.setPosition(ARRAY_START_X + i * (BOX_SIZE + BOX_SPACING) + BOX_SIZE / 4, ARRAY_START_Y + BOX_SIZE / 4);
+        boxTexts.push_back(text);
+    }
+    searchCompleted = false;
+    sceneDirty = true;
+}
+
+void resetSearchArray() {
+    GeneratorParams params;
+    params.seed = nextVisualSeed();
+    params.range = 150;
+    generateInput<BoxKind>(searchArray.data(), MAX_ARRAY_SIZE, visualDistribution, params);
+    std::sort(searchArray.begin(), searchArray.end());
+    isSearchArraySorted = true;
+    resetBoxes();
+}
+
+void drawArray(sf::RenderWindow& window) {// -> drawing the array
+    for (int i = 0; i < NUM_BARS; ++i) {
+        window.draw(bars[i]);
+    }
+}
+
+void drawTree(sf::RenderWindow& window) {
+    for (const auto& edge : edges) {
+        window.draw(edge);
+    }
+    sf::Color expandedColor = traversal.color();
+    for (int i = 0; i < int(nodes.size()); ++i) { // -> expanded nodes in the run's color, queued ones grey
+        nodes[i].setFillColor(traversal.expanded.test(i) ? expandedColor : traversal.discovered.test(i) ? sf::Color(190, 190, 190) : sf::Color::White);
+        window.draw(nodes[i]);
+        sf::Text text;
+        text.setFont(font);
+        text.setString(std::to_string(i));
+        text.setCharacterSize(20);
+        text.setFillColor(sf::Color::Black);
+        text.setPosition(nodePositions[i] - sf::Vector2f(NODE_RADIUS / 2, NODE_RADIUS / 2));
+        window.draw(text);
+    }
+
+    Index length = traversal.length.load(std::memory_order_acquire); // -> entries below length are complete
+    if (length > 0) {
+        std::string line = "discovery order:";
+        for (Index i = 0; i < length; ++i) {
+            line += " " + std::to_string(traversal.order[i]);
+        }
+        sf::Text order(line, font, 16);
+        order.setFillColor(sf::Color(160, 160, 160));
+        order.setPosition(10, WINDOW_HEIGHT - 30);
+        window.draw(order);
+    }
+}
+
+void drawBoxes(sf::RenderWindow& window) {
+    for (const auto& box : boxes) {
+        window.draw(box);
+    }
+    for (const auto& text : boxTexts) {
+        window.draw(text);
+    }
+}
+
+// Snapshot of the loser tree of the multiway merge, published by the sorting thread and drawn next
+// to the bars. sources[s] is the head value of run s, or -1 once the run is exhausted.
+struct TournamentView {
+    bool active = false;
+    std::vector<std::size_t> nodes;
+    std::vector<int> sources;
+};
+
+TournamentView tournamentView;
+std::mutex tournamentMutex;
+
+void drawTournament(sf::RenderWindow& window) {
+    TournamentView view;
+    {
+        std::lock_guard<std::mutex> lock(tournamentMutex);
+        if (!tournamentView.active) {
+            return;
+        }
+        view = tournamentView;
+    }
+    const float left = 700, width = 480, top = 20, rowHeight = 34, radius = 13;
+    std::size_t k = view.sources.size();
+    auto position = [&](std::size_t index) { // -> implicit heap position, 0 is the winner above the root
+        if (index == 0) {
+            return sf::Vector2f(left + width / 2, top);
+        }
+        int depth = 0;
+        while ((std::size_t(2) << depth) <= index) {
+            depth++;
+        }
+        float slots = float(std::size_t(1) << depth);
+        return sf::Vector2f(left + (index - slots + 0.5f) * width / slots, top + (depth + 1) * rowHeight);
+    };
+    auto label = [&](std::size_t source) {
+        return view.sources[source] < 0 ? std::string("inf") : std::to_string(view.sources[source]);
+    };
+
+    sf::VertexArray lines(sf::Lines);
+    for (std::size_t index = 1; index < 2 * k; ++index) {
+        sf::Vector2f from = position(index), to = position(index / 2);
+        lines.append(sf::Vertex(from, sf::Color(120, 120, 120)));
+        lines.append(sf::Vertex(to, sf::Color(120, 120, 120)));
+    }
+    window.draw(lines);
+
+    sf::CircleShape node(radius);
+    sf::Text text;
+    text.setFont(font);
+    text.setCharacterSize(12);
+    text.setFillColor(sf::Color::Black);
+    for (std::size_t index = 0; index < 2 * k; ++index) {
+        bool leaf = index >= k && k > 0;
+        std::size_t source = leaf ? index - k : view.nodes[index];
+        node.setFillColor(index == 0 ? sf::Color::Green : leaf ? sf::Color(255, 218, 185) : sf::Color(173, 216, 230));
+        node.setPosition(position(index) - sf::Vector2f(radius, radius));
+        window.draw(node);
+        text.setString(label(source));
+        text.setPosition(position(index) - sf::Vector2f(radius - 2, radius / 2));
+        window.draw(text);
+    }
+}
+
+// A sorting network stage: every lane is compared with partner[lane] and keeps the larger of the
+// two when takeMax[lane] is set, the smaller one otherwise. The same tables drive the AVX2 kernels
+// (as permute indices and blend masks) and their scalar emulation, which is what the window shows.
+struct NetworkStage {
+    std::vector<int> partner;
+    std::vector<char> takeMax;
+};
+
+std::vector<NetworkStage> buildBitonicSort(int lanes) { // -> sorts one register of `lanes` keys
+    std::vector<NetworkStage> stages;
+    for (int k = 2; k <= lanes; k *= 2) {
+        for (int j = k / 2; j > 0; j /= 2) {
+            NetworkStage stage;
+            for (int i = 0; i < lanes; ++i) {
+                bool ascending = (i & k) == 0;
+                bool upper = (i & j) != 0;
+                stage.partner.push_back(i ^ j);
+                stage.takeMax.push_back(upper == ascending);
+            }
+            stages.push_back(stage);
+        }
+    }
+    return stages;
+}
+
+std::vector<NetworkStage> buildBitonicMerge(int lanes) { // -> merges two sorted registers held as 2 * lanes keys
+    std::vector<NetworkStage> stages(1);
+    for (int i = 0; i < 2 * lanes; ++i) { // -> compare against the reversed second register
+        stages[0].partner.push_back(2 * lanes - 1 - i);
+        stages[0].takeMax.push_back(i >= lanes);
+    }
+    for (int j = lanes / 2; j > 0; j /= 2) { // -> then each half is bitonic and is cleaned on its own
+        NetworkStage stage;
+        for (int i = 0; i < 2 * lanes; ++i) {
+            stage.partner.push_back(i ^ j);
+            stage.takeMax.push_back((i & j) != 0);
+        }
+        stages.push_back(stage);
+    }
+    return stages;
+}
+
+const std::vector<NetworkStage>& bitonicSortNetwork(int lanes) {
+    static const std::vector<NetworkStage> four = buildBitonicSort(4), eight = buildBitonicSort(8);
+    return lanes == 4 ? four : eight;
+}
+
+const std::vector<NetworkStage>& bitonicMergeNetwork(int lanes) {
+    static const std::vector<NetworkStage> four = buildBitonicMerge(4), eight = buildBitonicMerge(8);
+    return lanes == 4 ? four : eight;
+}
+
+// Snapshot of the network the SIMD sort is stepping through: the lane values before `stage`.
+struct NetworkView {
+    const std::vector<NetworkStage>* stages = nullptr;
+    int stage = 0;
+    std::vector<int> lanes;
+};
+
+NetworkView networkView;
+std::mutex networkMutex;
+
+void drawNetwork(sf::RenderWindow& window) {
+    NetworkView view;
+    {
+        std::lock_guard<std::mutex> lock(networkMutex);
+        if (!networkView.stages) {
+            return;
+        }
+        view = networkView;
+    }
+    const float left = 740, right = 1180, top = 20, height = 180;
+    std::size_t count = view.lanes.size();
+    float wireGap = height / float(count);
+    float stageGap = (right - left) / float(view.stages->size() + 1);
+
+    sf::VertexArray lines(sf::Lines);
+    for (std::size_t i = 0; i < count; ++i) {
+        float y = top + (i + 0.5f) * wireGap;
+        lines.append(sf::Vertex(sf::Vector2f(left, y), sf::Color(120, 120, 120)));
+        lines.append(sf::Vertex(sf::Vector2f(right, y), sf::Color(120, 120, 120)));
+    }
+    for (std::size_t s = 0; s < view.stages->size(); ++s) {
+        const NetworkStage& stage = (*view.stages)[s];
+        sf::Color color = int(s) == view.stage ? sf::Color::Red : sf::Color(173, 216, 230);
+        for (std::size_t i = 0; i < count; ++i) {
+            std::size_t p = std::size_t(stage.partner[i]);
+            if (p <= i) {
+                continue;
+            }
+            // -> comparators of one stage are staggered a little so overlapping spans stay readable
+            float x = left + (s + 1) * stageGap + float(i % 4) * 4;
+            lines.append(sf::Vertex(sf::Vector2f(x, top + (i + 0.5f) * wireGap), color));
+            lines.append(sf::Vertex(sf::Vector2f(x, top + (p + 0.5f) * wireGap), color));
+        }
+    }
+    window.draw(lines);
+
+    sf::Text text;
+    text.setFont(font);
+    text.setCharacterSize(10);
+    text.setFillColor(sf::Color::White);
+    for (std::size_t i = 0; i < count; ++i) {
+        text.setString(std::to_string(view.lanes[i]));
+        text.setPosition(left - 36, top + i * wireGap);
+        window.draw(text);
+    }
+}
+
+//.....................................| Tournament tree |.....................................//
+// Loser tree for k-way merging. Sources are numbered 0..k-1; leaf s sits at implicit position k + s,
+// internal node j (1..k-1) stores the source that lost the match played there and nodes()[0] the
+// overall winner. Advancing the winner replays only its leaf-to-root path: ceil(log2 k) comparisons
+// per output element, against one loser per level, whatever k is. The comparison is supplied by the
+// caller as less(x, y) over source numbers, ties go to the lower source so merges stay stable.
+class LoserTree {
+public:
+    void reset(std::size_t sources) {
+        k = sources;
+        tree.assign(std::max<std::size_t>(1, k), 0);
+        done.assign(k, 0);
+    }
+    void exhaust(std::size_t source) { // -> `source` has no more elements, it now loses every match
+        done[source] = 1;
+    }
+    template <typename Less>
+    void build(Less less) {
+        if (k > 0) {
+            tree[0] = play(1, less);
+        }
+    }
+    template <typename Less>
+    void replay(Less less) { // -> after the winner's head changed or it was exhausted
+        std::size_t winner = tree[0];
+        for (std::size_t node = (k + winner) / 2; node > 0; node /= 2) {
+            if (beats(tree[node], winner, less)) {
+                std::swap(tree[node], winner);
+            }
+        }
+        tree[0] = winner;
+    }
+    bool empty() const { return k == 0 || done[tree[0]]; }
+    bool exhausted(std::size_t source) const { return done[source] != 0; }
+    std::size_t winner() const { return tree[0]; }
+    std::size_t size() const { return k; }
+    const std::vector<std::size_t>& nodes() const { return tree; }
+
+private:
+    template <typename Less>
+    bool beats(std::size_t x, std::size_t y, Less& less) const {
+        if (done[x] || done[y]) {
+            return !done[x] && done[y];
+        }
+        return x < y ? !less(y, x) : less(x, y); // -> one comparison, the lower source wins ties
+    }
+    template <typename Less>
+    std::size_t play(std::size_t node, Less& less) { // -> winner of the subtree at `node`, losers stored on the way up
+        if (node >= k) {
+            return node - k;
+        }
+        std::size_t left = play(2 * node, less);
+        std::size_t right = play(2 * node + 1, less);
+        bool leftWins = beats(left, right, less);
+        tree[node] = leftWins ? right : left;
+        return leftWins ? left : right;
+    }
+
+    std::size_t k = 0;
+    std::vector<std::size_t> tree;
+    std::vector<char> done;
+};
+
+//.....................................| Algorithm policies |.....................................//
+// Every sorting and search algorithm is written once, as a template over a policy that receives
+// its events. The native policy's hooks are empty and inline away, so the same body compiles to a
+// plain sort for the benchmark; the visual policies turn the events into bar/box updates and sleeps.
+//
+// Hooks an algorithm may call:
+//   compared(i, j)        -> positions i and j (or a held key taken from j) were compared
+//   swapped(i, j)         -> positions i and j were exchanged
+//   written(i)            -> position i received a new value
+//   placed(i)             -> position i received its final value for this step, no pacing needed
+//   probed(i)             -> a search inspected position i
+//   missed(i)             -> a linear scan rejected position i
+//   found(i)              -> a search located the value at position i
+//   tournament(tree, hs)  -> a k-way merge replayed its loser tree, hs[s] is the head position of
+//                            source s (-1 when exhausted); a null tree means the merge is over
+//   network(st, s, v, c)  -> a sorting network is about to apply stage s of *st to the c lane
+//                            values v; a null network means it is done
+//   region(b, e, w)       -> positions [b, e) are now owned by worker w of a parallel sort, -1 releases them
+//   rotated(f, m, l)      -> the blocks [f, m) and [m, l) exchanged places
+//   buffer(b, e)          -> an in-place merge's internal buffer now sits at [b, e), empty once it is dissolved
+//   proceed()             -> pause/cancel point, false means the run was abandoned and the algorithm must return
+// QuietHooks gives every hook an empty default, so a policy only spells out the events it cares about.
+// A policy with concurrent = true may have its hooks called from several workers at once (on
+// disjoint positions); parallel algorithms run their stages on one thread for the others.
+struct QuietHooks {
+    static constexpr bool concurrent = true;
+    void compared(Index, Index) {}
+    void swapped(Index, Index) {}
+    void written(Index) {}
+    void placed(Index) {}
+    void probed(Index) {}
+    void missed(Index) {}
+    void found(Index) {}
+    void tournament(const LoserTree*, const Index*) {}
+    template <typename T>
+    void network(const std::vector<NetworkStage>*, int, const T*, int) {}
+    void region(Index, Index, int) {}
+    void rotated(Index, Index, Index) {}
+    void buffer(Index, Index) {}
+    bool proceed() { return true; }
+};
+
+struct NativePolicy : QuietHooks {
+    static constexpr bool visual = false;
+};
+
+struct CountingPolicy : QuietHooks { // -> native run that tallies the events, used to report data movement
+    static constexpr bool visual = false;
+    static constexpr bool concurrent = false;
+    unsigned long long comparisons = 0;
+    unsigned long long swaps = 0;
+    unsigned long long writes = 0;
+    unsigned long long probes = 0;
+    void compared(Index, Index) { comparisons++; }
+    void swapped(Index, Index) { swaps++; }
+    void written(Index) { writes++; }
+    void placed(Index) { writes++; }
+    void probed(Index) { probes++; }
+    void missed(Index) { probes++; }
+    void rotated(Index first, Index middle, Index last) { swaps += (middle - first) / 2 + (last - middle) / 2 + (last - first) / 2; } // -> three reversals
+};
+
+void wakeRuns() { // -> after a reset or a resume, so a waiting run notices now instead of at the end of its sleep
+    { std::lock_guard<std::mutex> lock(runWakeMutex); }
+    runWake.notify_all();
+}
+
+struct RunControl { // -> a run belongs to the generation it started in, resetAll() moves on to the next one
+    unsigned generation = runGeneration;
+
+    bool proceed() const {
+        if (isPaused && runGeneration == generation) {
+            TraceSpan span("paused", "control");
+            std::unique_lock<std::mutex> lock(runWakeMutex);
+            runWake.wait(lock, [this] { return !isPaused || runGeneration != generation; });
+        }
+        return runGeneration == generation;
+    }
+    bool sleep(int ms) const { // -> an animation delay that a reset cuts short, false once the run has been reset
+        std::unique_lock<std::mutex> lock(runWakeMutex);
+        return !runWake.wait_for(lock, std::chrono::milliseconds(ms), [this] { return runGeneration != generation; });
+    }
+};
+
+struct SortVisualPolicy : QuietHooks, RunControl {
+    static constexpr bool visual = true;
+    const int* values = array.data();
+    std::vector<Index> marked; // -> run heads currently highlighted by tournament()
+    std::vector<sf::Color> tint = std::vector<sf::Color>(NUM_BARS, sf::Color::White); // -> resting color, set by region() and buffer()
+    Index bufferBegin = 0, bufferEnd = 0;
+
+    std::atomic<unsigned long long> updates{0}; // -> bar updates so far, traced as a counter
+
+    void refresh(Index i) {
+        bars[i].setSize(sf::Vector2f(BAR_WIDTH, values[i]));
+        bars[i].setPosition(i * BAR_WIDTH, WINDOW_HEIGHT - values[i]);
+        traceCounter("bar updates", double(++updates));
+    }
+    void compared(Index i, Index j) {
+        visualOps++;
+        streamEvent(StreamOp::Compare, i, j);
+    }
+    void swapped(Index i, Index j) {
+        visualOps++;
+        streamEvent(StreamOp::Swap, i, j);
+        bars[i].setFillColor(sf::Color::Red);
+        bars[j].setFillColor(sf::Color::Red);
+        refresh(i);
+        refresh(j);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        bars[i].setFillColor(tint[i]);
+        bars[j].setFillColor(tint[j]);
+    }
+    void written(Index i) {
+        visualOps++;
+        streamEvent(StreamOp::Write, i, values[i]);
+        bars[i].setFillColor(sf::Color::Red);
+        refresh(i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        bars[i].setFillColor(tint[i]);
+    }
+    void placed(Index i) {
+        visualOps++;
+        streamEvent(StreamOp::Write, i, values[i]);
+        refresh(i);
+    }
+    void tournament(const LoserTree* tree, const Index* heads) {
+        for (Index i : marked) {
+            bars[i].setFillColor(tint[i]);
+        }
+        marked.clear();
+        std::lock_guard<std::mutex> lock(tournamentMutex);
+        tournamentView.active = tree != nullptr;
+        if (!tree) {
+            return;
+        }
+        tournamentView.nodes = tree->nodes();
+        tournamentView.sources.resize(tree->size());
+        for (std::size_t s = 0; s < tree->size(); ++s) {
+            tournamentView.sources[s] = heads[s] < 0 ? -1 : values[heads[s]];
+            if (heads[s] >= 0) {
+                bars[heads[s]].setFillColor(sf::Color::Yellow);
+                marked.push_back(heads[s]);
+            }
+        }
+        sleep(10); // -> one winner step per frame or so, a reset cuts it short and the caller's proceed() sees it
+    }
+    void network(const std::vector<NetworkStage>* stages, int stage, const int* lanes, int count) {
+        {
+            std::lock_guard<std::mutex> lock(networkMutex);
+            networkView.stages = stages;
+            networkView.stage = stage;
+            networkView.lanes.assign(lanes, lanes + (stages ? count : 0));
+        }
+        if (stages) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    void rotated(Index first, Index middle, Index last) {
+        for (Index i = first; i < last; ++i) {
+            streamEvent(StreamOp::Write, i, values[i]);
+            bars[i].setFillColor(i < middle ? sf::Color(255, 165, 0) : sf::Color(186, 85, 211));
+            refresh(i);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        for (Index i = first; i < last; ++i) {
+            bars[i].setFillColor(tint[i]);
+        }
+    }
+    void buffer(Index begin, Index end) {
+        for (Index i = bufferBegin; i < bufferEnd; ++i) {
+            tint[i] = sf::Color::White;
+            bars[i].setFillColor(tint[i]);
+        }
+        bufferBegin = begin;
+        bufferEnd = end;
+        for (Index i = begin; i < end; ++i) {
+            tint[i] = sf::Color(135, 206, 250);
+            bars[i].setFillColor(tint[i]);
+        }
+    }
+    void region(Index begin, Index end, int worker) {
+        static const sf::Color workers[] = {sf::Color(173, 216, 230), sf::Color(144, 238, 144), sf::Color(255, 182, 193),
+                                            sf::Color(255, 160, 122), sf::Color(216, 191, 216), sf::Color(255, 255, 160)};
+        for (Index i = begin; i < end; ++i) {
+            tint[i] = worker < 0 ? sf::Color::White : workers[worker % 6];
+            bars[i].setFillColor(tint[i]);
+        }
+    }
+    bool proceed() const { return RunControl::proceed(); }
+};
+
+struct SearchVisualPolicy : QuietHooks, RunControl {
+    static constexpr bool visual = true;
+    unsigned long long probes = 0; // -> traced as a counter
+
+    void probed(Index i) {
+        traceCounter("probes", double(++probes));
+        visualOps++;
+        boxes[i].setFillColor(sf::Color::Yellow);
+        sleep(500);
+    }
+    void missed(Index i) {
+        boxes[i].setFillColor(sf::Color::Red);
+        sleep(100);
+    }
+    void found(Index i) {
+        boxes[i].setFillColor(sf::Color::Green);
+    }
+    bool proceed() const { return RunControl::proceed(); }
+};
+
+// Forwards every hook with positions moved by `offset`, so an algorithm can run on a slice a + offset
+// of the array and still report positions of the whole array.
+template <typename Policy>
+struct ShiftedPolicy {
+    static constexpr bool visual = Policy::visual;
+    static constexpr bool concurrent = Policy::concurrent;
+    Policy& inner;
+    Index offset;
+
+    void compared(Index i, Index j) { inner.compared(offset + i, offset + j); }
+    void swapped(Index i, Index j) { inner.swapped(offset + i, offset + j); }
+    void written(Index i) { inner.written(offset + i); }
+    void placed(Index i) { inner.placed(offset + i); }
+    void probed(Index i) { inner.probed(offset + i); }
+    void missed(Index i) { inner.missed(offset + i); }
+    void found(Index i) { inner.found(offset + i); }
+    void tournament(const LoserTree* tree, const Index* heads) {
+        std::vector<Index> moved;
+        for (std::size_t s = 0; tree && s < tree->size(); ++s) {
+            moved.push_back(heads[s] < 0 ? -1 : offset + heads[s]);
+        }
+        inner.tournament(tree, moved.data());
+    }
+    template <typename T>
+    void network(const std::vector<NetworkStage>* stages, int stage, const T* lanes, int count) {
+        inner.network(stages, stage, lanes, count);
+    }
+    void region(Index begin, Index end, int worker) { inner.region(offset + begin, offset + end, worker); }
+    void rotated(Index first, Index middle, Index last) { inner.rotated(offset + first, offset + middle, offset + last); }
+    void buffer(Index begin, Index end) { inner.buffer(offset + begin, offset + end); }
+    bool proceed() { return inner.proceed(); }
+};
+
+// Runs fn(policy) with the hooks shifted by `offset`; only the visual policies care where an event
+// happened, the others get the policy unchanged.
+template <typename Policy, typename Fn>
+void withOffset(Policy& obs, Index offset, Fn fn) {
+    if constexpr (Policy::visual) {
+        ShiftedPolicy<Policy> shifted{obs, offset};
+        fn(shifted);
+    } else {
+        fn(obs);
+    }
+}
+
+//.....................................| Funciones de Ordenamiento |.....................................//
+template <typename T, typename Policy>
+void bubbleSort(T* a, Index n, Policy& obs) {
+    for (Index i = 0; i < n - 1; ++i) {
+        for (Index j = 0; j < n - i - 1; ++j) {
+            obs.compared(j, j + 1);
+            if (a[j] > a[j + 1]) {
+                std::swap(a[j], a[j + 1]);
+                obs.swapped(j, j + 1);
+            }
+            if (!obs.proceed()) {
+                return;
+            }
+        }
+    }
+}
+
+template <typename T, typename Policy>
+void insertionSortRange(T* a, Index left, Index right, Policy& obs) {
+    for (Index i = left + 1; i <= right; ++i) {
+        T key = std::move(a[i]);
+        Index j = i - 1;
+        while (j >= left) {
+            obs.compared(j, i);
+            if (!(a[j] > key)) {
+                break;
+            }
+            a[j + 1] = std::move(a[j]);
+            obs.written(j + 1);
+            j--;
+            if (!obs.proceed()) {
+                return;
+            }
+        }
+        a[j + 1] = std::move(key);
+        obs.placed(j + 1);
+    }
+}
+
+template <typename T, typename Policy>
+void insertionSort(T* a, Index n, Policy& obs) {
+    insertionSortRange(a, 0, n - 1, obs);
+}
+
+template <typename T, typename Policy>
+void selectionSort(T* a, Index n, Policy& obs) {
+    for (Index i = 0; i < n - 1; ++i) {
+        Index minIndex = i;
+        for (Index j = i + 1; j < n; ++j) {
+            obs.compared(j, minIndex);
+            if (a[j] < a[minIndex]) {
+                minIndex = j;
+            }
+        }
+        std::swap(a[i], a[minIndex]);
+        obs.swapped(i, minIndex);
+        if (!obs.proceed()) {
+            return;
+        }
+    }
+}
+
+template <typename T, typename Policy>
+void quickSortRange(T* a, Index low, Index high, Policy& obs) {
+    while (low < high) {
+        const T& pivot = a[high]; // -> a[high] is not touched until the partition loop is done
+        Index i = low - 1;
+        for (Index j = low; j < high; ++j) {
+            obs.compared(j, high);
+            if (a[j] < pivot) {
+                i++;
+                std::swap(a[i], a[j]);
+                obs.swapped(i, j);
+            }
+            if (!obs.proceed()) {
+                return;
+            }
+        }
+        std::swap(a[i + 1], a[high]);
+        obs.swapped(i + 1, high);
+        Index pi = i + 1;
+        if (pi - low < high - pi) { // -> recurse into the smaller side, so sorted inputs cannot exhaust the stack
+            quickSortRange(a, low, pi - 1, obs);
+            low = pi + 1;
+        } else {
+            quickSortRange(a, pi + 1, high, obs);
+            high = pi - 1;
+        }
+    }
+}
+
+template <typename T, typename Policy>
+void quickSort(T* a, Index n, Policy& obs) {
+    quickSortRange(a, 0, n - 1, obs);
+}
+
+template <typename T, typename Policy>
+void mergeSortRange(T* a, Index left, Index right, T* temp, Policy& obs) { // -> temp is a scratch array as long as a
+    if (left < right && obs.proceed()) {
+        Index mid = left + (right - left) / 2;
+        mergeSortRange(a, left, mid, temp, obs);
+        mergeSortRange(a, mid + 1, right, temp, obs);
+        Index i = left, j = mid + 1, k = left;
+        while (i <= mid && j <= right) {
+            obs.compared(i, j);
+            if (a[i] <= a[j]) {
+                temp[k++] = std::move(a[i++]);
+            } else {
+                temp[k++] = std::move(a[j++]);
+            }
+        }
+        while (i <= mid) {
+            temp[k++] = std::move(a[i++]);
+        }
+        while (j <= right) {
+            temp[k++] = std::move(a[j++]);
+        }
+        for (Index i = left; i <= right; ++i) {
+            a[i] = std::move(temp[i]);
+            obs.written(i);
+            if (!obs.proceed()) {
+                return;
+            }
+        }
+    }
+}
+
+template <typename T, typename Policy>
+void mergeSort(T* a, Index n, Policy& obs) {
+    ScratchBuffer<T> temp(n);
+    mergeSortRange(a, 0, n - 1, temp.data(), obs);
+}
+
+template <typename T, typename Policy>
+void heapify(T* a, Index n, Index i, Policy& obs) {
+    Index largest = i;
+    Index left = 2 * i + 1;
+    Index right = 2 * i + 2;
+
+    if (left < n) {
+        obs.compared(left, largest);
+        if (a[left] > a[largest]) {
+            largest = left;
+        }
+    }
+
+    if (right < n) {
+        obs.compared(right, largest);
+        if (a[right] > a[largest]) {
+            largest = right;
+        }
+    }
+
+    if (largest != i) {
+        std::swap(a[i], a[largest]);
+        obs.swapped(i, largest);
+        heapify(a, n, largest, obs);
+    }
+}
+
+template <typename T, typename Policy>
+void heapSort(T* a, Index n, Policy& obs) {
+    for (Index i = n / 2 - 1; i >= 0; i--) {
+        heapify(a, n, i, obs);
+    }
+
+    for (Index i = n - 1; i > 0; i--) {
+        std::swap(a[0], a[i]);
+        obs.swapped(0, i);
+        heapify(a, i, 0, obs);
+        if (!obs.proceed()) {
+            return;
+        }
+    }
+}
+
+// Hole-based sift-down: the sifted value is held aside and larger children move up into the hole,
+// one move per level instead of a three-move swap. Children of i are i*Arity+1 .. i*Arity+Arity.
+// `lifted` says the value was taken out of a[hole] itself, so leaving it there is not reported as a write.
+template <int Arity, typename T, typename Policy>
+void siftDownHole(T* a, Index n, Index hole, T value, bool lifted, Policy& obs) {
+    Index start = hole;
+    for (Index first = hole * Arity + 1; first < n; first = hole * Arity + 1) {
+        Index largest = first;
+        Index last = std::min(first + Arity, n);
+        for (Index child = first + 1; child < last; ++child) {
+            obs.compared(child, largest);
+            if (a[largest] < a[child]) {
+                largest = child;
+            }
+        }
+        obs.compared(largest, hole);
+        if (!(value < a[largest])) {
+            break;
+        }
+        a[hole] = std::move(a[largest]);
+        obs.written(hole);
+        hole = largest;
+    }
+    a[hole] = std::move(value);
+    if (!lifted || hole != start) {
+        obs.written(hole);
+    }
+}
+
+// Floyd's bottom-up sift: walks the hole down to a leaf along the larger children (one comparison per
+// level, without testing the value), then sifts the value back up. The value usually belongs near the
+// bottom, so the way up is short and the total is close to n log n comparisons instead of 2 n log n.
+template <typename T, typename Policy>
+void siftDownFloyd(T* a, Index n, Index hole, T value, bool lifted, Policy& obs) {
+    Index top = hole;
+    for (Index child = 2 * hole + 1; child < n; child = 2 * hole + 1) {
+        if (child + 1 < n) {
+            obs.compared(child, child + 1);
+            if (a[child] < a[child + 1]) {
+                ++child;
+            }
+        }
+        a[hole] = std::move(a[child]);
+        obs.written(hole);
+        hole = child;
+    }
+    while (hole > top) {
+        Index parent = (hole - 1) / 2;
+        obs.compared(parent, hole);
+        if (!(a[parent] < value)) {
+            break;
+        }
+        a[hole] = std::move(a[parent]);
+        obs.written(hole);
+        hole = parent;
+    }
+    a[hole] = std::move(value);
+    if (!lifted || hole != top) {
+        obs.written(hole);
+    }
+}
+
+template <typename T, typename Policy, typename Sift>
+void heapSortWith(T* a, Index n, Policy& obs, Index arity, Sift sift) {
+    for (Index i = (n - 2) / arity; n > 1 && i >= 0; --i) {
+        sift(a, n, i, std::move(a[i]), true, obs);
+        if (!obs.proceed()) {
+            return;
+        }
+    }
+    for (Index end = n - 1; end > 0 && obs.proceed(); --end) {
+        T value = std::move(a[end]);
+        a[end] = std::move(a[0]);
+        obs.written(end);
+        sift(a, end, 0, std::move(value), false, obs);
+    }
+}
+
+template <typename T, typename Policy>
+void holeHeapSort(T* a, Index n, Policy& obs) {
+    heapSortWith(a, n, obs, 2, [](T* h, Index size, Index i, T value, bool lifted, auto& local) { siftDownHole<2>(h, size, i, std::move(value), lifted, local); });
+}
+
+template <typename T, typename Policy>
+void floydHeapSort(T* a, Index n, Policy& obs) {
+    heapSortWith(a, n, obs, 2, [](T* h, Index size, Index i, T value, bool lifted, auto& local) { siftDownFloyd(h, size, i, std::move(value), lifted, local); });
+}
+
+// d-ary heap (LaMarca and Ladner): a wider node makes the heap log2(Arity) times shallower, and when
+// the Arity children of a node share one cache line each level costs a single miss. The children of
+// i start at i*Arity+1, so the heap is placed `shift` elements into the array to line those groups
+// up with the cache line. The skipped prefix is filled with the `shift` smallest keys first, in order.
+template <int Arity, typename T, typename Policy>
+void dAryHeapSort(T* a, Index n, Policy& obs) {
+    const std::size_t group = std::min<std::size_t>(Arity * sizeof(T), 64);
+    Index shift = Index((group - (reinterpret_cast<std::uintptr_t>(a + 1) % group)) % group / sizeof(T));
+    if (n < 4 * Arity || group % sizeof(T) != 0) { // -> small arrays, or keys that do not tile a cache line
+        shift = 0;
+    }
+    if (shift > 0) {
+        insertionSortRange(a, 0, shift - 1, obs);
+        for (Index i = shift; i < n && obs.proceed(); ++i) {
+            obs.compared(i, shift - 1);
+            if (a[i] < a[shift - 1]) {
+                std::swap(a[i], a[shift - 1]);
+                obs.swapped(i, shift - 1);
+                for (Index j = shift - 1; j > 0 && a[j] < a[j - 1]; --j) {
+                    obs.compared(j, j - 1);
+                    std::swap(a[j], a[j - 1]);
+                    obs.swapped(j, j - 1);
+                }
+            }
+        }
+        if (!obs.proceed()) {
+            return;
+        }
+    }
+    withOffset(obs, shift, [&](auto& local) {
+        heapSortWith(a + shift, n - shift, local, Arity,
+                     [](T* h, Index size, Index i, T value, bool lifted, auto& inner) { siftDownHole<Arity>(h, size, i, std::move(value), lifted, inner); });
+    });
+}
+
+template <typename T, typename Policy>
+void heap4Sort(T* a, Index n, Policy& obs) {
+    dAryHeapSort<4>(a, n, obs);
+}
+
+template <typename T, typename Policy>
+void heap8Sort(T* a, Index n, Policy& obs) {
+    dAryHeapSort<8>(a, n, obs);
+}
+
+template <typename T, typename Policy>
+void bucketSort(T* a, Index n, Policy& obs) { // -> sorting algorithm, basically this implementation works like taking the array and dividing it into buckets.
+    if (n <= 0) {
+        return;
+    }
+    typedef ElementTraits<T> Traits;
+    double minVal = Traits::bucketKey(*std::min_element(a, a + n));
+    double maxVal = Traits::bucketKey(*std::max_element(a, a + n));
+    double range = maxVal - minVal;
+    double bucketSize = std::max(Traits::minBucketWidth, range / double(n)); // -> 10 for the bars, about one bucket per element for wide ranges
+    Index bucketCount = bucketSize > 0.0 ? Index(range / bucketSize) + 1 : 1;
+    auto bucketOf = [&](const T& value) {
+        Index bucketIndex = bucketSize > 0.0 ? Index((Traits::bucketKey(value) - minVal) / bucketSize) : 0;
+        return std::min(bucketIndex, bucketCount - 1);
+    };
+
+    // -> the buckets are slices of one scratch array: count, prefix sum, then scatter
+    ScratchBuffer<Index> bucketStart(bucketCount + 1);
+    std::fill(bucketStart.begin(), bucketStart.end(), 0);
+    for (Index i = 0; i < n; ++i) {
+        bucketStart[bucketOf(a[i]) + 1]++;
+    }
+    for (Index i = 0; i < bucketCount; ++i) {
+        bucketStart[i + 1] += bucketStart[i];
+    }
+    ScratchBuffer<T> buckets(n);
+    ScratchBuffer<Index> fill(bucketCount);
+    std::copy(bucketStart.begin(), bucketStart.end() - 1, fill.begin());
+    for (Index i = 0; i < n; ++i) {
+        buckets[fill[bucketOf(a[i])]++] = std::move(a[i]);
+    }
+
+    Index index = 0;
+    for (Index i = 0; i < bucketCount; ++i) {
+        std::sort(buckets.data() + bucketStart[i], buckets.data() + bucketStart[i + 1]);
+        for (Index j = bucketStart[i]; j < bucketStart[i + 1]; ++j) {
+            a[index] = std::move(buckets[j]);
+            obs.written(index);
+            index++;
+            if (!obs.proceed()) {
+                return;
+            }
+        }
+    }
+}
+
+template <typename T, typename Policy>
+void gnomeSort(T* a, Index n, Policy& obs) {
+    Index index = 0;
+    while (index < n) {
+        if (index > 0) {
+            obs.compared(index, index - 1);
+        }
+        if (index == 0 || a[index] >= a[index - 1]) {
+            index++;
+        } else {
+            std::swap(a[index], a[index - 1]);
+            obs.swapped(index, index - 1);
+            index--;
+        }
+        if (!obs.proceed()) {
+            return;
+        }
+    }
+}
+
+template <typename T, typename Policy>
+void mergeRuns(T* a, Index left, Index mid, Index right, Policy& obs) { // -> merges a[left..mid] with a[mid+1..right]
+    // -> only the left run is moved aside: the output never overtakes the right run, which is read in place
+    Index n1 = mid - left + 1;
+    Index n2 = right - mid;
+
+    ScratchBuffer<T> L(n1);
+    std::move(a + left, a + mid + 1, L.begin());
+    T* R = a + mid + 1;
+
+    Index i = 0, j = 0, k = left;
+    while (i < n1 && j < n2) {
+        obs.compared(left + i, mid + 1 + j);
+        if (L[i] <= R[j]) {
+            a[k] = std::move(L[i]);
+            i++;
+        } else {
+            a[k] = std::move(R[j]);
+            j++;
+        }
+        obs.written(k);
+        k++;
+        if (!obs.proceed()) {
+            return;
+        }
+    }
+
+    while (i < n1) {
+        a[k] = std::move(L[i]);
+        obs.written(k);
+        i++;
+        k++;
+        if (!obs.proceed()) {
+            return;
+        }
+    }
+    // -> whatever is left of the right run is already in place
+}
+
+template <typename T, typename Policy>
+void timSort(T* a, Index n, Policy& obs) {
+    const Index RUN = 32;
+    {
+        TraceSpan span("insertion runs");
+        for (Index i = 0; i < n; i += RUN) {
+            insertionSortRange(a, i, std::min(i + RUN - 1, n - 1), obs);
+            if (!obs.proceed()) {
+                return;
+            }
+        }
+    }
+
+    for (Index size = RUN; size < n; size = 2 * size) {
+        TraceSpan span("merge pass");
+        for (Index left = 0; left < n; left += 2 * size) {
+            Index mid = left + size - 1;
+            Index right = std::min(left + 2 * size - 1, n - 1);
+            if (mid >= right) { // -> a trailing run without a partner is already in place
+                continue;
+            }
+            mergeRuns(a, left, mid, right, obs);
+            if (!obs.proceed()) {
+                return;
+            }
+        }
+    }
+}
+
+// Multiway merge sort: insertion-sorted runs of MULTIWAY_RUN, then passes that merge up to
+// MULTIWAY_FAN_IN runs at once through a loser tree. Every pass moves each element through memory
+// twice (into the buffer and back), so the pass count log_k(n / run) instead of log2 is what saves traffic.
+const Index MULTIWAY_RUN = 8;
+const std::size_t MULTIWAY_FAN_IN = 8;
+
+template <typename T, typename Policy>
+void multiwayMergeSort(T* a, Index n, Policy& obs) {
+    {
+        TraceSpan span("insertion runs");
+        for (Index i = 0; i < n; i += MULTIWAY_RUN) {
+            insertionSortRange(a, i, std::min(i + MULTIWAY_RUN - 1, n - 1), obs);
+            if (!obs.proceed()) {
+                return;
+            }
+        }
+    }
+
+    ScratchBuffer<T> temp(n);
+    ScratchBuffer<Index> heads{Index(MULTIWAY_FAN_IN)}, ends{Index(MULTIWAY_FAN_IN)};
+    LoserTree tree;
+    auto less = [&](std::size_t x, std::size_t y) {
+        obs.compared(heads[x], heads[y]);
+        return a[heads[x]] < a[heads[y]];
+    };
+    for (Index width = MULTIWAY_RUN; width < n; width *= Index(MULTIWAY_FAN_IN)) {
+        TraceSpan span("merge pass");
+        for (Index left = 0; left < n; left += width * Index(MULTIWAY_FAN_IN)) {
+            Index right = std::min(n, left + width * Index(MULTIWAY_FAN_IN));
+            std::size_t k = std::size_t((right - left + width - 1) / width);
+            tree.reset(k);
+            for (std::size_t r = 0; r < k; ++r) {
+                heads[r] = left + Index(r) * width;
+                ends[r] = std::min(right, heads[r] + width);
+            }
+            tree.build(less);
+            obs.tournament(&tree, heads.data());
+
+            for (Index out = left; !tree.empty(); ++out) {
+                std::size_t r = tree.winner();
+                temp[out] = std::move(a[heads[r]]);
+                if (++heads[r] == ends[r]) {
+                    tree.exhaust(r);
+                    heads[r] = -1;
+                }
+                tree.replay(less);
+                obs.tournament(&tree, heads.data());
+                if (!obs.proceed()) {
+                    obs.tournament(nullptr, nullptr);
+                    return;
+                }
+            }
+            obs.tournament(nullptr, nullptr);
+
+            for (Index i = left; i < right; ++i) {
+                a[i] = std::move(temp[i]);
+                obs.written(i);
+                if (!obs.proceed()) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+template <typename T, typename Policy>
+void cycleSort(T* a, Index n, Policy& obs) {
+    for (Index cycleStart = 0; cycleStart < n - 1; ++cycleStart) {
+        T item = a[cycleStart];
+        Index pos = cycleStart;
+
+        for (Index i = cycleStart + 1; i < n; ++i) {
+            obs.compared(i, cycleStart);
+            if (a[i] < item) {
+                pos++;
+            }
+        }
+
+        if (pos == cycleStart) {
+            continue;
+        }
+
+        while (item == a[pos]) {
+            pos++;
+        }
+
+        if (pos != cycleStart) {
+            std::swap(item, a[pos]);
+            obs.written(pos);
         }
 
         while (pos != cycleStart) {
             pos = cycleStart;
 
-            for (int i = cycleStart + 1; i < NUM_BARS; ++i) {
-                if (array[i] < item) {
-                    pos++;
+            for (Index i = cycleStart + 1; i < n; ++i) {
+                obs.compared(i, cycleStart);
+                if (a[i] < item) {
+                    pos++;
+                }
+            }
+
+            while (item == a[pos]) {
+                pos++;
+            }
+
+            if (item != a[pos]) {
+                std::swap(item, a[pos]);
+                obs.written(pos);
+            }
+
+            if (!obs.proceed()) {
+                return;
+            }
+        }
+    }
+}
+
+//.....................................| Vectorized sort |.....................................//
+// SIMD Sort: quicksort partitions down to leaves of SIMD_LEAF_REGISTERS registers, each leaf is
+// sorted in registers with a bitonic network per register and then merged with a bitonic merge
+// network over register pairs. On x86-64 CPUs with AVX2 the native instantiation for 32- and 64-bit
+// integer keys runs the intrinsics kernels below (8 or 4 lanes); every other case, the counting and
+// visual policies included, runs the scalar emulation of the same partitions and networks.
+const Index SIMD_LEAF_REGISTERS = 16;
+
+template <typename T>
+constexpr int simdLanes() { // -> keys per 256-bit register
+    return std::is_integral<T>::value && sizeof(T) == 8 ? 4 : 8;
+}
+
+template <typename T, typename Policy>
+bool runNetwork(T* lanes, int count, Index at, bool inArray, const std::vector<NetworkStage>& stages, Policy& obs) {
+    // -> `at` is the array position of lane 0; register copies (inArray false) report no swaps
+    for (std::size_t s = 0; s < stages.size(); ++s) {
+        obs.network(&stages, int(s), lanes, count);
+        for (int i = 0; i < count; ++i) {
+            int p = stages[s].partner[i];
+            if (p <= i) {
+                continue;
+            }
+            obs.compared(at + i, at + p);
+            if (stages[s].takeMax[i] ? lanes[i] < lanes[p] : lanes[p] < lanes[i]) {
+                std::swap(lanes[i], lanes[p]);
+                if (inArray) {
+                    obs.swapped(at + i, at + p);
+                }
+            }
+        }
+        if (!obs.proceed()) {
+            return false;
+        }
+    }
+    obs.network(nullptr, 0, lanes, 0);
+    return true;
+}
+
+template <typename T, typename Policy>
+bool networkMerge(T* a, Index left, Index mid, Index right, T* out, Policy& obs) {
+    // -> merges a[left, mid) and a[mid, right), both a whole number of registers long, the way the
+    //    vector kernel does: the low register of each merge is final, the high one is merged again
+    //    with the next register from whichever run has the smaller head
+    const int L = simdLanes<T>();
+    ScratchBuffer<T> regs(2 * L);
+    std::copy(a + left, a + left + L, regs.begin());
+    std::copy(a + mid, a + mid + L, regs.begin() + L);
+    Index ia = left + L, ib = mid + L, o = 0;
+    while (true) {
+        if (!runNetwork(regs.data(), 2 * L, left + o, false, bitonicMergeNetwork(L), obs)) {
+            return false;
+        }
+        std::move(regs.begin(), regs.begin() + L, out + o);
+        o += L;
+        if (ia == mid && ib == right) {
+            std::move(regs.begin() + L, regs.end(), out + o);
+            break;
+        }
+        bool fromLeft = ib == right;
+        if (ia < mid && ib < right) {
+            obs.compared(ia, ib);
+            fromLeft = !(a[ib] < a[ia]);
+        }
+        Index& next = fromLeft ? ia : ib;
+        std::move(a + next, a + next + L, regs.begin());
+        next += L;
+    }
+    for (Index i = left; i < right; ++i) {
+        a[i] = std::move(out[i - left]);
+        obs.written(i);
+    }
+    return obs.proceed();
+}
+
+template <typename T, typename Policy>
+void networkLeaf(T* a, Index low, Index high, Policy& obs) { // -> sorts a[low, high), at most SIMD_LEAF_REGISTERS registers
+    TraceSpan span("network leaf");
+    const int L = simdLanes<T>();
+    Index full = low + (high - low) / L * L;
+    for (Index block = low; block < full; block += L) {
+        if (!runNetwork(a + block, L, block, true, bitonicSortNetwork(L), obs)) {
+            return;
+        }
+    }
+    // -> the vector kernel pads the leaf with maximal keys, a generic T has none, so the short tail
+    //    is insertion sorted and merged by the scalar mergeRuns instead
+    if (full < high) {
+        insertionSortRange(a, full, high - 1, obs);
+    }
+    ScratchBuffer<T> out(high - low);
+    for (Index width = L; width < high - low; width *= 2) {
+        for (Index left = low; left + width < high; left += 2 * width) {
+            Index mid = left + width, right = std::min(high, left + 2 * width);
+            bool ok = (right - mid) % L == 0 ? networkMerge(a, left, mid, right, out.data(), obs)
+                                             : (mergeRuns(a, left, mid - 1, right - 1, obs), obs.proceed());
+            if (!ok) {
+                return;
+            }
+        }
+    }
+}
+
+template <typename T, typename Policy>
+Index networkPartition(T* a, Index low, Index high, Index pivotAt, bool strict, Policy& obs) {
+    // -> [low, result) gets the keys <= pivot (< pivot when strict), [result, high) the rest
+    TraceSpan span("partition");
+    T pivot = a[pivotAt];
+    Index store = low;
+    for (Index i = low; i < high; ++i) {
+        obs.compared(i, pivotAt);
+        if (strict ? a[i] < pivot : !(pivot < a[i])) {
+            if (i != store) {
+                std::swap(a[i], a[store]);
+                obs.swapped(i, store);
+            }
+            store++;
+        }
+        if (!obs.proceed()) {
+            return -1;
+        }
+    }
+    return store;
+}
+
+template <typename T>
+Index medianOfThree(const T* a, Index x, Index y, Index z) {
+    if (a[y] < a[x]) {
+        std::swap(x, y);
+    }
+    if (a[z] < a[y]) {
+        y = a[z] < a[x] ? x : z;
+    }
+    return y;
+}
+
+template <typename T>
+Index choosePivot(const T* a, Index low, Index high) { // -> median of three, or Tukey's ninther on large ranges
+    Index n = high - low, mid = low + n / 2;
+    if (n < 1024) {
+        return medianOfThree(a, low, mid, high - 1);
+    }
+    Index step = n / 8;
+    return medianOfThree(a, medianOfThree(a, low, low + step, low + 2 * step), medianOfThree(a, mid - step, mid, mid + step),
+                         medianOfThree(a, high - 1 - 2 * step, high - 1 - step, high - 1));
+}
+
+template <typename T, typename Policy>
+void networkSortRange(T* a, Index low, Index high, int depth, Policy& obs) {
+    while (high - low > SIMD_LEAF_REGISTERS * simdLanes<T>()) {
+        if (depth-- == 0) { // -> too many bad pivots, finish this range with a worst-case n log n sort
+            withOffset(obs, low, [&](auto& local) { heapSort(a + low, high - low, local); });
+            return;
+        }
+        Index pivotAt = choosePivot(a, low, high);
+        T pivot = a[pivotAt];
+        Index mid = networkPartition(a, low, high, pivotAt, false, obs);
+        if (mid < 0) {
+            return;
+        }
+        if (mid == high) { // -> the pivot was the maximum, split its duplicates off to the right instead
+            Index at = std::find(a + low, a + high, pivot) - a;
+            mid = networkPartition(a, low, high, at, true, obs);
+            if (mid <= low) {
+                return; // -> every key equals the pivot (or the run was cancelled)
+            }
+            high = mid;
+            continue;
+        }
+        if (mid - low < high - mid) {
+            networkSortRange(a, low, mid, depth, obs);
+            low = mid;
+        } else {
+            networkSortRange(a, mid, high, depth, obs);
+            high = mid;
+        }
+    }
+    networkLeaf(a, low, high, obs);
+}
+
+int introDepth(Index n) {
+    int depth = 0;
+    for (; n > 1; n >>= 1) {
+        depth += 2;
+    }
+    return depth;
+}
+
+#if ALGORI_X86
+bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#else
+bool cpuHasAvx2() { return false; }
+#endif
+
+bool allowAvx2 = true; // -> cleared by --no-simd to time the scalar fallback
+
+bool useAvx2() {
+    static const bool supported = cpuHasAvx2();
+    return supported && allowAvx2;
+}
+
+#if ALGORI_X86
+// Per-key-type primitives. Keys of both widths live in __m256i, 64-bit lanes use pairs of 32-bit
+// permute indices so one permutevar8x32 serves both; unsigned compares flip the sign bit first.
+template <typename Key> struct Avx2Ops;
+
+template <>
+struct Avx2Ops<std::int32_t> {
+    static const int lanes = 8;
+    ALGORI_AVX2 static __m256i min(__m256i a, __m256i b) { return _mm256_min_epi32(a, b); }
+    ALGORI_AVX2 static __m256i max(__m256i a, __m256i b) { return _mm256_max_epi32(a, b); }
+    ALGORI_AVX2 static __m256i greater(__m256i a, __m256i b) { return _mm256_cmpgt_epi32(a, b); }
+    ALGORI_AVX2 static int mask(__m256i m) { return _mm256_movemask_ps(_mm256_castsi256_ps(m)); }
+};
+
+template <>
+struct Avx2Ops<std::uint32_t> {
+    static const int lanes = 8;
+    ALGORI_AVX2 static __m256i min(__m256i a, __m256i b) { return _mm256_min_epu32(a, b); }
+    ALGORI_AVX2 static __m256i max(__m256i a, __m256i b) { return _mm256_max_epu32(a, b); }
+    ALGORI_AVX2 static __m256i greater(__m256i a, __m256i b) {
+        __m256i sign = _mm256_set1_epi32(INT32_MIN);
+        return _mm256_cmpgt_epi32(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+    }
+    ALGORI_AVX2 static int mask(__m256i m) { return _mm256_movemask_ps(_mm256_castsi256_ps(m)); }
+};
+
+template <>
+struct Avx2Ops<std::int64_t> {
+    static const int lanes = 4;
+    ALGORI_AVX2 static __m256i greater(__m256i a, __m256i b) { return _mm256_cmpgt_epi64(a, b); }
+    ALGORI_AVX2 static __m256i min(__m256i a, __m256i b) { return _mm256_blendv_epi8(a, b, greater(a, b)); }
+    ALGORI_AVX2 static __m256i max(__m256i a, __m256i b) { return _mm256_blendv_epi8(b, a, greater(a, b)); }
+    ALGORI_AVX2 static int mask(__m256i m) { return _mm256_movemask_pd(_mm256_castsi256_pd(m)); }
+};
+
+template <>
+struct Avx2Ops<std::uint64_t> {
+    static const int lanes = 4;
+    ALGORI_AVX2 static __m256i greater(__m256i a, __m256i b) {
+        __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+        return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+    }
+    ALGORI_AVX2 static __m256i min(__m256i a, __m256i b) { return _mm256_blendv_epi8(a, b, greater(a, b)); }
+    ALGORI_AVX2 static __m256i max(__m256i a, __m256i b) { return _mm256_blendv_epi8(b, a, greater(a, b)); }
+    ALGORI_AVX2 static int mask(__m256i m) { return _mm256_movemask_pd(_mm256_castsi256_pd(m)); }
+};
+
+// The network stages and the partition compaction as 32-bit index/mask rows, built once per lane count.
+struct Avx2Tables {
+    struct Row {
+        alignas(32) std::int32_t v[8];
+    };
+    std::vector<Row> sortPerm, sortMax; // -> one register through bitonicSortNetwork
+    std::vector<Row> cleanPerm, cleanMax; // -> one bitonic register through the tail of bitonicMergeNetwork
+    Row reverse;
+    std::vector<Row> compact; // -> per lane mask: lanes that stay left first, then the ones going right
+    std::vector<int> goingRight; // -> per lane mask: how many lanes go right
+
+    explicit Avx2Tables(int lanes) {
+        int width = 8 / lanes; // -> 32-bit slots per lane
+        auto row = [&](const std::vector<int>& partner, const std::vector<char>& takeMax, Row& perm, Row& max) {
+            for (int i = 0; i < lanes; ++i) {
+                for (int w = 0; w < width; ++w) {
+                    perm.v[i * width + w] = partner[i] * width + w;
+                    max.v[i * width + w] = takeMax[i] ? -1 : 0;
+                }
+            }
+        };
+        for (const NetworkStage& stage : bitonicSortNetwork(lanes)) {
+            sortPerm.emplace_back();
+            sortMax.emplace_back();
+            row(stage.partner, stage.takeMax, sortPerm.back(), sortMax.back());
+        }
+        const std::vector<NetworkStage>& merge = bitonicMergeNetwork(lanes);
+        for (std::size_t s = 1; s < merge.size(); ++s) {
+            cleanPerm.emplace_back();
+            cleanMax.emplace_back();
+            row(merge[s].partner, merge[s].takeMax, cleanPerm.back(), cleanMax.back());
+        }
+        std::vector<int> reversed;
+        for (int i = 0; i < lanes; ++i) {
+            reversed.push_back(lanes - 1 - i);
+        }
+        Row unused;
+        row(reversed, std::vector<char>(lanes, 0), reverse, unused);
+        for (int m = 0; m < (1 << lanes); ++m) {
+            std::vector<int> order;
+            for (int side = 0; side < 2; ++side) {
+                for (int i = 0; i < lanes; ++i) {
+                    if (((m >> i) & 1) == side) {
+                        order.push_back(i);
+                    }
+                }
+            }
+            compact.emplace_back();
+            row(order, std::vector<char>(lanes, 0), compact.back(), unused);
+            int right = 0;
+            for (int i = 0; i < lanes; ++i) {
+                right += (m >> i) & 1;
+            }
+            goingRight.push_back(right);
+        }
+    }
+
+    static const Avx2Tables& get(int lanes) {
+        static const Avx2Tables four(4), eight(8);
+        return lanes == 4 ? four : eight;
+    }
+};
+
+template <typename Key>
+struct Avx2Sort {
+    typedef Avx2Ops<Key> Ops;
+    static const int L = Ops::lanes;
+    static const Index LEAF = SIMD_LEAF_REGISTERS * L;
+
+    ALGORI_AVX2 static __m256i load(const Key* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    ALGORI_AVX2 static void store(Key* p, __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    ALGORI_AVX2 static __m256i row(const Avx2Tables::Row& r) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(r.v)); }
+
+    ALGORI_AVX2 static __m256i stage(__m256i v, const Avx2Tables::Row& perm, const Avx2Tables::Row& max) {
+        __m256i w = _mm256_permutevar8x32_epi32(v, row(perm));
+        return _mm256_blendv_epi8(Ops::min(v, w), Ops::max(v, w), row(max));
+    }
+
+    ALGORI_AVX2 static __m256i sortRegister(__m256i v, const Avx2Tables& t) {
+        for (std::size_t s = 0; s < t.sortPerm.size(); ++s) {
+            v = stage(v, t.sortPerm[s], t.sortMax[s]);
+        }
+        return v;
+    }
+
+    ALGORI_AVX2 static void mergeRegisters(__m256i& lo, __m256i& hi, const Avx2Tables& t) { // -> both sorted in, both sorted out
+        __m256i reversed = _mm256_permutevar8x32_epi32(hi, row(t.reverse));
+        __m256i l = Ops::min(lo, reversed), h = Ops::max(lo, reversed);
+        for (std::size_t s = 0; s < t.cleanPerm.size(); ++s) {
+            l = stage(l, t.cleanPerm[s], t.cleanMax[s]);
+            h = stage(h, t.cleanPerm[s], t.cleanMax[s]);
+        }
+        lo = l;
+        hi = h;
+    }
+
+    ALGORI_AVX2 static void mergeRuns(const Key* x, Index nx, const Key* y, Index ny, Key* out, const Avx2Tables& t) {
+        __m256i lo = load(x), hi = load(y);
+        Index ix = L, iy = L;
+        while (true) {
+            mergeRegisters(lo, hi, t);
+            store(out, lo);
+            out += L;
+            if (ix == nx && iy == ny) {
+                store(out, hi);
+                return;
+            }
+            if (iy == ny || (ix < nx && x[ix] <= y[iy])) {
+                lo = load(x + ix);
+                ix += L;
+            } else {
+                lo = load(y + iy);
+                iy += L;
+            }
+        }
+    }
+
+    ALGORI_AVX2 static void leaf(Key* a, Index n) {
+        if (n < 2) {
+            return;
+        }
+        const Avx2Tables& t = Avx2Tables::get(L);
+        alignas(32) Key buffer[2][LEAF];
+        Index padded = L;
+        while (padded < n) {
+            padded *= 2;
+        }
+        std::copy(a, a + n, buffer[0]);
+        std::fill(buffer[0] + n, buffer[0] + padded, std::numeric_limits<Key>::max());
+        for (Index i = 0; i < padded; i += L) {
+            store(buffer[0] + i, sortRegister(load(buffer[0] + i), t));
+        }
+        int from = 0;
+        for (Index width = L; width < padded; width *= 2, from ^= 1) {
+            for (Index left = 0; left < padded; left += 2 * width) {
+                mergeRuns(buffer[from] + left, width, buffer[from] + left + width, width, buffer[from ^ 1] + left, t);
+            }
+        }
+        std::copy(buffer[from], buffer[from] + n, a);
+    }
+
+    // In-place vector partition: a register is read from whichever end has less room already freed
+    // for writing, its lanes are compacted with one permute and stored at both write fronts, the left
+    // front advances past the keys that stay left and the right front past the ones that go right.
+    // The first and last registers are held back so both fronts always have a register of room.
+    template <bool Strict>
+    ALGORI_AVX2 static Index partition(Key* a, Index n, Key pivot) {
+        const Avx2Tables& t = Avx2Tables::get(L);
+        __m256i p = sizeof(Key) == 4 ? _mm256_set1_epi32(std::int32_t(pivot)) : _mm256_set1_epi64x(std::int64_t(pivot));
+        __m256i first = load(a), last = load(a + n - L);
+        Index readLeft = L, readRight = n - L, writeLeft = 0, writeRight = n;
+        while (readRight - readLeft >= L) {
+            __m256i v;
+            if (readLeft - writeLeft <= writeRight - readRight) {
+                v = load(a + readLeft);
+                readLeft += L;
+            } else {
+                readRight -= L;
+                v = load(a + readRight);
+            }
+            int right = Strict ? ~Ops::mask(Ops::greater(p, v)) & ((1 << L) - 1) : Ops::mask(Ops::greater(v, p));
+            int count = t.goingRight[right];
+            __m256i packed = _mm256_permutevar8x32_epi32(v, row(t.compact[right]));
+            store(a + writeLeft, packed);
+            store(a + writeRight - L, packed);
+            writeLeft += L - count;
+            writeRight -= count;
+        }
+        // -> what is left (the unread middle plus the two held registers) fills [writeLeft, writeRight) exactly
+        Key rest[3 * L];
+        Index r = 0;
+        for (Index i = readLeft; i < readRight; ++i) {
+            rest[r++] = a[i];
+        }
+        store(rest + r, first);
+        store(rest + r + L, last);
+        for (Index i = 0; i < r + 2 * L; ++i) {
+            bool left = Strict ? rest[i] < pivot : !(pivot < rest[i]);
+            if (left) {
+                a[writeLeft++] = rest[i];
+            } else {
+                a[--writeRight] = rest[i];
+            }
+        }
+        return writeLeft;
+    }
+
+    ALGORI_AVX2 static void sortRange(Key* a, Index n, int depth) { // -> same control flow as networkSortRange
+        while (n > LEAF) {
+            if (depth-- == 0) {
+                NativePolicy obs;
+                heapSort(a, n, obs);
+                return;
+            }
+            Key pivot = a[choosePivot(a, 0, n)];
+            Index mid = partition<false>(a, n, pivot);
+            if (mid == n) {
+                mid = partition<true>(a, n, pivot);
+                if (mid == 0) {
+                    return;
+                }
+                n = mid;
+                continue;
+            }
+            if (mid < n - mid) {
+                sortRange(a, mid, depth);
+                a += mid;
+                n -= mid;
+            } else {
+                sortRange(a + mid, n - mid, depth);
+                n = mid;
+            }
+        }
+        leaf(a, n);
+    }
+};
+
+template <typename T>
+struct IsAvx2Key : std::integral_constant<bool, std::is_same<T, std::int32_t>::value || std::is_same<T, std::uint32_t>::value ||
+                                                    std::is_same<T, std::int64_t>::value || std::is_same<T, std::uint64_t>::value> {};
+#endif
+
+template <typename T, typename Policy>
+void simdSort(T* a, Index n, Policy& obs) {
+#if ALGORI_X86
+    if constexpr (std::is_same<Policy, NativePolicy>::value && IsAvx2Key<T>::value) {
+        if (useAvx2()) {
+            Avx2Sort<T>::sortRange(a, n, introDepth(n));
+            return;
+        }
+    }
+#endif
+    networkSortRange(a, 0, n, introDepth(n), obs);
+}
+
+//.....................................| Parallel sample sort |.....................................//
+// Parallel Sample Sort, in four stages:
+//   1. splitters: SAMPLE_OVERSAMPLING * k keys are sampled and sorted, every SAMPLE_OVERSAMPLING-th becomes one of k - 1 splitters
+//   2. classification: each worker labels the keys of its block with a bucket through the splitter tree
+//   3. scatter: a prefix sum over (bucket, block) counts gives every block its own slot range inside
+//      every bucket, so the workers move their keys to a buffer without any synchronisation
+//   4. local sorts: buckets are dealt to the workers in contiguous regions of about n / workers keys,
+//      each worker copies its region back and sorts its buckets with SIMD Sort
+const Index SAMPLE_OVERSAMPLING = 16;
+const unsigned SAMPLE_VISUAL_WORKERS = 4; // -> the window always shows several owners, even on one core
+
+unsigned sortThreads = 0; // -> --threads, 0 means one worker per hardware thread
+
+unsigned sortWorkers() {
+    return sortThreads ? sortThreads : workerCount();
+}
+
+// The k - 1 splitters in implicit (Eytzinger) order: node j has children 2j and 2j + 1, so a key
+// is classified in log2 k steps of j = 2j + (tree[j] < key), without a branch to mispredict. Keys
+// equal to the upper splitter of their bucket get an equality bucket of their own, which needs no
+// sorting and keeps duplicate-heavy inputs from piling into one bucket.
+template <typename T>
+class SplitterTree {
+public:
+    explicit SplitterTree(const std::vector<T>& splitters)
+        : sorted(splitters), tree(splitters.size() + 1), k(Index(splitters.size()) + 1) {
+        Index next = 0;
+        fill(1, next);
+        while ((Index(1) << levels) < k) {
+            levels++;
+        }
+    }
+
+    Index buckets() const { return 2 * k; } // -> bucket 2b holds keys in (sorted[b-1], sorted[b]), 2b + 1 keys equal to sorted[b]
+    static bool needsSort(Index bucket) { return bucket % 2 == 0; }
+
+    template <typename Policy>
+    void classify(const T* a, Index begin, Index end, std::uint16_t* out, Policy& obs) const {
+        Index i = begin;
+        for (; i + 4 <= end; i += 4) { // -> four independent descents keep the pipeline busy
+            Index j0 = 1, j1 = 1, j2 = 1, j3 = 1;
+            for (int level = 0; level < levels; ++level) {
+                j0 = 2 * j0 + (tree[j0] < a[i]);
+                j1 = 2 * j1 + (tree[j1] < a[i + 1]);
+                j2 = 2 * j2 + (tree[j2] < a[i + 2]);
+                j3 = 2 * j3 + (tree[j3] < a[i + 3]);
+            }
+            out[i] = bucketOf(a[i], j0);
+            out[i + 1] = bucketOf(a[i + 1], j1);
+            out[i + 2] = bucketOf(a[i + 2], j2);
+            out[i + 3] = bucketOf(a[i + 3], j3);
+        }
+        for (; i < end; ++i) {
+            Index j = 1;
+            for (int level = 0; level < levels; ++level) {
+                j = 2 * j + (tree[j] < a[i]);
+            }
+            out[i] = bucketOf(a[i], j);
+        }
+        for (i = begin; i < end; ++i) { // -> the splitters are held keys, so compared() reports the key's own position
+            for (int level = 0; level <= levels; ++level) {
+                obs.compared(i, i);
+            }
+        }
+    }
+
+private:
+    void fill(Index node, Index& next) { // -> in-order walk of the implicit tree hands out the sorted splitters
+        if (node >= k) {
+            return;
+        }
+        fill(2 * node, next);
+        tree[node] = sorted[next++];
+        fill(2 * node + 1, next);
+    }
+    std::uint16_t bucketOf(const T& key, Index leaf) const {
+        Index b = leaf - k;
+        return std::uint16_t(2 * b + (b < k - 1 && !(key < sorted[b])));
+    }
+
+    std::vector<T> sorted;
+    std::vector<T> tree;
+    Index k;
+    int levels = 0;
+};
+
+template <typename T, typename Policy>
+void sampleSort(T* a, Index n, Policy& obs) {
+    unsigned workers = Policy::visual ? std::max(SAMPLE_VISUAL_WORKERS, sortWorkers()) : sortWorkers();
+    unsigned threads = Policy::concurrent ? workers : 1; // -> a non-concurrent policy still sees every worker's share, one after the other
+    Index k = 16;
+    while (k < 4 * Index(workers) && k < 256) {
+        k *= 2;
+    }
+    Index oversampling = std::min(SAMPLE_OVERSAMPLING, n / (2 * k));
+    if (oversampling < 1) {
+        simdSort(a, n, obs);
+        return;
+    }
+
+    std::vector<T> splitters;
+    {
+        TraceSpan span("splitters");
+        SplitMix64 rng = SplitMix64::stream(std::uint64_t(n), 0);
+        std::vector<T> sample;
+        for (Index s = 0; s < oversampling * k; ++s) {
+            sample.push_back(a[Index(rng.below(std::uint64_t(n)))]);
+        }
+        std::sort(sample.begin(), sample.end());
+        for (Index b = 1; b < k; ++b) {
+            splitters.push_back(sample[b * oversampling]);
+        }
+    }
+    SplitterTree<T> tree(splitters);
+    Index buckets = tree.buckets();
+
+    Index blockSize = (n + workers - 1) / workers;
+    ScratchBuffer<std::uint16_t> oracle(n);
+    std::vector<Index> counts(std::size_t(workers * buckets), 0);
+    parallelFor(workers, [&](Index w) {
+        TraceSpan span("classify");
+        Index begin = std::min(n, w * blockSize), end = std::min(n, begin + blockSize);
+        tree.classify(a, begin, end, oracle.data(), obs);
+        for (Index i = begin; i < end; ++i) {
+            counts[w * buckets + oracle[i]]++;
+        }
+    }, threads);
+    if (!obs.proceed()) {
+        return;
+    }
+
+    std::vector<Index> bucketStart(buckets + 1), offsets(counts.size());
+    Index sum = 0;
+    for (Index b = 0; b < buckets; ++b) {
+        bucketStart[b] = sum;
+        for (Index w = 0; w < Index(workers); ++w) {
+            offsets[w * buckets + b] = sum;
+            sum += counts[w * buckets + b];
+        }
+    }
+    bucketStart[buckets] = n;
+    std::vector<Index> firstBucket(workers + 1, buckets); // -> worker w owns buckets [firstBucket[w], firstBucket[w + 1])
+    firstBucket[0] = 0;
+    for (Index w = 1, b = 0; w < Index(workers); ++w) {
+        while (b < buckets && bucketStart[b] < w * n / Index(workers)) {
+            b++;
+        }
+        firstBucket[w] = b;
+    }
+
+    ScratchBuffer<T> scattered(n);
+    parallelFor(workers, [&](Index w) {
+        TraceSpan span("scatter");
+        Index begin = std::min(n, w * blockSize), end = std::min(n, begin + blockSize);
+        Index* offset = &offsets[w * buckets];
+        for (Index i = begin; i < end; ++i) {
+            scattered[offset[oracle[i]]++] = std::move(a[i]);
+        }
+    }, threads);
+
+    parallelFor(workers, [&](Index w) {
+        TraceSpan span("local sorts");
+        Index begin = bucketStart[firstBucket[w]], end = bucketStart[firstBucket[w + 1]];
+        obs.region(begin, end, int(w));
+        for (Index i = begin; i < end; ++i) {
+            a[i] = std::move(scattered[i]);
+            obs.written(i);
+            if (!obs.proceed()) {
+                return;
+            }
+        }
+        for (Index b = firstBucket[w]; b < firstBucket[w + 1]; ++b) {
+            Index from = bucketStart[b], size = bucketStart[b + 1] - from;
+            if (SplitterTree<T>::needsSort(b) && size > 1 && obs.proceed()) {
+                withOffset(obs, from, [&](auto& local) { simdSort(a + from, size, local); });
+            }
+        }
+    }, threads);
+    obs.region(0, n, -1);
+}
+
+//.....................................| Block merge sort |.....................................//
+// In-place stable merge sort: block merging with an internal buffer, after GrailSort (Astrelin) and
+// the Huang-Langston/Kim-Kutzner line of work. No scratch memory is used at all:
+//   1. About 2 sqrt(n) distinct keys are collected at the front of the array. The first ones tag the
+//      blocks of a merge with their origin, the last `block` of them are the merge buffer. Both are
+//      distinct values, so the order they get shuffled into can be restored by sorting them at the end.
+//   2. Runs up to one block long are built with insertion sort and merges through the buffer. A merge
+//      swaps its output into the buffer, so the buffer travels right through the data and is swapped
+//      back in front after every pass.
+//   3. Longer runs are merged pairwise by cutting both into blocks, ordering the blocks by their first
+//      key (a selection sort that swaps the tags along), and merging each block with the unmerged tail
+//      of the previous one through the buffer. The tags say which run a block came from, so ties keep
+//      the left run first and the sort stays stable.
+//   4. Keys and buffer are sorted and merged back into the data by rotations.
+// With fewer than 2 sqrt(n) distinct values there is no buffer to be had: the keys stay where they are
+// and every merge is done by rotations instead, O(n log^2 n) but still in place and stable.
+template <typename T, typename Policy>
+void swapRanges(T* a, Index x, Index y, Index count, Policy& obs) { // -> pairwise, front to back: with y > x the ranges may overlap, which cascades a[y, y + count) down to x
+    for (Index i = 0; i < count; ++i) {
+        std::swap(a[x + i], a[y + i]);
+        obs.swapped(x + i, y + i);
+    }
+}
+
+template <typename T, typename Policy>
+void rotateRange(T* a, Index first, Index middle, Index last, Policy& obs) { // -> exchanges the blocks [first, middle) and [middle, last)
+    if (first == middle || middle == last) {
+        return;
+    }
+    std::reverse(a + first, a + middle);
+    std::reverse(a + middle, a + last);
+    std::reverse(a + first, a + last);
+    obs.rotated(first, middle, last);
+}
+
+template <typename T, typename Policy>
+Index lowerBoundOf(const T* a, Index first, Index last, Index key, Policy& obs) { // -> first position in [first, last) not less than a[key]
+    while (first < last) {
+        Index mid = first + (last - first) / 2;
+        obs.compared(mid, key);
+        if (a[mid] < a[key]) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
+template <typename T, typename Policy>
+Index upperBoundOf(const T* a, Index first, Index last, Index key, Policy& obs) { // -> first position in [first, last) greater than a[key]
+    while (first < last) {
+        Index mid = first + (last - first) / 2;
+        obs.compared(mid, key);
+        if (a[key] < a[mid]) {
+            last = mid;
+        } else {
+            first = mid + 1;
+        }
+    }
+    return first;
+}
+
+template <typename T, typename Policy>
+void mergeByRotation(T* a, Index first, Index middle, Index last, Policy& obs) { // -> stable merge of [first, middle) and [middle, last) without a buffer
+    Index len1 = middle - first, len2 = last - middle;
+    if (len1 == 0 || len2 == 0 || !obs.proceed()) {
+        return;
+    }
+    if (len1 + len2 == 2) {
+        obs.compared(middle, first);
+        if (a[middle] < a[first]) {
+            std::swap(a[first], a[middle]);
+            obs.swapped(first, middle);
+        }
+        return;
+    }
+    Index cut1, cut2;
+    if (len1 > len2) {
+        cut1 = first + len1 / 2;
+        cut2 = lowerBoundOf(a, middle, last, cut1, obs);
+    } else {
+        cut2 = middle + len2 / 2;
+        cut1 = upperBoundOf(a, first, middle, cut2, obs);
+    }
+    rotateRange(a, cut1, middle, cut2, obs);
+    Index newMiddle = cut1 + (cut2 - middle);
+    mergeByRotation(a, first, cut1, newMiddle, obs);
+    mergeByRotation(a, newMiddle, cut2, last, obs);
+}
+
+template <typename T, typename Policy>
+Index collectKeys(T* a, Index n, Index wanted, Policy& obs) { // -> moves up to `wanted` distinct keys, sorted, to the front
+    Index h0 = 0, h = 1; // -> the keys found so far are a[h0, h0 + h), rolled along behind the scan
+    for (Index u = 1; u < n && h < wanted && obs.proceed(); ++u) {
+        Index r = lowerBoundOf(a, h0, h0 + h, u, obs) - h0;
+        if (r == h || a[u] < a[h0 + r]) { // -> a value not seen yet, the first occurrence becomes a key
+            rotateRange(a, h0, h0 + h, u, obs);
+            h0 = u - h;
+            rotateRange(a, h0 + r, h0 + h, u + 1, obs);
+            h++;
+        }
+    }
+    rotateRange(a, Index(0), h0, h0 + h, obs);
+    return h;
+}
+
+template <typename T, typename Policy>
+void mergeIntoBuffer(T* a, Index first, Index len1, Index len2, Index block, Policy& obs) {
+    // -> merges [first, first + len1) with the next len2 into the block-long buffer right before them,
+    //    which ends up after the merged run; needs len2 <= block
+    Index out = first - block, p0 = first, p1 = first + len1, end1 = first + len1, end2 = p1 + len2;
+    while (p1 < end2) {
+        bool takeRight = p0 == end1;
+        if (!takeRight) {
+            obs.compared(p0, p1);
+            takeRight = a[p1] < a[p0];
+        }
+        Index from = takeRight ? p1++ : p0++;
+        std::swap(a[out], a[from]);
+        obs.swapped(out, from);
+        out++;
+    }
+    if (out != p0) {
+        swapRanges(a, out, p0, end1 - p0, obs);
+    }
+}
+
+template <typename T, typename Policy>
+void mergeWithTail(T* a, Index first, Index& restLength, bool& restFromRight, Index block, Policy& obs) {
+    // -> merges the unmerged rest [first, first + restLength) with the block after it into the buffer
+    //    before them until one side runs out. What is left over becomes the new rest, moved to the end
+    //    of the region, with the buffer again right before it.
+    Index out = first - block, p1 = first, p2 = first + restLength, end1 = p2, end2 = p2 + block;
+    while (p1 < end1 && p2 < end2) {
+        obs.compared(p1, p2);
+        bool takeRest = restFromRight ? a[p1] < a[p2] : !(a[p2] < a[p1]); // -> on ties the left run's key goes first
+        Index from = takeRest ? p1++ : p2++;
+        std::swap(a[out], a[from]);
+        obs.swapped(out, from);
+        out++;
+    }
+    if (p1 < end1) {
+        restLength = end1 - p1;
+        while (p1 < end1) {
+            --end1;
+            --end2;
+            std::swap(a[end1], a[end2]);
+            obs.swapped(end1, end2);
+        }
+    } else {
+        restLength = end2 - p2;
+        restFromRight = !restFromRight;
+    }
+}
+
+template <typename T, typename Policy>
+void mergeBlocks(T* a, Index keys, Index midKey, Index first, Index blocks, Index block, Index tailBlocks, Index tail, Policy& obs) {
+    // -> local merges over blocks already ordered by first key; the last `tailBlocks` left-run blocks
+    //    and the partial block of `tail` keys after them are merged at the end
+    if (blocks == 0) {
+        mergeIntoBuffer(a, first, tailBlocks * block, tail, block, obs);
+        return;
+    }
+    auto fromRight = [&](Index b) { return !(a[keys + b] < a[midKey]); }; // -> tags of right-run blocks are >= the middle tag
+    Index restLength = block, at = block;
+    bool restFromRight = fromRight(0);
+    for (Index b = 1; b < blocks && obs.proceed(); ++b, at += block) {
+        Index rest = at - restLength;
+        obs.buffer(first + rest - block, first + rest);
+        if (fromRight(b) == restFromRight) { // -> same run as the rest: the rest is final, shift it over the buffer
+            swapRanges(a, first + rest - block, first + rest, restLength, obs);
+            restLength = block;
+        } else {
+            mergeWithTail(a, first + rest, restLength, restFromRight, block, obs);
+        }
+    }
+    Index rest = at - restLength;
+    if (tail > 0) {
+        if (restFromRight) {
+            swapRanges(a, first + rest - block, first + rest, restLength, obs);
+            rest = at;
+            restLength = block * tailBlocks;
+        } else {
+            restLength += block * tailBlocks;
+        }
+        mergeIntoBuffer(a, first + rest, restLength, tail, block, obs);
+    } else {
+        swapRanges(a, first + rest - block, first + rest, restLength, obs);
+    }
+}
+
+template <typename T, typename Policy>
+void combineRuns(T* a, Index keys, Index data, Index m, Index run, Index block, Policy& obs) {
+    // -> merges the sorted runs of length `run` of a[data, data + m) pairwise; the buffer is the block
+    //    before data, and is swapped back there at the end of the pass
+    Index pairs = m / (2 * run), leftover = m % (2 * run), covered = m;
+    if (leftover <= run) { // -> a lone last run has nothing to merge with
+        covered -= leftover;
+        leftover = 0;
+    }
+    for (Index p = 0; p <= pairs && obs.proceed(); ++p) {
+        if (p == pairs && leftover == 0) {
+            break;
+        }
+        Index first = data + p * 2 * run;
+        Index blocks = (p == pairs ? leftover : 2 * run) / block;
+        insertionSortRange(a, keys, keys + blocks + (p == pairs ? 1 : 0) - 1, obs); // -> tags back in order, one more for a partial pair
+        Index midKey = keys + run / block;
+        for (Index u = 1; u < blocks; ++u) { // -> selection sort of the blocks by first key, ties by tag
+            Index best = u - 1;
+            for (Index v = u; v < blocks; ++v) {
+                Index x = first + best * block, y = first + v * block;
+                obs.compared(y, x);
+                if (a[y] < a[x] || (!(a[x] < a[y]) && a[keys + v] < a[keys + best])) {
+                    best = v;
+                }
+            }
+            if (best != u - 1) {
+                swapRanges(a, first + (u - 1) * block, first + best * block, block, obs);
+                std::swap(a[keys + u - 1], a[keys + best]);
+                obs.swapped(keys + u - 1, keys + best);
+                if (midKey == keys + u - 1 || midKey == keys + best) {
+                    midKey = midKey == keys + u - 1 ? keys + best : keys + u - 1;
+                }
+            }
+        }
+        Index tail = p == pairs ? leftover % block : 0, tailBlocks = 0;
+        while (tail > 0 && tailBlocks < blocks) { // -> left-run blocks that start after the partial block belong behind it
+            Index x = first + (blocks - tailBlocks - 1) * block, y = first + blocks * block;
+            obs.compared(y, x);
+            if (!(a[y] < a[x])) {
+                break;
+            }
+            tailBlocks++;
+        }
+        mergeBlocks(a, keys, midKey, first, blocks - tailBlocks, block, tailBlocks, tail, obs);
+    }
+    for (Index q = covered - 1; q >= 0; --q) {
+        std::swap(a[data + q], a[data + q - block]);
+        obs.swapped(data + q, data + q - block);
+    }
+    obs.buffer(data - block, data);
+}
+
+template <typename T, typename Policy>
+void blockMergeSort(T* a, Index n, Policy& obs) {
+    const Index RUN = 16;
+    if (n <= RUN) {
+        insertionSortRange(a, 0, n - 1, obs);
+        return;
+    }
+    Index block = 1;
+    while (block * block < n) {
+        block *= 2;
+    }
+    Index tags = (n - 1) / block + 1;
+    Index found;
+    {
+        TraceSpan span("collect keys");
+        found = collectKeys(a, n, tags + block, obs);
+    }
+    if (found < tags + block) {
+        TraceSpan span("rotation merges");
+        for (Index i = 0; i < n; i += RUN) {
+            insertionSortRange(a, i, std::min(i + RUN, n) - 1, obs);
+        }
+        for (Index width = RUN; width < n && obs.proceed(); width *= 2) {
+            for (Index left = 0; left + width < n; left += 2 * width) {
+                mergeByRotation(a, left, left + width, std::min(left + 2 * width, n), obs);
+            }
+        }
+        return;
+    }
+
+    Index data = tags + block, m = n - data;
+    obs.buffer(tags, data);
+    {
+        TraceSpan span("build runs");
+        Index run = std::min(block, RUN);
+        for (Index i = 0; i < m; i += run) {
+            insertionSortRange(a, data + i, data + std::min(i + run, m) - 1, obs);
+        }
+        for (; run < block && obs.proceed(); run *= 2) {
+            Index p = 0;
+            for (; p + run < m; p += 2 * run) {
+                mergeIntoBuffer(a, data + p, run, std::min(run, m - p - run), block, obs);
+            }
+            if (p < m) {
+                swapRanges(a, data + p - block, data + p, m - p, obs);
+            }
+            for (Index q = m - 1; q >= 0; --q) {
+                std::swap(a[data + q], a[data + q - block]);
+                obs.swapped(data + q, data + q - block);
+            }
+        }
+    }
+    for (Index run = block; run < m && obs.proceed(); run *= 2) {
+        TraceSpan span("block merge pass");
+        combineRuns(a, Index(0), data, m, run, block, obs);
+    }
+    obs.buffer(0, 0);
+    if (obs.proceed()) {
+        TraceSpan span("merge keys");
+        insertionSortRange(a, 0, data - 1, obs);
+        mergeByRotation(a, 0, data, n, obs);
+    }
+}
+
+//.....................................| Search functions |.....................................//
+// Searches return the index of the value, or -1 when it is not present.
+template <typename T, typename Policy>
+Index linearSearch(const T* a, Index n, const T& value, Policy& obs) {
+    for (Index i = 0; i < n; ++i) {
+        obs.compared(i, i);
+        if (a[i] == value) {
+            obs.found(i);
+            return i;
+        }
+        obs.missed(i);
+        if (!obs.proceed()) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+template <typename T, typename Policy>
+Index binarySearch(const T* a, Index n, const T& value, Policy& obs) {
+    Index left = 0, right = n - 1;
+    while (left <= right) {
+        Index mid = left + (right - left) / 2;
+        obs.probed(mid);
+        obs.compared(mid, mid);
+        if (a[mid] == value) {
+            obs.found(mid);
+            return mid;
+        }
+        if (a[mid] < value) {
+            left = mid + 1;
+        } else {
+            right = mid - 1;
+        }
+        if (!obs.proceed()) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+template <typename T, typename Policy>
+Index ternarySearch(const T* a, Index n, const T& value, Policy& obs) {
+    Index left = 0, right = n - 1;
+    while (left <= right) {
+        Index mid1 = left + (right - left) / 3;
+        Index mid2 = right - (right - left) / 3;
+        obs.probed(mid1);
+        obs.probed(mid2);
+        obs.compared(mid1, mid2);
+        if (a[mid1] == value) {
+            obs.found(mid1);
+            return mid1;
+        }
+        if (a[mid2] == value) {
+            obs.found(mid2);
+            return mid2;
+        }
+        if (value < a[mid1]) {
+            right = mid1 - 1;
+        } else if (value > a[mid2]) {
+            left = mid2 + 1;
+        } else {
+            left = mid1 + 1;
+            right = mid2 - 1;
+        }
+        if (!obs.proceed()) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+//.....................................| Selection functions |.....................................//
+// Selection and top-k: select(a, n, k) moves the k smallest keys to a[0, k) and the k-th smallest
+// to a[k - 1]; the rest of the array keeps the other keys in no particular order, so, like a sort,
+// every algorithm permutes the array in place. The benchmark compares them with a full sort
+// followed by a slice of the first k.
+//   - Quickselect: median-of-three (ninther on large ranges) pivots and three-way partitions, so
+//     runs of equal keys end a step early instead of degrading it.
+//   - Introselect: Quickselect with a budget of 2 log2 n partitions; a range still open after that
+//     is finished with median-of-medians pivots (groups of five), which are linear in the worst case.
+//   - Floyd–Rivest: ranges above FLOYD_RIVEST_SAMPLE keys first select recursively inside a sample
+//     window around k, so the pivot lands next to the k-th key and one partition leaves little.
+//   - Heap top-k: a max-heap of the first k keys; each later key smaller than the root replaces it.
+//   - Stream top-k: one pass that keeps the positions of at most 2k candidates; a key enters only
+//     when it beats the current k-th candidate, a filter done on 8 (or 4) keys per AVX2 compare for
+//     32- and 64-bit integers. A full candidate list is cut back to k with nth_element.
+const Index FLOYD_RIVEST_SAMPLE = 600;
+const Index MEDIAN_GROUP = 5;
+
+template <typename T, typename Policy>
+bool selectPartition(T* a, Index low, Index high, Index pivotAt, Index& lt, Index& gt, Policy& obs) {
+    // -> [low, lt) < pivot, [lt, gt) == pivot, [gt, high) > pivot; false when the run was cancelled
+    T pivot = a[pivotAt];
+    lt = low;
+    gt = high;
+    for (Index i = low; i < gt;) {
+        obs.compared(i, pivotAt);
+        if (a[i] < pivot) {
+            if (i != lt) {
+                std::swap(a[i], a[lt]);
+                obs.swapped(i, lt);
+            }
+            lt++;
+            i++;
+        } else if (pivot < a[i]) {
+            gt--;
+            std::swap(a[i], a[gt]);
+            obs.swapped(i, gt);
+        } else {
+            i++;
+        }
+        if (!obs.proceed()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T, typename Policy>
+Index medianOfMediansPivot(T* a, Index low, Index high, Policy& obs);
+
+template <typename T, typename Policy>
+void medianOfMediansSelect(T* a, Index low, Index high, Index nth, Policy& obs) { // -> a[nth] in place within [low, high)
+    while (high - low > 1) {
+        Index lt = 0, gt = 0;
+        if (!selectPartition(a, low, high, medianOfMediansPivot(a, low, high, obs), lt, gt, obs)) {
+            return;
+        }
+        if (nth < lt) {
+            high = lt;
+        } else if (nth >= gt) {
+            low = gt;
+        } else {
+            return;
+        }
+    }
+}
+
+template <typename T, typename Policy>
+Index medianOfMediansPivot(T* a, Index low, Index high, Policy& obs) {
+    // -> the median of every group of five is swapped to the front, then the median of those is selected
+    if (high - low <= MEDIAN_GROUP) {
+        insertionSortRange(a, low, high - 1, obs);
+        return low + (high - low) / 2;
+    }
+    Index medians = low;
+    for (Index group = low; group < high; group += MEDIAN_GROUP) {
+        Index end = std::min(group + MEDIAN_GROUP, high);
+        insertionSortRange(a, group, end - 1, obs);
+        Index median = group + (end - group) / 2;
+        std::swap(a[medians], a[median]);
+        obs.swapped(medians, median);
+        medians++;
+    }
+    Index middle = low + (medians - low) / 2;
+    medianOfMediansSelect(a, low, medians, middle, obs);
+    return middle;
+}
+
+template <typename T, typename Policy>
+void quickSelectRange(T* a, Index low, Index high, Index nth, int budget, Policy& obs) { // -> budget < 0: no fallback
+    obs.region(low, high, 0); // -> the open range is tinted, the discarded sides go back to white
+    while (high - low > 1) {
+        if (budget-- == 0) { // -> too many bad pivots, the rest gets guaranteed linear pivots
+            medianOfMediansSelect(a, low, high, nth, obs);
+            return;
+        }
+        Index lt = 0, gt = 0;
+        if (!selectPartition(a, low, high, choosePivot(a, low, high), lt, gt, obs)) {
+            return;
+        }
+        if (nth < lt) {
+            obs.region(lt, high, -1);
+            high = lt;
+        } else if (nth >= gt) {
+            obs.region(low, gt, -1);
+            low = gt;
+        } else {
+            return;
+        }
+    }
+}
+
+template <typename T, typename Policy>
+void quickSelect(T* a, Index n, Index k, Policy& obs) {
+    quickSelectRange(a, 0, n, k - 1, -1, obs);
+}
+
+template <typename T, typename Policy>
+void introSelect(T* a, Index n, Index k, Policy& obs) {
+    quickSelectRange(a, 0, n, k - 1, introDepth(n), obs);
+}
+
+template <typename T, typename Policy>
+bool floydRivestRange(T* a, Index left, Index right, Index nth, Policy& obs) { // -> [left, right] inclusive, false when cancelled
+    while (right > left) {
+        if (right - left > FLOYD_RIVEST_SAMPLE) { // -> select inside a window around nth that holds it with high probability
+            double n = double(right - left + 1), i = double(nth - left + 1);
+            double z = std::log(n), s = 0.5 * std::exp(2 * z / 3);
+            double sd = 0.5 * std::sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1 : 1);
+            Index newLeft = std::max(left, Index(double(nth) - i * s / n + sd));
+            Index newRight = std::min(right, Index(double(nth) + (n - i) * s / n + sd));
+            if (!floydRivestRange(a, newLeft, newRight, nth, obs)) {
+                return false;
+            }
+        }
+        obs.region(left, right + 1, 0);
+        T pivot = a[nth];
+        Index i = left, j = right;
+        std::swap(a[left], a[nth]);
+        obs.swapped(left, nth);
+        obs.compared(right, left);
+        if (pivot < a[right]) {
+            std::swap(a[right], a[left]);
+            obs.swapped(right, left);
+        }
+        while (i < j) {
+            std::swap(a[i], a[j]);
+            obs.swapped(i, j);
+            i++;
+            j--;
+            for (obs.compared(i, nth); a[i] < pivot; obs.compared(i, nth)) {
+                i++;
+            }
+            for (obs.compared(j, nth); pivot < a[j]; obs.compared(j, nth)) {
+                j--;
+            }
+            if (!obs.proceed()) {
+                return false;
+            }
+        }
+        if (!(a[left] < pivot) && !(pivot < a[left])) {
+            std::swap(a[left], a[j]);
+            obs.swapped(left, j);
+        } else {
+            j++;
+            std::swap(a[j], a[right]);
+            obs.swapped(j, right);
+        }
+        if (j <= nth) {
+            obs.region(left, j + 1, -1);
+            left = j + 1;
+        }
+        if (nth <= j) {
+            obs.region(j, right + 1, -1);
+            right = j - 1;
+        }
+    }
+    return true;
+}
+
+template <typename T, typename Policy>
+void floydRivestSelect(T* a, Index n, Index k, Policy& obs) {
+    floydRivestRange(a, 0, n - 1, k - 1, obs);
+}
+
+template <typename T, typename Policy>
+void heapTopK(T* a, Index n, Index k, Policy& obs) {
+    obs.region(0, k, 0);
+    for (Index i = k / 2 - 1; i >= 0; --i) {
+        siftDownHole<2>(a, k, i, std::move(a[i]), true, obs);
+    }
+    for (Index i = k; i < n; ++i) {
+        obs.compared(i, 0);
+        if (a[i] < a[0]) { // -> the root, the largest of the k kept so far, goes out to i
+            T value = std::move(a[i]);
+            a[i] = std::move(a[0]);
+            obs.written(i);
+            siftDownHole<2>(a, k, 0, std::move(value), false, obs);
+        }
+        if (!obs.proceed()) {
+            return;
+        }
+    }
+    std::swap(a[0], a[k - 1]); // -> the root is the k-th smallest
+    obs.swapped(0, k - 1);
+}
+
+#if ALGORI_X86
+inline int countTrailingZeros(unsigned x) { // -> index of the lowest set bit, x must not be 0
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return int(index);
+#else
+    return __builtin_ctz(x);
+#endif
+}
+
+template <typename Key>
+struct Avx2Filter { // -> appends the positions of the keys below the threshold, a register at a time
+    ALGORI_AVX2 static Index below(const Key* a, Index begin, Index end, Key threshold, Index* out) {
+        const int lanes = Avx2Ops<Key>::lanes;
+        __m256i bound = lanes == 8 ? _mm256_set1_epi32(std::int32_t(threshold)) : _mm256_set1_epi64x(std::int64_t(threshold));
+        Index count = 0, i = begin;
+        for (; i + lanes <= end; i += lanes) {
+            __m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            for (int bits = Avx2Ops<Key>::mask(Avx2Ops<Key>::greater(bound, keys)); bits != 0; bits &= bits - 1) {
+                out[count++] = i + countTrailingZeros(unsigned(bits));
+            }
+        }
+        for (; i < end; ++i) {
+            if (a[i] < threshold) {
+                out[count++] = i;
+            }
+        }
+        return count;
+    }
+};
+#endif
+
+template <typename T, typename Policy>
+void streamTopK(T* a, Index n, Index k, Policy& obs) {
+    Index capacity = std::max<Index>(2 * k, k + 64);
+    ScratchBuffer<Index> kept(capacity + 64); // -> slack for one filtered block past a full list
+    Index count = 0;
+    auto byKey = [a](Index x, Index y) { return a[x] < a[y]; };
+    for (; count < k; ++count) { // -> the first k keys are the first candidates
+        kept[count] = count;
+        obs.region(count, count + 1, 2);
+    }
+    T threshold = a[*std::max_element(kept.begin(), kept.begin() + k, byKey)]; // -> never below the k-th smallest so far
+    auto shrink = [&] { // -> keep the k smallest candidates, kept[k - 1] is the k-th
+        std::nth_element(kept.begin(), kept.begin() + (k - 1), kept.begin() + count, byKey);
+        for (Index c = k; c < count; ++c) {
+            obs.region(kept[c], kept[c] + 1, -1);
+        }
+        count = k;
+        threshold = a[kept[k - 1]];
+    };
+    const Index BLOCK = 64;
+    for (Index begin = k; begin < n; begin += BLOCK) {
+        Index end = std::min(n, begin + BLOCK);
+        if (count >= capacity) {
+            shrink();
+        }
+        Index found = -1;
+#if ALGORI_X86
+        if constexpr (std::is_same<Policy, NativePolicy>::value && IsAvx2Key<T>::value) {
+            if (useAvx2()) {
+                found = Avx2Filter<T>::below(a, begin, end, threshold, kept.data() + count);
+            }
+        }
+#endif
+        if (found < 0) {
+            found = 0;
+            for (Index i = begin; i < end; ++i) {
+                obs.compared(i, i);
+                kept[count + found] = i;
+                found += a[i] < threshold;
+                if (!obs.proceed()) {
+                    return;
+                }
+            }
+        }
+        for (Index c = count; c < count + found; ++c) {
+            obs.region(kept[c], kept[c] + 1, 2);
+        }
+        count += found;
+    }
+    shrink();
+
+    // The k winners move to the front: every front slot without a winner swaps with a winner behind it.
+    std::sort(kept.begin(), kept.begin() + k);
+    Index inFront = std::lower_bound(kept.begin(), kept.begin() + k, k) - kept.begin();
+    for (Index slot = 0, front = 0, back = inFront; back < k; ++slot) {
+        if (front < inFront && kept[front] == slot) {
+            front++;
+            continue;
+        }
+        std::swap(a[slot], a[kept[back]]);
+        obs.swapped(slot, kept[back]);
+        back++;
+    }
+    Index largest = Index(std::max_element(a, a + k) - a);
+    std::swap(a[largest], a[k - 1]);
+    obs.swapped(largest, k - 1);
+}
+
+//.....................................| Algorithm registry |.....................................//
+// The UI, startSorting()/startSearching()/startSelecting() and the benchmark all dispatch through these tables. The
+// lists below are the single place an algorithm is registered: they expand into the ids, the rows and
+// the per element type/policy function tables.
+// The access column is the memory access pattern of the algorithm, used for madvise() on mapped datasets.
+template <typename T, typename Policy>
+void autoSort(T* a, Index n, Policy& obs); // -> Adaptive sort, below: it dispatches through these tables
+
+#define SORT_ALGORITHMS(X) /* -> in dropdown order */ \
+    X(Bubble, "bubble", "Bubble Sort", bubbleSort, Sequential) \
+    X(Quick, "quick", "Quick Sort", quickSort, Normal) \
+    X(Insertion, "insertion", "Insertion Sort", insertionSort, Normal) \
+    X(Selection, "selection", "Selection Sort", selectionSort, Sequential) \
+    X(Merge, "merge", "Merge Sort", mergeSort, Sequential) \
+    X(Heap, "heap", "Heap Sort", heapSort, Random) \
+    X(HeapHole, "heap-hole", "Hole Heap Sort", holeHeapSort, Random) \
+    X(HeapFloyd, "heap-floyd", "Bottom-up Heap", floydHeapSort, Random) \
+    X(Heap4, "heap4", "4-ary Heap Sort", heap4Sort, Random) \
+    X(Heap8, "heap8", "8-ary Heap Sort", heap8Sort, Random) \
+    X(Bucket, "bucket", "Bucket Sort", bucketSort, Sequential) \
+    X(Gnome, "gnome", "Gnome Sort", gnomeSort, Normal) \
+    X(Tim, "tim", "Tim Sort", timSort, Sequential) \
+    X(Cycle, "cycle", "Cycle Sort", cycleSort, Sequential) \
+    X(Multiway, "multiway", "Multiway Merge", multiwayMergeSort, Sequential) \
+    X(Simd, "simd", "SIMD Sort", simdSort, Normal) \
+    X(Sample, "sample", "Sample Sort", sampleSort, Normal) \
+    X(Block, "block", "Block Merge", blockMergeSort, Sequential) \
+    X(Auto, "auto", "Auto Sort", autoSort, Normal)
+
+#define SEARCH_ALGORITHMS(X) \
+    X(Linear, "linear", "Linear Search", linearSearch, Sequential) \
+    X(Binary, "binary", "Binary Search", binarySearch, Random) \
+    X(Ternary, "ternary", "Ternary Search", ternarySearch, Random)
+
+#define SELECT_ALGORITHMS(X) \
+    X(Quick, "quickselect", "Quickselect", quickSelect, Normal) \
+    X(Intro, "introselect", "Introselect", introSelect, Normal) \
+    X(FloydRivest, "floyd-rivest", "Floyd-Rivest", floydRivestSelect, Normal) \
+    X(Heap, "heap-topk", "Heap Top-k", heapTopK, Sequential) \
+    X(Stream, "stream-topk", "Stream Top-k", streamTopK, Sequential)
+
+#define REGISTRY_ID(id, name, label, fn, access) id,
+#define REGISTRY_ROW(Kind, id, name, label, access) {Kind::id, name, label, AccessPattern::access},
+#define REGISTRY_SORT_ROW(id, name, label, fn, access) REGISTRY_ROW(SortId, id, name, label, access)
+#define REGISTRY_SEARCH_ROW(id, name, label, fn, access) REGISTRY_ROW(SearchId, id, name, label, access)
+#define REGISTRY_SELECT_ROW(id, name, label, fn, access) REGISTRY_ROW(SelectId, id, name, label, access)
+#define REGISTRY_FN(id, name, label, fn, access) fn<T, Policy>,
+
+enum class SortId { SORT_ALGORITHMS(REGISTRY_ID) Count };
+enum class SearchId { SEARCH_ALGORITHMS(REGISTRY_ID) Count };
+enum class SelectId { SELECT_ALGORITHMS(REGISTRY_ID) Count };
+enum class TraversalId { Bfs, Dfs, Dijkstra, Dijkstra4, DijkstraPairing, DijkstraRadix, AStar, Components, Topological, Count };
+enum class AccessPattern { Normal, Sequential, Random };
+
+template <typename T, typename Policy> using SortFn = void (*)(T*, Index, Policy&);
+template <typename T, typename Policy> using SearchFn = Index (*)(const T*, Index, const T&, Policy&);
+template <typename T, typename Policy> using SelectFn = void (*)(T*, Index, Index, Policy&); // -> (a, n, k), 1 <= k <= n
+
+struct SortEntry {
+    SortId id;
+    const char* name; // -> short key shown in the UI and accepted by --algo
+    const char* label;
+    AccessPattern access;
+};
+
+struct SearchEntry {
+    SearchId id;
+    const char* name;
+    const char* label;
+    AccessPattern access;
+};
+
+struct SelectEntry {
+    SelectId id;
+    const char* name;
+    const char* label;
+    AccessPattern access;
+};
+
+const SortEntry sortRegistry[] = { SORT_ALGORITHMS(REGISTRY_SORT_ROW) };
+const SearchEntry searchRegistry[] = { SEARCH_ALGORITHMS(REGISTRY_SEARCH_ROW) };
+const SelectEntry selectRegistry[] = { SELECT_ALGORITHMS(REGISTRY_SELECT_ROW) };
+
+template <typename T, typename Policy>
+SortFn<T, Policy> sortFunction(SortId id) {
+    static const SortFn<T, Policy> table[] = { SORT_ALGORITHMS(REGISTRY_FN) };
+    return table[std::size_t(id)];
+}
+
+template <typename T, typename Policy>
+SearchFn<T, Policy> searchFunction(SearchId id) {
+    static const SearchFn<T, Policy> table[] = { SEARCH_ALGORITHMS(REGISTRY_FN) };
+    return table[std::size_t(id)];
+}
+
+template <typename T, typename Policy>
+SelectFn<T, Policy> selectFunction(SelectId id) {
+    static const SelectFn<T, Policy> table[] = { SELECT_ALGORITHMS(REGISTRY_FN) };
+    return table[std::size_t(id)];
+}
+
+#undef REGISTRY_ID
+#undef REGISTRY_ROW
+#undef REGISTRY_SORT_ROW
+#undef REGISTRY_SEARCH_ROW
+#undef REGISTRY_SELECT_ROW
+#undef REGISTRY_FN
+
+static_assert(sizeof(sortRegistry) / sizeof(sortRegistry[0]) == std::size_t(SortId::Count), "one registry row per SortId");
+static_assert(sizeof(searchRegistry) / sizeof(searchRegistry[0]) == std::size_t(SearchId::Count), "one registry row per SearchId");
+static_assert(sizeof(selectRegistry) / sizeof(selectRegistry[0]) == std::size_t(SelectId::Count), "one registry row per SelectId");
+
+const SortEntry& sortEntry(SortId id) {
+    return sortRegistry[std::size_t(id)];
+}
+
+const SearchEntry& searchEntry(SearchId id) {
+    return searchRegistry[std::size_t(id)];
+}
+
+const SelectEntry& selectEntry(SelectId id) {
+    return selectRegistry[std::size_t(id)];
+}
+
+const SortEntry* findSort(const std::string& name) {
+    for (const auto& entry : sortRegistry) {
+        if (name == entry.name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const SearchEntry* findSearch(const std::string& name) {
+    for (const auto& entry : searchRegistry) {
+        if (name == entry.name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+//.....................................| Adaptive sort |.....................................//
+// "auto" looks at the input before sorting it and hands it to the candidate that a cost model predicts
+// to be fastest. The profile is one pass over the array (ascending or descending natural runs, and the
+// key range for integers) plus a strided sample of AUTO_SAMPLE keys (how often the sample descends in
+// index order, and how many sample keys repeat). The model is a table of calibration rows, each one a
+// profile and the measured ns per element of every candidate on that input; a prediction is the
+// inverse-distance weighted geometric mean of the AUTO_NEIGHBOURS nearest rows, and a candidate that
+// any of them lacks (not measured, or quadratic on that input) is ruled out.
+// `algori --bench --calibrate FILE` measures the rows on the local machine; the model is read from
+// --cost-model FILE or ./cost-model.txt, and the built-in table below was measured on a development machine.
+const SortId AUTO_CANDIDATES[] = {SortId::Insertion, SortId::Quick, SortId::Merge, SortId::Bucket, SortId::Tim, SortId::Simd, SortId::Sample};
+const int AUTO_CANDIDATE_COUNT = int(sizeof(AUTO_CANDIDATES) / sizeof(AUTO_CANDIDATES[0]));
+const int AUTO_FEATURES = 7;
+const Index AUTO_SAMPLE = 1024;
+const int AUTO_NEIGHBOURS = 3;
+
+struct SortProfile {
+    Index n = 0;
+    Index runs = 0;        // -> natural runs: ascending ones, or descending ones when those are fewer (TimSort reverses them)
+    bool sorted = false;   // -> no key below its predecessor
+    double disorder = 0;   // -> descents between consecutive sample keys: 0 sorted, 0.5 random, 1 reversed
+    double duplicates = 0; // -> sample keys equal to their sorted neighbour
+    double range = -1;     // -> (max - min + 1) / n for integers, -1 for other keys
+    std::size_t bytes = 0;
+    bool indirect = false; // -> elements own heap memory (strings): moves and comparisons chase pointers
+
+    void features(double* f) const { // -> the model's coordinates, each one spans a few units
+        f[0] = std::log2(double(std::max<Index>(n, 1)));
+        f[1] = std::log2(double(std::max<Index>(runs, 1)));
+        f[2] = 8 * disorder;
+        f[3] = 8 * duplicates;
+        f[4] = range < 0 ? 8 : std::min(8.0, std::max(-8.0, std::log2(range)));
+        f[5] = std::log2(double(bytes));
+        f[6] = indirect ? 4 : 0;
+    }
+};
+
+template <typename T>
+SortProfile profileInput(const T* a, Index n) { // -> raw comparisons, the policy does not see or count them
+    SortProfile profile;
+    profile.n = n;
+    profile.bytes = sizeof(T);
+    profile.indirect = !std::is_trivially_copyable<T>::value;
+    Index descents = 0;
+    if constexpr (std::is_integral<T>::value) { // -> no branch on the data, random input would mispredict every other step
+        T low = n > 0 ? a[0] : T(), high = low;
+        for (Index i = 1; i < n; ++i) {
+            descents += a[i] < a[i - 1];
+            low = std::min(low, a[i]);
+            high = std::max(high, a[i]);
+        }
+        profile.range = (double(high) - double(low) + 1) / double(std::max<Index>(n, 1));
+    } else {
+        for (Index i = 1; i < n; ++i) {
+            descents += a[i] < a[i - 1];
+        }
+    }
+    profile.runs = 1 + std::min(descents, std::max<Index>(n - 1, 0) - descents);
+    profile.sorted = descents == 0;
+
+    Index samples = std::min(n, AUTO_SAMPLE);
+    if (samples > 1) {
+        ScratchBuffer<T> sample(samples);
+        SplitMix64 rng(static_cast<std::uint64_t>(n));
+        Index descents = 0, repeats = 0;
+        for (Index s = 0; s < samples; ++s) { // -> one key from each of `samples` equal strides
+            Index begin = s * n / samples, end = (s + 1) * n / samples;
+            sample[s] = a[begin + Index(rng.below(std::uint64_t(end - begin)))];
+            descents += s > 0 && sample[s] < sample[s - 1];
+        }
+        std::sort(sample.begin(), sample.end());
+        for (Index s = 1; s < samples; ++s) {
+            repeats += !(sample[s - 1] < sample[s]);
+        }
+        profile.disorder = double(descents) / double(samples - 1);
+        profile.duplicates = double(repeats) / double(samples - 1);
+    }
+    return profile;
+}
+
+struct CostRow {
+    double features[AUTO_FEATURES];
+    double nsPerElement[AUTO_CANDIDATE_COUNT]; // -> infinity where the candidate was not measured
+};
+
+struct CostModel {
+    std::vector<CostRow> rows;
+    std::string source;
+};
+
+std::string costModelPath = "cost-model.txt"; // -> --cost-model; the built-in table is used when it cannot be read
+
+// Measured with `algori --bench --calibrate` (int32, uint64, str15 and rec64; n = 100, 10000 and
+// 1000000; every distribution plus the narrow ranges).
+const char* const BUILTIN_COST_MODEL = R"(
+# algori auto sort cost model: type dist n, log2 n, log2 runs, 8 disorder, 8 duplicates, log2 range, log2 bytes,
+# indirect, then ns per element of each candidate
+# seed 1
+# candidates insertion quick merge bucket tim simd sample
+int32 uniform 100 6.644 5.615 3.879 0.000 8.000 2.000 0.000 31.730 30.960 48.340 28.230 18.960 15.950 118.480
+int32 sorted 100 6.644 0.000 0.000 0.000 8.000 2.000 0.000 3.550 83.540 25.940 20.960 6.550 10.610 98.700
+int32 reversed 100 6.644 0.000 8.000 0.000 8.000 2.000 0.000 55.550 97.470 29.370 23.610 28.720 10.760 101.430
+int32 nearly 100 6.644 1.585 0.162 0.000 8.000 2.000 0.000 3.270 82.290 24.640 17.500 6.970 8.850 90.610
+int32 few-unique 100 6.644 5.555 3.717 6.788 8.000 2.000 0.000 30.730 60.340 41.630 20.990 22.340 8.470 102.320
+int32 zipf 100 6.644 5.615 3.879 4.687 0.000 2.000 0.000 32.590 37.070 45.150 29.990 23.390 10.590 101.100
+int32 organ-pipe 100 6.644 5.644 3.960 4.040 8.000 2.000 0.000 32.130 29.760 28.320 21.710 14.300 10.670 101.610
+int32 sawtooth 100 6.644 3.000 0.566 7.030 8.000 2.000 0.000 35.870 25.920 38.400 19.990 18.080 11.250 99.660
+int32 runs 100 6.644 3.907 1.131 0.000 8.000 2.000 0.000 36.020 41.460 44.270 25.400 29.670 10.720 102.940
+int32 narrow 100 6.644 5.555 3.717 7.596 -4.059 2.000 0.000 37.250 29.240 34.920 26.600 19.790 10.690 96.790
+int32 bars 100 6.644 5.426 3.394 0.889 2.632 2.000 0.000 41.150 34.680 45.320 27.430 22.960 10.180 105.420
+uint64 uniform 100 6.644 5.615 3.879 0.000 8.000 3.000 0.000 40.050 39.490 50.750 32.600 26.380 29.900 121.930
+uint64 sorted 100 6.644 0.000 0.000 0.000 8.000 3.000 0.000 4.020 105.560 23.310 23.980 8.160 28.150 116.280
+uint64 reversed 100 6.644 0.000 8.000 0.000 8.000 3.000 0.000 61.010 102.690 24.310 23.040 22.680 27.890 107.160
+uint64 nearly 100 6.644 1.585 0.162 0.000 8.000 3.000 0.000 3.830 95.950 25.040 24.320 7.120 27.850 109.570
+uint64 few-unique 100 6.644 5.555 3.717 6.788 8.000 3.000 0.000 30.480 23.150 37.830 22.260 23.770 27.330 100.980
+uint64 zipf 100 6.644 5.615 3.879 4.687 0.000 3.000 0.000 40.460 38.040 45.060 26.880 28.000 30.900 99.670
+uint64 organ-pipe 100 6.644 5.644 3.960 4.040 8.000 3.000 0.000 29.080 24.860 24.220 21.040 14.730 25.150 104.350
+uint64 sawtooth 100 6.644 3.000 0.566 7.030 8.000 3.000 0.000 27.880 22.940 28.040 20.510 19.450 23.890 73.120
+uint64 runs 100 6.644 3.907 1.131 0.000 8.000 3.000 0.000 26.550 23.030 28.030 19.760 18.250 22.850 94.980
+uint64 narrow 100 6.644 5.555 3.717 7.596 -4.059 3.000 0.000 26.390 19.860 32.420 20.400 16.830 25.150 76.980
+uint64 bars 100 6.644 5.426 3.394 0.889 2.632 3.000 0.000 28.540 23.020 29.080 21.530 17.790 27.040 89.950
+str15 uniform 100 6.644 5.615 3.879 0.000 8.000 5.000 4.000 476.750 145.330 239.700 192.260 254.140 436.260 302.030
+str15 sorted 100 6.644 0.000 0.000 0.000 8.000 5.000 4.000 26.780 528.750 176.940 137.630 62.020 292.250 275.550
+str15 reversed 100 6.644 0.000 8.000 0.000 8.000 5.000 4.000 916.860 423.880 166.720 139.960 315.850 383.960 316.220
+str15 nearly 100 6.644 1.585 0.162 0.000 8.000 5.000 4.000 31.320 528.530 168.350 129.860 62.110 294.920 270.000
+str15 few-unique 100 6.644 5.555 3.717 6.788 8.000 5.000 4.000 468.310 153.880 245.340 171.990 229.990 423.680 243.580
+str15 zipf 100 6.644 5.615 3.879 4.687 8.000 5.000 4.000 497.320 198.210 207.010 184.170 273.140 410.550 270.910
+str15 organ-pipe 100 6.644 5.644 3.960 4.040 8.000 5.000 4.000 520.530 190.510 183.780 234.280 204.560 360.710 281.700
+str15 sawtooth 100 6.644 3.000 0.566 7.030 8.000 5.000 4.000 467.250 167.000 202.930 152.270 204.140 393.570 222.680
+str15 runs 100 6.644 3.907 1.131 0.000 8.000 5.000 4.000 438.460 152.120 225.960 197.990 223.740 393.260 273.820
+str15 narrow 100 6.644 5.555 3.717 7.596 8.000 5.000 4.000 459.120 142.300 227.390 180.600 208.140 395.400 231.990
+str15 bars 100 6.644 5.426 3.394 0.889 8.000 5.000 4.000 550.370 169.920 262.920 216.010 239.350 408.380 299.770
+rec64 uniform 100 6.644 5.615 3.879 0.000 8.000 6.000 0.000 70.960 40.220 59.170 35.880 29.040 97.340 159.030
+rec64 sorted 100 6.644 0.000 0.000 0.000 8.000 6.000 0.000 3.940 257.790 26.760 30.930 11.490 47.650 87.250
+rec64 reversed 100 6.644 0.000 8.000 0.000 8.000 6.000 0.000 68.710 155.720 31.510 30.050 46.870 79.430 128.870
+rec64 nearly 100 6.644 1.585 0.162 0.000 8.000 6.000 0.000 5.450 266.280 35.600 27.100 13.190 69.250 123.750
+rec64 few-unique 100 6.644 5.555 3.717 6.788 8.000 6.000 0.000 49.900 30.430 54.240 24.780 28.260 98.910 105.510
+rec64 zipf 100 6.644 5.615 3.879 4.687 8.000 6.000 0.000 55.860 32.230 52.810 31.730 38.380 102.780 114.170
+rec64 organ-pipe 100 6.644 5.644 3.960 4.040 8.000 6.000 0.000 69.420 38.040 40.000 29.280 26.570 83.050 125.750
+rec64 sawtooth 100 6.644 3.000 0.566 7.030 8.000 6.000 0.000 55.740 33.750 44.470 37.160 28.260 100.250 104.370
+rec64 runs 100 6.644 3.907 1.131 0.000 8.000 6.000 0.000 44.890 34.950 48.140 46.190 28.410 89.070 105.770
+rec64 narrow 100 6.644 5.555 3.717 7.596 8.000 6.000 0.000 48.840 27.770 48.530 26.460 28.420 82.570 94.080
+rec64 bars 100 6.644 5.426 3.394 0.889 8.000 6.000 0.000 53.330 33.900 39.080 30.200 31.130 100.940 125.120
+int32 uniform 10000 13.288 12.285 4.004 0.000 8.000 2.000 0.000 2116.501 100.228 126.051 27.682 78.651 16.455 24.583
+int32 sorted 10000 13.288 0.000 0.000 0.000 8.000 2.000 0.000 0.971 7520.209 32.947 22.228 8.678 20.485 33.503
+int32 reversed 10000 13.288 0.000 8.000 0.000 8.000 2.000 0.000 3930.893 16710.667 43.568 24.619 27.757 22.251 31.546
+int32 nearly 10000 13.288 7.622 0.156 0.000 8.000 2.000 0.000 64.365 745.485 51.145 21.744 19.392 18.512 29.717
+int32 few-unique 10000 13.288 12.197 3.683 7.883 8.000 2.000 0.000 4142.780 841.476 81.600 22.488 48.565 4.802 10.549
+int32 zipf 10000 13.288 12.257 3.941 3.902 -0.001 2.000 0.000 3907.889 201.745 116.355 41.501 81.829 17.762 24.909
+int32 organ-pipe 10000 13.288 12.288 4.004 0.352 8.000 2.000 0.000 4701.239 2179.716 39.238 16.244 17.639 19.490 35.038
+int32 sawtooth 10000 13.288 3.000 0.055 2.229 8.000 2.000 0.000 3275.901 2240.962 42.565 17.464 16.280 20.465 30.388
+int32 runs 10000 13.288 4.000 0.117 0.000 8.000 2.000 0.000 4142.444 996.224 69.690 35.279 40.492 24.936 31.026
+int32 narrow 10000 13.288 12.287 4.098 4.176 -4.000 2.000 0.000 3975.126 70.262 111.779 39.628 75.229 18.813 26.082
+int32 bars 10000 13.288 12.271 3.973 3.949 -3.941 2.000 0.000 4082.601 86.058 136.331 48.899 91.666 23.035 31.593
+uint64 uniform 10000 13.288 12.285 4.004 0.000 8.000 3.000 0.000 4818.163 101.217 119.594 35.697 91.884 44.105 41.635
+uint64 sorted 10000 13.288 0.000 0.000 0.000 8.000 3.000 0.000 1.603 12130.529 31.468 19.085 10.422 59.670 52.266
+uint64 reversed 10000 13.288 0.000 8.000 0.000 8.000 3.000 0.000 5929.683 12627.091 25.338 16.615 20.642 35.257 46.011
+uint64 nearly 10000 13.288 7.622 0.156 0.000 8.000 3.000 0.000 34.887 594.576 25.334 12.604 15.349 40.025 48.776
+uint64 few-unique 10000 13.288 12.197 3.683 7.883 8.000 3.000 0.000 4303.567 849.060 85.879 24.506 56.640 10.794 8.271
+uint64 zipf 10000 13.288 12.257 3.941 3.902 -0.001 3.000 0.000 3062.466 164.935 76.292 28.552 66.044 29.643 28.322
+uint64 organ-pipe 10000 13.288 12.288 4.004 0.352 8.000 3.000 0.000 2413.641 2363.011 23.893 12.597 12.939 44.030 45.219
+uint64 sawtooth 10000 13.288 3.000 0.055 2.229 8.000 3.000 0.000 3986.023 2370.608 35.614 18.524 15.038 47.767 45.446
+uint64 runs 10000 13.288 4.000 0.117 0.000 8.000 3.000 0.000 3994.626 743.891 42.390 25.924 29.601 39.734 41.521
+uint64 narrow 10000 13.288 12.287 4.098 4.176 -4.000 3.000 0.000 2380.930 64.174 84.745 36.706 69.945 48.235 39.058
+uint64 bars 10000 13.288 12.271 3.973 3.949 -3.941 3.000 0.000 3932.035 88.475 124.472 48.413 90.764 53.848 57.239
+str15 uniform 10000 13.288 12.285 4.004 0.000 8.000 5.000 4.000 99967.074 810.111 939.388 1130.151 1282.021 1592.401 1467.668
+str15 sorted 10000 13.288 0.000 0.000 0.000 8.000 5.000 4.000 26.330 49948.474 297.921 181.564 133.083 314.473 347.710
+str15 reversed 10000 13.288 0.000 8.000 0.000 8.000 5.000 4.000 184096.208 75674.026 652.204 322.024 781.983 873.751 879.319
+str15 nearly 10000 13.288 7.622 0.156 0.000 8.000 5.000 4.000 2451.775 2849.096 741.517 701.995 545.042 766.026 750.007
+str15 few-unique 10000 13.288 12.197 3.683 7.883 8.000 5.000 4.000 46156.747 1661.528 340.611 193.140 331.965 112.954 73.147
+str15 zipf 10000 13.288 12.257 3.941 3.902 8.000 5.000 4.000 47612.000 818.018 518.242 370.775 469.676 493.108 439.788
+str15 organ-pipe 10000 13.288 12.288 4.004 0.352 8.000 5.000 4.000 50464.223 17335.146 349.443 437.308 329.623 1074.897 620.422
+str15 sawtooth 10000 13.288 3.000 0.055 2.229 8.000 5.000 4.000 41750.565 16284.453 316.796 277.140 167.511 631.303 545.233
+str15 runs 10000 13.288 4.000 0.117 0.000 8.000 5.000 4.000 45862.462 8497.892 382.059 318.615 213.753 515.441 487.618
+str15 narrow 10000 13.288 12.287 4.098 4.176 8.000 5.000 4.000 50161.616 332.108 357.516 283.940 377.406 512.660 429.729
+str15 bars 10000 13.288 12.271 3.973 3.949 8.000 5.000 4.000 49942.813 351.526 459.071 339.342 439.177 569.631 547.236
+rec64 uniform 10000 13.288 12.285 4.004 0.000 8.000 6.000 0.000 6381.234 134.858 188.858 47.030 132.079 196.087 206.470
+rec64 sorted 10000 13.288 0.000 0.000 0.000 8.000 6.000 0.000 4.092 33285.702 66.865 27.576 36.830 87.319 120.434
+rec64 reversed 10000 13.288 0.000 8.000 0.000 8.000 6.000 0.000 9834.562 15542.273 47.631 16.639 47.792 67.606 81.906
+rec64 nearly 10000 13.288 7.622 0.156 0.000 8.000 6.000 0.000 93.600 572.747 46.811 16.323 29.557 61.244 72.967
+rec64 few-unique 10000 13.288 12.197 3.683 7.883 8.000 6.000 0.000 4038.847 221.627 107.093 38.223 68.920 35.074 18.252
+rec64 zipf 10000 13.288 12.257 3.941 3.902 8.000 6.000 0.000 5577.687 122.717 122.321 30.988 103.320 117.199 111.029
+rec64 organ-pipe 10000 13.288 12.288 4.004 0.352 8.000 6.000 0.000 4398.097 3738.915 85.356 33.305 62.464 260.192 186.775
+rec64 sawtooth 10000 13.288 3.000 0.055 2.229 8.000 6.000 0.000 5837.137 3125.304 48.139 25.934 45.244 123.205 170.630
+rec64 runs 10000 13.288 4.000 0.117 0.000 8.000 6.000 0.000 5834.773 1850.862 90.571 45.913 72.247 155.631 188.029
+rec64 narrow 10000 13.288 12.287 4.098 4.176 8.000 6.000 0.000 6697.167 100.564 142.560 29.304 124.686 196.222 197.641
+rec64 bars 10000 13.288 12.271 3.973 3.949 8.000 6.000 0.000 5819.345 91.027 153.140 31.891 117.793 158.104 160.338
+int32 uniform 1000000 19.932 18.931 4.035 0.000 8.000 2.000 0.000 - 120.607 175.799 72.580 141.381 28.067 37.586
+int32 sorted 1000000 19.932 0.000 0.000 0.000 8.000 2.000 0.000 1.671 - 41.136 20.761 16.630 34.297 35.621
+int32 reversed 1000000 19.932 0.000 8.000 0.000 8.000 2.000 0.000 - - 61.584 17.093 19.709 14.266 22.631
+int32 nearly 1000000 19.932 14.259 0.211 0.000 8.000 2.000 0.000 7270.738 391.134 51.797 25.868 24.772 16.038 25.067
+int32 few-unique 1000000 19.932 18.838 3.730 7.883 8.000 2.000 0.000 - - 97.106 82.597 136.336 9.509 22.649
+int32 zipf 1000000 19.932 18.921 4.012 2.354 -0.000 2.000 0.000 - 9587.114 166.094 61.899 122.490 23.469 28.388
+int32 organ-pipe 1000000 19.932 18.932 3.996 0.008 8.000 2.000 0.000 - - 58.325 31.536 28.466 26.924 39.496
+int32 sawtooth 1000000 19.932 3.000 0.055 0.031 8.000 2.000 0.000 - - 66.104 48.346 20.327 46.943 70.619
+int32 runs 1000000 19.932 4.000 0.117 0.000 8.000 2.000 0.000 - - 89.542 65.601 49.681 29.833 41.277
+int32 narrow 1000000 19.932 18.931 3.980 0.039 -4.000 2.000 0.000 - 136.774 191.333 55.561 300.857 70.245 95.272
+int32 bars 1000000 19.932 18.929 3.980 4.113 -8.000 2.000 0.000 - 2159.406 299.681 128.885 107.549 14.060 22.507
+uint64 uniform 1000000 19.932 18.931 4.035 0.000 8.000 3.000 0.000 - 148.347 390.622 270.455 337.447 175.046 178.514
+uint64 sorted 1000000 19.932 0.000 0.000 0.000 8.000 3.000 0.000 6.207 - 121.841 67.754 57.322 142.545 141.196
+uint64 reversed 1000000 19.932 0.000 8.000 0.000 8.000 3.000 0.000 - - 55.182 28.963 46.985 62.824 54.864
+uint64 nearly 1000000 19.932 14.259 0.211 0.000 8.000 3.000 0.000 9953.304 407.730 46.154 27.417 27.408 42.614 48.800
+uint64 few-unique 1000000 19.932 18.838 3.730 7.883 8.000 3.000 0.000 - - 82.496 31.008 59.675 12.300 12.506
+uint64 zipf 1000000 19.932 18.921 4.012 2.354 -0.000 3.000 0.000 - 4517.597 159.602 61.675 135.897 52.039 47.950
+uint64 organ-pipe 1000000 19.932 18.932 3.996 0.008 8.000 3.000 0.000 - - 39.245 21.967 26.774 51.452 62.962
+uint64 sawtooth 1000000 19.932 3.000 0.055 0.031 8.000 3.000 0.000 - - 51.494 37.347 22.471 48.303 56.636
+uint64 runs 1000000 19.932 4.000 0.117 0.000 8.000 3.000 0.000 - - 70.191 53.461 55.739 53.181 64.477
+uint64 narrow 1000000 19.932 18.931 3.980 0.039 -4.000 3.000 0.000 - 128.166 146.082 58.037 143.068 76.418 70.203
+uint64 bars 1000000 19.932 18.929 3.980 4.113 -8.000 3.000 0.000 - 904.507 136.720 55.101 107.755 30.022 29.362
+str15 uniform 1000000 19.932 18.931 4.035 0.000 8.000 5.000 4.000 - 669.631 867.511 560.933 1553.590 906.586 851.490
+str15 sorted 1000000 19.932 0.000 0.000 0.000 8.000 5.000 4.000 29.648 - 544.059 292.037 265.556 387.021 465.873
+str15 reversed 1000000 19.932 0.000 8.000 0.000 8.000 5.000 4.000 - - 763.802 239.251 589.966 640.202 685.323
+str15 nearly 1000000 19.932 14.259 0.211 0.000 8.000 5.000 4.000 - 3141.682 602.075 882.273 755.463 917.652 545.856
+str15 few-unique 1000000 19.932 18.838 3.730 7.883 8.000 5.000 4.000 - - 686.915 418.284 563.756 168.122 91.231
+str15 zipf 1000000 19.932 18.921 4.012 2.354 8.000 5.000 4.000 - 19821.816 705.785 474.294 618.197 480.431 429.953
+str15 organ-pipe 1000000 19.932 18.932 3.996 0.008 8.000 5.000 4.000 - - 366.096 547.226 384.104 1387.533 1313.550
+str15 sawtooth 1000000 19.932 3.000 0.055 0.031 8.000 5.000 4.000 - - 525.315 451.003 278.943 924.763 609.075
+str15 runs 1000000 19.932 4.000 0.117 0.000 8.000 5.000 4.000 - - 499.304 366.684 275.528 850.569 956.174
+str15 narrow 1000000 19.932 18.931 3.980 0.039 8.000 5.000 4.000 - 563.005 797.085 508.266 667.433 782.372 721.243
+str15 bars 1000000 19.932 18.929 3.980 4.113 8.000 5.000 4.000 - 3529.536 731.464 402.049 494.468 262.446 224.048
+rec64 uniform 1000000 19.932 18.931 4.035 0.000 8.000 6.000 0.000 - 205.773 305.089 166.147 298.082 236.723 264.328
+rec64 sorted 1000000 19.932 0.000 0.000 0.000 8.000 6.000 0.000 12.009 - 222.090 74.446 142.362 97.083 132.252
+rec64 reversed 1000000 19.932 0.000 8.000 0.000 8.000 6.000 0.000 - - 235.592 67.326 219.035 149.682 193.897
+rec64 nearly 1000000 19.932 14.259 0.211 0.000 8.000 6.000 0.000 - 1874.352 214.816 66.630 189.622 142.573 139.886
+rec64 few-unique 1000000 19.932 18.838 3.730 7.883 8.000 6.000 0.000 - - 234.553 119.273 236.180 65.259 38.232
+rec64 zipf 1000000 19.932 18.921 4.012 2.354 8.000 6.000 0.000 - 7456.499 317.601 124.184 273.293 159.522 143.116
+rec64 organ-pipe 1000000 19.932 18.932 3.996 0.008 8.000 6.000 0.000 - - 204.576 72.697 175.666 292.393 244.597
+rec64 sawtooth 1000000 19.932 3.000 0.055 0.031 8.000 6.000 0.000 - - 222.019 112.880 174.318 254.070 225.180
+rec64 runs 1000000 19.932 4.000 0.117 0.000 8.000 6.000 0.000 - - 192.160 123.061 187.270 227.086 231.216
+rec64 narrow 1000000 19.932 18.931 3.980 0.039 8.000 6.000 0.000 - 176.904 326.718 135.686 295.024 280.351 229.541
+rec64 bars 1000000 19.932 18.929 3.980 4.113 8.000 6.000 0.000 - 782.392 328.229 128.471 280.847 119.299 98.516
+)";
+
+// The calibration file: comment lines start with '#', "# candidates a b c" names the ns columns,
+// and a row is "type dist n", the AUTO_FEATURES profile coordinates and one ns per element per
+// candidate ("-" where it was not measured). Columns of algorithms that are no longer candidates are skipped.
+bool parseCostModel(const std::string& text, CostModel& model) {
+    std::vector<int> columns; // -> candidate of each ns column, -1 for names that are not candidates
+    std::size_t begin = 0;
+    while (begin < text.size()) {
+        std::size_t end = text.find('\n', begin);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string line = text.substr(begin, end - begin);
+        begin = end + 1;
+        char token[32];
+        int used = 0;
+        if (line.compare(0, 12, "# candidates") == 0) {
+            columns.clear();
+            for (const char* cursor = line.c_str() + 12; std::sscanf(cursor, "%31s%n", token, &used) == 1; cursor += used) {
+                const SortEntry* entry = findSort(token);
+                auto known = std::find_if(std::begin(AUTO_CANDIDATES), std::end(AUTO_CANDIDATES),
+                                          [&](SortId id) { return entry && entry->id == id; });
+                columns.push_back(known == std::end(AUTO_CANDIDATES) ? -1 : int(known - std::begin(AUTO_CANDIDATES)));
+            }
+            continue;
+        }
+        char type[32], dist[32];
+        long long n = 0;
+        if (line.empty() || line[0] == '#' || std::sscanf(line.c_str(), "%31s %31s %lld%n", type, dist, &n, &used) != 3) {
+            continue;
+        }
+        CostRow row;
+        const char* cursor = line.c_str() + used;
+        int features = 0;
+        for (; features < AUTO_FEATURES && std::sscanf(cursor, "%lf%n", &row.features[features], &used) == 1; ++features) {
+            cursor += used;
+        }
+        std::fill(row.nsPerElement, row.nsPerElement + AUTO_CANDIDATE_COUNT, std::numeric_limits<double>::infinity());
+        for (std::size_t column = 0; column < columns.size() && std::sscanf(cursor, "%31s%n", token, &used) == 1; ++column, cursor += used) {
+            if (columns[column] >= 0 && token[0] != '-') {
+                row.nsPerElement[columns[column]] = std::strtod(token, nullptr);
+            }
+        }
+        if (features == AUTO_FEATURES) {
+            model.rows.push_back(row);
+        }
+    }
+    return !model.rows.empty();
+}
+
+bool readTextFile(const std::string& path, std::string& text) {
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) {
+        return false;
+    }
+    char buffer[1 << 16];
+    std::size_t got = 0;
+    while ((got = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        text.append(buffer, got);
+    }
+    std::fclose(in);
+    return true;
+}
+
+const CostModel& costModel() { // -> read once, by the first auto sort
+    static const CostModel model = [] {
+        CostModel loaded;
+        std::string text;
+        if (readTextFile(costModelPath, text) && parseCostModel(text, loaded)) {
+            loaded.source = costModelPath;
+        } else {
+            parseCostModel(BUILTIN_COST_MODEL, loaded);
+            loaded.source = "built-in";
+        }
+        return loaded;
+    }();
+    return model;
+}
+
+SortId predictFastest(const SortProfile& profile) {
+    const CostModel& model = costModel();
+    double f[AUTO_FEATURES];
+    profile.features(f);
+    std::vector<std::pair<double, const CostRow*>> nearest;
+    for (const CostRow& row : model.rows) {
+        double distance = 0;
+        for (int i = 0; i < AUTO_FEATURES; ++i) {
+            distance += (f[i] - row.features[i]) * (f[i] - row.features[i]);
+        }
+        nearest.emplace_back(std::sqrt(distance), &row);
+    }
+    std::size_t k = std::min<std::size_t>(AUTO_NEIGHBOURS, nearest.size());
+    std::partial_sort(nearest.begin(), nearest.begin() + k, nearest.end(),
+                      [](const std::pair<double, const CostRow*>& x, const std::pair<double, const CostRow*>& y) { return x.first < y.first; });
+
+    SortId best = SortId::Merge; // -> n log n on every input, for an empty model
+    double bestNs = std::numeric_limits<double>::infinity();
+    for (int c = 0; c < AUTO_CANDIDATE_COUNT; ++c) {
+        double logSum = 0, weights = 0;
+        bool measured = k > 0;
+        for (std::size_t i = 0; i < k && measured; ++i) {
+            double ns = nearest[i].second->nsPerElement[c];
+            double weight = 1.0 / (nearest[i].first + 0.05);
+            measured = std::isfinite(ns);
+            logSum += weight * std::log(std::max(ns, 1e-3));
+            weights += weight;
+        }
+        if (measured && std::exp(logSum / weights) < bestNs) {
+            bestNs = std::exp(logSum / weights);
+            best = AUTO_CANDIDATES[c];
+        }
+    }
+    return best;
+}
+
+struct AutoDecision { // -> the last choice of autoSort, shown next to the scratch stats
+    std::atomic<int> choice{-1}; // -> a SortId, SortId::Auto when the input was already sorted
+    std::atomic<Index> runs{0};
+    std::atomic<int> duplicatePercent{0};
+} autoDecision;
+
+template <typename T, typename Policy>
+void autoSort(T* a, Index n, Policy& obs) {
+    if (n < 2) { // -> already sorted, and the decision says so rather than keeping an earlier one
+        autoDecision.runs = n;
+        autoDecision.duplicatePercent = 0;
+        autoDecision.choice = int(SortId::Auto);
+        return;
+    }
+    SortProfile profile = profileInput(a, n);
+    SortId choice = profile.sorted ? SortId::Auto : predictFastest(profile);
+    autoDecision.runs = profile.runs;
+    autoDecision.duplicatePercent = int(100 * profile.duplicates + 0.5);
+    autoDecision.choice = int(choice);
+    if (choice != SortId::Auto) {
+        sortFunction<T, Policy>(choice)(a, n, obs);
+    }
+}
+
+//.....................................| Weighted graphs |.....................................//
+// Weighted shortest paths on graphs in CSR form (offsets/targets/weights), so a million-node graph is
+// three flat arrays. Dijkstra and A* are one template over the priority queue: A* orders the frontier
+// by g + h, Dijkstra is the same loop with h = 0. The queue is a template argument, picked in the
+// tree dropdown or with --bench --paths --algo binary,4ary,pairing,radix:
+//   binary, 4ary -> indexed d-ary heaps, pushing a queued node is a decrease-key (sift up)
+//   pairing      -> pairing heap, decrease-key cuts the node's subtree and melds it with the root
+//   radix        -> monotone radix heap (Ahuja et al.): 65 buckets by the highest bit in which a key
+//                   differs from the last popped key; an improved node is pushed again and its stale
+//                   entry is skipped when it comes out
+// Grid maps come from a text file (--map) or from makeGridMap(), one character per cell: '.' and 'G'
+// cost 1, '1'..'9' that cost, 'S' (swamp) 5, and '#', '@', 'O', 'T', 'W' are walls. The header of the
+// Moving AI benchmark maps (type/height/width/map) is skipped. Moving into a cell costs that cell's
+// cost, 4-connected, which keeps the Manhattan distance times the cheapest cost an admissible and
+// consistent A* heuristic (and the keys monotone, as the radix heap needs).
+//
+// Hooks of a path search, the same scheme as the algorithm policies:
+//   queued(v)     -> v entered the frontier or its key was lowered
+//   settled(v)    -> v left the frontier with its final distance
+//   relaxed(u, v) -> the edge u -> v was examined
+//   proceed()     -> pause/cancel point, false means the run was abandoned
+typedef std::uint32_t NodeId;
+typedef std::uint64_t Distance;
+const NodeId NO_NODE = std::numeric_limits<NodeId>::max();
+const Distance UNREACHED = std::numeric_limits<Distance>::max();
+
+struct Graph {
+    Index nodes = 0;
+    std::vector<Index> offsets{0}; // -> edges of u are [offsets[u], offsets[u + 1])
+    std::vector<NodeId> targets;
+    std::vector<std::uint32_t> weights;
+    Index width = 0; // -> grid graphs: node = y * width + x, 0 for other graphs
+    bool symmetric = false; // -> every edge u -> v has a twin v -> u
+
+    Index edges() const { return Index(targets.size()); }
+};
+
+struct GridMap {
+    Index width = 0;
+    Index height = 0;
+    std::vector<std::uint8_t> cost; // -> cost of entering each cell, 0 for a wall
+
+    Index cells() const { return width * height; }
+};
+
+int cellCost(char c) { // -> -1 for a character that is not a map cell
+    if (c >= '1' && c <= '9') {
+        return c - '0';
+    }
+    switch (c) {
+        case '.':
+        case 'G': return 1;
+        case 'S': return 5;
+        case '#':
+        case '@':
+        case 'O':
+        case 'T':
+        case 'W': return 0;
+        default: return -1;
+    }
+}
+
+bool loadGridMap(const std::string& path, GridMap& map, std::string& error) {
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) {
+        error = "cannot open map " + path;
+        return false;
+    }
+    std::string text;
+    char chunk[1 << 16];
+    for (std::size_t got; (got = std::fread(chunk, 1, sizeof(chunk), in)) > 0;) {
+        text.append(chunk, got);
+    }
+    std::fclose(in);
+
+    std::vector<std::string> rows;
+    bool header = true;
+    for (std::size_t begin = 0; begin < text.size();) {
+        std::size_t end = std::min(text.find('\n', begin), text.size());
+        std::string row = text.substr(begin, end - begin);
+        begin = end + 1;
+        if (!row.empty() && row.back() == '\r') {
+            row.pop_back();
+        }
+        if (header && (row.rfind("type ", 0) == 0 || row.rfind("height ", 0) == 0 || row.rfind("width ", 0) == 0 || row == "map")) {
+            continue;
+        }
+        header = false;
+        if (!row.empty()) {
+            rows.push_back(row);
+        }
+    }
+
+    map = GridMap();
+    map.height = Index(rows.size());
+    for (const auto& row : rows) {
+        map.width = std::max(map.width, Index(row.size()));
+    }
+    if (map.cells() == 0 || map.cells() >= Index(NO_NODE)) {
+        error = path + ": no map rows, or too many cells";
+        return false;
+    }
+    map.cost.assign(map.cells(), 0); // -> short rows are padded with walls
+    bool open = false;
+    for (Index y = 0; y < map.height; ++y) {
+        for (Index x = 0; x < Index(rows[y].size()); ++x) {
+            int cost = cellCost(rows[y][x]);
+            if (cost < 0) {
+                error = path + ": unknown cell '" + rows[y][x] + "' in row " + std::to_string((long long)y + 1);
+                return false;
+            }
+            map.cost[y * map.width + x] = std::uint8_t(cost);
+            open = open || cost > 0;
+        }
+    }
+    if (!open) {
+        error = path + ": every cell is a wall";
+        return false;
+    }
+    return true;
+}
+
+// Patches of 8x8 cells with a terrain cost of 1..5, crossed by random wall segments (about a sixth of
+// the cells). Bands of 64 rows are filled in parallel, each from its own stream and with its walls
+// clipped to the band, so the map depends on the seed only. The corners are always open, they are the
+// start and goal.
+GridMap makeGridMap(Index width, Index height, std::uint64_t seed) {
+    const Index PATCH = 8;
+    const Index BAND = 64; // -> rows per chunk, a multiple of PATCH
+    GridMap map;
+    map.width = width;
+    map.height = height;
+    map.cost.resize(map.cells());
+    parallelFor((height + BAND - 1) / BAND, [&](Index band) {
+        Index top = band * BAND, bottom = std::min(height, top + BAND);
+        for (Index y = top; y < bottom; ++y) {
+            for (Index x = 0; x < width; ++x) {
+                std::uint64_t patch = std::uint64_t(y / PATCH) * std::uint64_t((width + PATCH - 1) / PATCH) + std::uint64_t(x / PATCH);
+                map.cost[y * width + x] = std::uint8_t(1 + SplitMix64::mix(seed + patch) % 5);
+            }
+        }
+        SplitMix64 rng = SplitMix64::stream(seed, ~std::uint64_t(band));
+        for (Index segment = 0; segment < (bottom - top) * width / 64; ++segment) {
+            Index x = Index(rng.below(width)), y = top + Index(rng.below(bottom - top));
+            bool horizontal = rng.below(2) == 0;
+            for (Index length = 3 + Index(rng.below(2 * PATCH)); length > 0 && x < width && y < bottom; --length) {
+                map.cost[y * width + x] = 0;
+                (horizontal ? x : y)++;
+            }
+        }
+    });
+    map.cost.front() = 1;
+    map.cost.back() = 1;
+    return map;
+}
+
+void gridEndpoints(const GridMap& map, NodeId& source, NodeId& target) { // -> first and last open cell in row-major order
+    source = target = NO_NODE;
+    for (Index cell = 0; cell < map.cells(); ++cell) {
+        if (map.cost[cell] > 0) {
+            target = NodeId(cell);
+            source = source == NO_NODE ? NodeId(cell) : source;
+        }
+    }
+}
+
+// On entry offsets[u + 1] holds the degree of u, on return offsets[u] is where u's edges start: a scan
+// of every chunk of nodes in parallel, a sequential scan of the chunk totals, and a parallel fix-up.
+void degreesToOffsets(std::vector<Index>& offsets) {
+    Index nodes = Index(offsets.size()) - 1;
+    Index chunks = (nodes + GENERATOR_CHUNK - 1) / GENERATOR_CHUNK;
+    std::vector<Index> totals(chunks + 1, 0);
+    parallelFor(chunks, [&](Index chunk) {
+        Index sum = 0;
+        for (Index u = chunk * GENERATOR_CHUNK + 1; u <= std::min(nodes, (chunk + 1) * GENERATOR_CHUNK); ++u) {
+            sum += offsets[u];
+            offsets[u] = sum;
+        }
+        totals[chunk + 1] = sum;
+    });
+    for (Index chunk = 0; chunk < chunks; ++chunk) {
+        totals[chunk + 1] += totals[chunk];
+    }
+    parallelFor(chunks, [&](Index chunk) {
+        for (Index u = chunk * GENERATOR_CHUNK + 1; u <= std::min(nodes, (chunk + 1) * GENERATOR_CHUNK); ++u) {
+            offsets[u] += totals[chunk];
+        }
+    });
+    offsets[0] = 0;
+}
+
+// Two parallel passes over chunks of cells: count the open neighbours of every cell, then write them
+// straight into the CSR arrays at the scanned offsets.
+Graph gridGraph(const GridMap& map) {
+    Graph g;
+    g.nodes = map.cells();
+    g.width = map.width;
+    g.symmetric = true;
+    g.offsets.assign(g.nodes + 1, 0);
+    auto neighbors = [&map](Index u, auto fn) { // -> fn(v) for the open cells up, left, right and down of an open cell
+        if (map.cost[u] == 0) {
+            return;
+        }
+        Index x = u % map.width, y = u / map.width;
+        if (y > 0 && map.cost[u - map.width] > 0) {
+            fn(u - map.width);
+        }
+        if (x > 0 && map.cost[u - 1] > 0) {
+            fn(u - 1);
+        }
+        if (x + 1 < map.width && map.cost[u + 1] > 0) {
+            fn(u + 1);
+        }
+        if (y + 1 < map.height && map.cost[u + map.width] > 0) {
+            fn(u + map.width);
+        }
+    };
+    Index chunks = (g.nodes + GENERATOR_CHUNK - 1) / GENERATOR_CHUNK;
+    parallelFor(chunks, [&](Index chunk) {
+        for (Index u = chunk * GENERATOR_CHUNK; u < std::min(g.nodes, (chunk + 1) * GENERATOR_CHUNK); ++u) {
+            neighbors(u, [&](Index) { g.offsets[u + 1]++; });
+        }
+    });
+    degreesToOffsets(g.offsets);
+    g.targets.resize(g.offsets.back());
+    g.weights.resize(g.offsets.back());
+    parallelFor(chunks, [&](Index chunk) {
+        for (Index u = chunk * GENERATOR_CHUNK; u < std::min(g.nodes, (chunk + 1) * GENERATOR_CHUNK); ++u) {
+            Index e = g.offsets[u];
+            neighbors(u, [&](Index v) {
+                g.targets[e] = NodeId(v);
+                g.weights[e++] = map.cost[v];
+            });
+        }
+    });
+    return g;
+}
+
+int bitWidth(std::uint64_t x) { // -> position of the highest set bit plus one, 0 for 0
+#if defined(__GNUC__) || defined(__clang__)
+    return x == 0 ? 0 : 64 - __builtin_clzll(x);
+#else
+    int width = 0;
+    for (; x != 0; x >>= 1) {
+        width++;
+    }
+    return width;
+#endif
+}
+
+// Every queue offers reset(nodes), empty(), push(v, key) (insert, or lower the key of a queued v) and
+// pop(key), which removes a node with the smallest key and returns it with that key.
+template <int Arity>
+class DaryHeap {
+public:
+    void reset(Index nodes) {
+        heap.clear();
+        position.assign(nodes, -1);
+    }
+    bool empty() const { return heap.empty(); }
+
+    void push(NodeId v, Distance key) {
+        Index hole = position[v];
+        if (hole < 0) {
+            hole = Index(heap.size());
+            heap.push_back({key, v});
+        }
+        siftUp(hole, {key, v});
+    }
+
+    NodeId pop(Distance& key) {
+        Entry top = heap.front();
+        Entry last = heap.back();
+        heap.pop_back();
+        position[top.node] = -1;
+        if (!heap.empty()) {
+            siftDown(0, last);
+        }
+        key = top.key;
+        return top.node;
+    }
+
+private:
+    struct Entry {
+        Distance key;
+        NodeId node;
+    };
+
+    void place(Index hole, const Entry& entry) {
+        heap[hole] = entry;
+        position[entry.node] = hole;
+    }
+    void siftUp(Index hole, Entry entry) {
+        while (hole > 0) {
+            Index parent = (hole - 1) / Arity;
+            if (heap[parent].key <= entry.key) {
+                break;
+            }
+            place(hole, heap[parent]);
+            hole = parent;
+        }
+        place(hole, entry);
+    }
+    void siftDown(Index hole, Entry entry) {
+        Index size = Index(heap.size());
+        while (true) {
+            Index first = hole * Arity + 1;
+            if (first >= size) {
+                break;
+            }
+            Index best = first;
+            for (Index c = first + 1; c < std::min(first + Arity, size); ++c) {
+                best = heap[c].key < heap[best].key ? c : best;
+            }
+            if (entry.key <= heap[best].key) {
+                break;
+            }
+            place(hole, heap[best]);
+            hole = best;
+        }
+        place(hole, entry);
+    }
+
+    std::vector<Entry> heap;
+    std::vector<Index> position; // -> slot of each queued node, -1 when it is not in the heap
+};
+
+class PairingHeap {
+public:
+    void reset(Index nodes) {
+        pool.resize(nodes);
+        queued.assign(nodes, 0);
+        root = NO_NODE;
+    }
+    bool empty() const { return root == NO_NODE; }
+
+    void push(NodeId v, Distance key) {
+        if (!queued[v]) {
+            queued[v] = 1;
+            pool[v] = {key, NO_NODE, NO_NODE, NO_NODE};
+            root = meld(root, v);
+            return;
+        }
+        pool[v].key = key;
+        if (v != root) { // -> lowering the key can only break the order with v's parent
+            cut(v);
+            root = meld(root, v);
+        }
+    }
+
+    NodeId pop(Distance& key) {
+        NodeId top = root;
+        key = pool[top].key;
+        queued[top] = 0;
+        root = mergePairs(pool[top].child);
+        return top;
+    }
+
+private:
+    struct Node {
+        Distance key;
+        NodeId child;   // -> leftmost child
+        NodeId sibling; // -> next sibling to the right
+        NodeId prev;    // -> parent for a leftmost child, left sibling otherwise
+    };
+
+    NodeId meld(NodeId a, NodeId b) { // -> a and b are roots, the larger one becomes the leftmost child
+        if (a == NO_NODE || b == NO_NODE) {
+            return a == NO_NODE ? b : a;
+        }
+        if (pool[b].key < pool[a].key) {
+            std::swap(a, b);
+        }
+        pool[b].prev = a;
+        pool[b].sibling = pool[a].child;
+        if (pool[a].child != NO_NODE) {
+            pool[pool[a].child].prev = b;
+        }
+        pool[a].child = b;
+        return a;
+    }
+    void cut(NodeId v) {
+        NodeId prev = pool[v].prev;
+        (pool[prev].child == v ? pool[prev].child : pool[prev].sibling) = pool[v].sibling;
+        if (pool[v].sibling != NO_NODE) {
+            pool[pool[v].sibling].prev = prev;
+        }
+        pool[v].sibling = pool[v].prev = NO_NODE;
+    }
+    NodeId mergePairs(NodeId first) { // -> two-pass pairing: meld neighbours left to right, then fold right to left
+        pairs.clear();
+        while (first != NO_NODE) {
+            NodeId a = first, b = pool[a].sibling;
+            first = b == NO_NODE ? NO_NODE : pool[b].sibling;
+            pool[a].sibling = pool[a].prev = NO_NODE;
+            if (b != NO_NODE) {
+                pool[b].sibling = pool[b].prev = NO_NODE;
+            }
+            pairs.push_back(meld(a, b));
+        }
+        NodeId merged = NO_NODE;
+        for (auto it = pairs.rbegin(); it != pairs.rend(); ++it) {
+            merged = meld(*it, merged);
+        }
+        return merged;
+    }
+
+    std::vector<Node> pool; // -> one node per graph node, valid while queued
+    std::vector<std::uint8_t> queued;
+    std::vector<NodeId> pairs;
+    NodeId root = NO_NODE;
+};
+
+class RadixHeap {
+public:
+    void reset(Index) {
+        for (auto& bucket : buckets) {
+            bucket.clear();
+        }
+        last = 0;
+        count = 0;
+    }
+    bool empty() const { return count == 0; }
+
+    void push(NodeId v, Distance key) { // -> key >= last, true of Dijkstra and of A* with a consistent heuristic
+        buckets[bitWidth(key ^ last)].push_back({key, v});
+        count++;
+    }
+
+    NodeId pop(Distance& key) {
+        if (buckets[0].empty()) { // -> the smallest key of the first non-empty bucket becomes `last`, its entries move down
+            int i = 1;
+            while (buckets[i].empty()) {
+                i++;
+            }
+            last = std::min_element(buckets[i].begin(), buckets[i].end())->first;
+            for (const auto& entry : buckets[i]) {
+                buckets[bitWidth(entry.first ^ last)].push_back(entry);
+            }
+            buckets[i].clear();
+        }
+        auto entry = buckets[0].back();
+        buckets[0].pop_back();
+        count--;
+        key = entry.first;
+        return entry.second;
+    }
+
+private:
+    std::vector<std::pair<Distance, NodeId>> buckets[65];
+    Distance last = 0;
+    Index count = 0;
+};
+
+#define PATH_QUEUES(X) \
+    X("binary", DaryHeap<2>) \
+    X("4ary", DaryHeap<4>) \
+    X("pairing", PairingHeap) \
+    X("radix", RadixHeap)
+
+#define PATH_QUEUE_CALL(name, Queue) fn(name, Queue());
+template <typename Fn>
+void forEachPathQueue(Fn fn) { // -> fn(name, Queue()) for every queue type
+    PATH_QUEUES(PATH_QUEUE_CALL)
+}
+#undef PATH_QUEUE_CALL
+
+struct PathSearch { // -> per-node state of one search
+    std::vector<Distance> distance;
+    std::vector<NodeId> parent;
+    std::vector<std::uint8_t> closed;
+
+    void reset(Index nodes) {
+        distance.assign(nodes, UNREACHED);
+        parent.assign(nodes, NO_NODE);
+        closed.assign(nodes, 0);
+    }
+};
+
+struct NoHeuristic {
+    Distance operator()(NodeId) const { return 0; }
+};
+
+struct ManhattanHeuristic { // -> grid distance to the goal times the cheapest step
+    Index width;
+    NodeId goal;
+    Distance step;
+
+    Distance operator()(NodeId v) const {
+        Index dx = Index(v % width) - Index(goal % width), dy = Index(v / width) - Index(goal / width);
+        return Distance(std::abs(dx) + std::abs(dy)) * step;
+    }
+};
+
+ManhattanHeuristic gridHeuristic(const GridMap& map, NodeId goal) {
+    Distance step = 9;
+    for (std::uint8_t cost : map.cost) {
+        step = cost > 0 ? std::min<Distance>(step, cost) : step;
+    }
+    return {map.width, goal, step};
+}
+
+// Settles nodes in order of distance + heuristic until `target` is settled (NO_NODE: every reachable
+// node). Returns the distance of target, or UNREACHED.
+template <typename Queue, typename Heuristic, typename Policy>
+Distance shortestPath(const Graph& g, NodeId source, NodeId target, Heuristic heuristic, Queue& queue, PathSearch& search, Policy& obs) {
+    assert(Index(source) < g.nodes);
+    search.reset(g.nodes);
+    queue.reset(g.nodes);
+    search.distance[source] = 0;
+    queue.push(source, heuristic(source));
+    obs.queued(source);
+    while (!queue.empty()) {
+        Distance key;
+        NodeId u = queue.pop(key);
+        if (search.closed[u]) { // -> a stale entry of a lazy queue
+            continue;
+        }
+        search.closed[u] = 1;
+        obs.settled(u);
+        if (u == target) {
+            break;
+        }
+        if (!obs.proceed()) {
+            return UNREACHED;
+        }
+        Distance base = search.distance[u];
+        for (Index e = g.offsets[u]; e < g.offsets[u + 1]; ++e) {
+            NodeId v = g.targets[e];
+            obs.relaxed(u, v);
+            Distance candidate = base + g.weights[e];
+            if (candidate < search.distance[v]) {
+                search.distance[v] = candidate;
+                search.parent[v] = u;
+                queue.push(v, candidate + heuristic(v));
+                obs.queued(v);
+            }
+        }
+    }
+    return target == NO_NODE ? 0 : search.distance[target];
+}
+
+struct QuietGraphHooks {
+    void queued(NodeId) {}
+    void settled(NodeId) {}
+    void relaxed(NodeId, NodeId) {}
+    bool proceed() { return true; }
+};
+
+struct NativeGraphPolicy : QuietGraphHooks {};
+
+struct CountingGraphPolicy : QuietGraphHooks {
+    unsigned long long pushes = 0; // -> inserts and decrease-keys
+    unsigned long long settles = 0;
+    unsigned long long relaxations = 0;
+    void queued(NodeId) { pushes++; }
+    void settled(NodeId) { settles++; }
+    void relaxed(NodeId, NodeId) { relaxations++; }
+};
+
+// The grid shown in the tree view when a weighted entry is selected. The search thread writes cell
+// states, the render thread reads them; both go through atomics, so neither takes a lock.
+enum class CellState : std::uint8_t { Open, Frontier, Settled, Path, Component, Level }; // -> the last two are colored by label
+
+const int GRID_COLUMNS = 100;
+const int GRID_ROWS = 64;
+const sf::FloatRect GRID_AREA(185, 120, 1000, 640);
+
+struct GridView {
+    GridMap map;
+    Graph graph;
+    NodeId source = 0;
+    NodeId target = 0;
+    bool loaded = false; // -> from --map, kept across resets
+    std::unique_ptr<std::atomic<std::uint8_t>[]> state;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> label; // -> component root or topological level of a cell
+    std::atomic<Index> labels{0}; // -> components found, or levels ordered so far
+    std::atomic<Index> frontier{0};
+    std::atomic<Index> settled{0};
+    std::atomic<unsigned long long> relaxations{0};
+    std::atomic<Distance> cost{UNREACHED};
+    sf::VertexArray cells{sf::Quads};
+};
+
+GridView gridView;
+
+void clearGrid() { // -> back to an unexplored map, the layout stays
+    for (Index cell = 0; cell < gridView.map.cells(); ++cell) {
+        gridView.state[cell] = std::uint8_t(CellState::Open);
+    }
+    gridView.labels = 0;
+    gridView.frontier = 0;
+    gridView.settled = 0;
+    gridView.relaxations = 0;
+    gridView.cost = UNREACHED;
+    sceneDirty = true;
+}
+
+void resetGrid() { // -> a new generated map (a --map file is kept), laid out to fit GRID_AREA
+    if (!gridView.loaded) {
+        gridView.map = makeGridMap(GRID_COLUMNS, GRID_ROWS, nextVisualSeed());
+    }
+    const GridMap& map = gridView.map;
+    gridView.graph = gridGraph(map);
+    gridEndpoints(map, gridView.source, gridView.target);
+    gridView.state.reset(new std::atomic<std::uint8_t>[map.cells()]);
+    gridView.label.reset(new std::atomic<std::uint32_t>[map.cells()]);
+
+    float size = std::min(GRID_AREA.width / map.width, GRID_AREA.height / map.height);
+    gridView.cells.resize(4 * map.cells());
+    for (Index y = 0; y < map.height; ++y) {
+        for (Index x = 0; x < map.width; ++x) {
+            sf::Vertex* quad = &gridView.cells[4 * (y * map.width + x)];
+            float left = GRID_AREA.left + x * size, top = GRID_AREA.top + y * size;
+            quad[0].position = sf::Vector2f(left, top);
+            quad[1].position = sf::Vector2f(left + size, top);
+            quad[2].position = sf::Vector2f(left + size, top + size);
+            quad[3].position = sf::Vector2f(left, top + size);
+        }
+    }
+    clearGrid();
+}
+
+void drawGrid(sf::RenderWindow& window) { // -> recolors the cached quads and draws the whole map in one call
+    const GridMap& map = gridView.map;
+    for (Index cell = 0; cell < map.cells(); ++cell) {
+        sf::Color color;
+        switch (CellState(gridView.state[cell].load(std::memory_order_relaxed))) {
+            case CellState::Open: {
+                sf::Uint8 shade = sf::Uint8(255 - 18 * (map.cost[cell] - 1)); // -> darker is more expensive
+                color = map.cost[cell] == 0 ? sf::Color(70, 70, 70) : sf::Color(shade, shade, shade);
+                break;
+            }
+            case CellState::Frontier: color = sf::Color(255, 165, 0); break;
+            case CellState::Settled: color = sf::Color(100, 149, 237, sf::Uint8(255 - 12 * (map.cost[cell] - 1))); break;
+            case CellState::Path: color = sf::Color::Yellow; break;
+            case CellState::Component: {
+                std::uint64_t hash = SplitMix64::mix(gridView.label[cell]);
+                color = sf::Color(sf::Uint8(80 + hash % 176), sf::Uint8(80 + (hash >> 8) % 176), sf::Uint8(80 + (hash >> 16) % 176));
+                break;
+            }
+            case CellState::Level: {
+                float t = float(gridView.label[cell]) / float(std::max<Index>(1, map.width + map.height - 2)); // -> levels of the grid's DAG run along anti-diagonals
+                color = sf::Color(sf::Uint8(255 * std::min(1.0f, t)), 80, sf::Uint8(255 * (1 - std::min(1.0f, t))));
+                break;
+            }
+        }
+        if (Index(gridView.source) == cell || Index(gridView.target) == cell) {
+            color = Index(gridView.source) == cell ? sf::Color::Green : sf::Color::Red;
+        }
+        for (int corner = 0; corner < 4; ++corner) {
+            gridView.cells[4 * cell + corner].color = color;
+        }
+    }
+    window.draw(gridView.cells);
+}
+
+struct GridVisualPolicy : QuietGraphHooks, RunControl {
+    void queued(NodeId v) {
+        if (gridView.state[v].exchange(std::uint8_t(CellState::Frontier)) == std::uint8_t(CellState::Open)) {
+            gridView.frontier++;
+        }
+    }
+    void settled(NodeId v) {
+        gridView.state[v] = std::uint8_t(CellState::Settled);
+        gridView.frontier--;
+        traceCounter("settled", double(++gridView.settled));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    void relaxed(NodeId, NodeId) {
+        gridView.relaxations++;
+        visualOps++;
+    }
+    bool proceed() const { return RunControl::proceed(); }
+};
+
+template <typename Queue>
+void gridSearch(bool astar) {
+    GridVisualPolicy obs;
+    Queue queue;
+    PathSearch search;
+    const GridView& view = gridView;
+    Distance cost = astar ? shortestPath(view.graph, view.source, view.target, gridHeuristic(view.map, view.target), queue, search, obs)
+                          : shortestPath(view.graph, view.source, view.target, NoHeuristic(), queue, search, obs);
+    if (runGeneration != obs.generation) {
+        return;
+    }
+    for (NodeId v = cost == UNREACHED ? NO_NODE : view.target; v != NO_NODE; v = search.parent[v]) {
+        gridView.state[v] = std::uint8_t(CellState::Path);
+    }
+    gridView.cost = cost;
+    traversalCompleted = true;
+}
+
+template <typename Queue>
+void gridDijkstra(int) {
+    gridSearch<Queue>(false);
+}
+
+template <typename Queue>
+void gridAStar(int) {
+    gridSearch<Queue>(true);
+}
+
+//.....................................| Graph analysis |.....................................//
+// Connected components and a topological order on CSR graphs, generated or loaded from an edge list
+// (--edges), both parallel over parallelFor() chunks of nodes.
+//
+// Components (Afforest, Sutton et al.): a lock-free union-find with one atomic parent per node.
+// linkNodes() always hooks the larger root under the smaller one with a compare-and-swap, so a root is
+// the smallest id of its component and a lost race retries from the new parents. Every node first
+// links along its first COMPONENT_SAMPLES edges and the forest is compressed. A sample of nodes then
+// names the largest component, and the final pass skips the nodes already in it, which on most
+// graphs is nearly all of them. The skip needs every edge in both directions (Graph::symmetric). On
+// a directed graph every node processes all of its edges, and the result is the weak components.
+//
+// Topological order (Kahn): in-degrees are counted with atomic increments, then the nodes of in-degree
+// 0 are processed one level at a time. Each chunk of a level decrements its successors' in-degrees,
+// collects the ones that reach zero in a local buffer and appends it to the order with a single atomic
+// add. Nodes that are never ordered lie on a cycle or behind one.
+//
+// Hooks, called between the parallel phases on the calling thread:
+//   components(parent)  -> the union-find forest after a phase, parent[v] leads towards v's root
+//   level(order, b, e)  -> order[b, e) is the next level of the order
+const Index ANALYSIS_CHUNK = 4096; // -> nodes per parallelFor chunk
+const int COMPONENT_SAMPLES = 2;   // -> edges per node linked before the largest component is picked
+
+typedef std::unique_ptr<std::atomic<NodeId>[]> ParentForest;
+
+bool loadEdgeList(const std::string& path, Graph& g, std::string& error) { // -> "u v [weight]" per line, '#' and '%' start comments
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) {
+        error = "cannot open edge list " + path;
+        return false;
+    }
+    std::vector<std::pair<NodeId, NodeId>> edges;
+    std::vector<std::uint32_t> weights;
+    std::string pending; // -> the unfinished last line of the previous block
+    std::vector<char> block(1 << 20);
+    long long lineNumber = 0;
+    bool ok = true;
+    auto parseLine = [&](const char* line) {
+        lineNumber++;
+        while (*line == ' ' || *line == '\t') {
+            line++;
+        }
+        if (*line == '\0' || *line == '#' || *line == '%' || *line == '\r') {
+            return;
+        }
+        char* end = nullptr;
+        unsigned long long u = std::strtoull(line, &end, 10);
+        const char* cursor = end;
+        unsigned long long v = std::strtoull(cursor, &end, 10);
+        if (end == cursor || u >= NO_NODE || v >= NO_NODE) {
+            error = path + ": bad edge on line " + std::to_string(lineNumber);
+            ok = false;
+            return;
+        }
+        cursor = end;
+        unsigned long long weight = std::strtoull(cursor, &end, 10);
+        edges.push_back({NodeId(u), NodeId(v)});
+        weights.push_back(end == cursor ? 1 : std::uint32_t(std::max(1ULL, weight)));
+    };
+    for (std::size_t got; ok && (got = std::fread(block.data(), 1, block.size(), in)) > 0;) {
+        std::size_t begin = 0;
+        for (std::size_t i = 0; ok && i < got; ++i) {
+            if (block[i] == '\n') {
+                pending.append(block.data() + begin, i - begin);
+                parseLine(pending.c_str());
+                pending.clear();
+                begin = i + 1;
+            }
+        }
+        pending.append(block.data() + begin, got - begin);
+    }
+    std::fclose(in);
+    if (ok && !pending.empty()) {
+        parseLine(pending.c_str());
+    }
+    if (!ok) {
+        return false;
+    }
+    if (edges.empty()) { // -> a graph without nodes has no source to search from
+        error = path + ": no edges";
+        return false;
+    }
+
+    g = Graph();
+    for (const auto& edge : edges) {
+        g.nodes = std::max<Index>(g.nodes, Index(std::max(edge.first, edge.second)) + 1);
+    }
+    g.offsets.assign(g.nodes + 1, 0);
+    for (const auto& edge : edges) {
+        g.offsets[edge.first + 1]++;
+    }
+    for (Index u = 0; u < g.nodes; ++u) {
+        g.offsets[u + 1] += g.offsets[u];
+    }
+    g.targets.resize(edges.size());
+    g.weights.resize(edges.size());
+    std::vector<Index> fill(g.offsets.begin(), g.offsets.end() - 1);
+    for (std::size_t e = 0; e < edges.size(); ++e) { // -> stable, a node's edges keep their file order
+        Index slot = fill[edges[e].first]++;
+        g.targets[slot] = edges[e].second;
+        g.weights[slot] = weights[e];
+    }
+    return true;
+}
+
+Graph acyclicView(const Graph& g) { // -> only the edges to a larger id, which leaves no cycle
+    Graph dag;
+    dag.nodes = g.nodes;
+    dag.width = g.width;
+    dag.offsets.assign(g.nodes + 1, 0);
+    for (Index u = 0; u < g.nodes; ++u) {
+        for (Index e = g.offsets[u]; e < g.offsets[u + 1]; ++e) {
+            if (Index(g.targets[e]) > u) {
+                dag.targets.push_back(g.targets[e]);
+                dag.weights.push_back(g.weights[e]);
+            }
+        }
+        dag.offsets[u + 1] = dag.edges();
+    }
+    return dag;
+}
+
+void linkNodes(std::atomic<NodeId>* parent, NodeId u, NodeId v) {
+    NodeId p1 = parent[u], p2 = parent[v];
+    while (p1 != p2) {
+        NodeId high = std::max(p1, p2), low = std::min(p1, p2);
+        NodeId highParent = parent[high];
+        if (highParent == low) { // -> another thread made the same link
+            return;
+        }
+        if (highParent == high && parent[high].compare_exchange_strong(highParent, low)) {
+            return;
+        }
+        p1 = parent[parent[high]];
+        p2 = parent[low];
+    }
+}
+
+void compressForest(std::atomic<NodeId>* parent, Index n, unsigned threads) { // -> every node points at its root
+    parallelFor((n + ANALYSIS_CHUNK - 1) / ANALYSIS_CHUNK, [&](Index chunk) {
+        for (Index v = chunk * ANALYSIS_CHUNK; v < std::min(n, (chunk + 1) * ANALYSIS_CHUNK); ++v) {
+            while (parent[parent[v]] != parent[v]) {
+                parent[v] = parent[parent[v]].load();
+            }
+        }
+    }, threads);
+}
+
+// Labels every node with the smallest id of its component and returns the number of components.
+template <typename Policy>
+Index connectedComponents(const Graph& g, std::vector<NodeId>& component, unsigned threads, Policy& obs) {
+    const Index n = g.nodes, chunks = (n + ANALYSIS_CHUNK - 1) / ANALYSIS_CHUNK;
+    ParentForest parent(new std::atomic<NodeId>[n]);
+    auto forNodes = [&](auto fn) {
+        parallelFor(chunks, [&](Index chunk) {
+            for (Index v = chunk * ANALYSIS_CHUNK; v < std::min(n, (chunk + 1) * ANALYSIS_CHUNK); ++v) {
+                fn(NodeId(v));
+            }
+        }, threads);
+    };
+    forNodes([&](NodeId v) { parent[v] = v; });
+
+    for (int round = 0; round < COMPONENT_SAMPLES; ++round) {
+        forNodes([&](NodeId v) {
+            if (g.offsets[v] + round < g.offsets[v + 1]) {
+                linkNodes(parent.get(), v, g.targets[g.offsets[v] + round]);
+            }
+        });
+        compressForest(parent.get(), n, threads);
+        obs.components(parent.get());
+    }
+
+    NodeId largest = NO_NODE;
+    if (g.symmetric && n > 0) {
+        SplitMix64 rng(SplitMix64::mix(std::uint64_t(n)));
+        std::unordered_map<NodeId, int> counts;
+        for (int sample = 0; sample < 1024; ++sample) {
+            counts[parent[rng.below(n)]]++;
+        }
+        largest = std::max_element(counts.begin(), counts.end(), [](const auto& a, const auto& b) { return a.second < b.second; })->first;
+    }
+    forNodes([&](NodeId v) {
+        if (parent[v] == largest) {
+            return;
+        }
+        for (Index e = std::min(g.offsets[v] + COMPONENT_SAMPLES, g.offsets[v + 1]); e < g.offsets[v + 1]; ++e) {
+            linkNodes(parent.get(), v, g.targets[e]);
+        }
+    });
+    compressForest(parent.get(), n, threads);
+    obs.components(parent.get());
+
+    component.resize(n);
+    std::atomic<Index> roots(0);
+    parallelFor(chunks, [&](Index chunk) {
+        Index local = 0;
+        for (Index v = chunk * ANALYSIS_CHUNK; v < std::min(n, (chunk + 1) * ANALYSIS_CHUNK); ++v) {
+            component[v] = parent[v];
+            local += component[v] == NodeId(v);
+        }
+        roots += local;
+    }, threads);
+    return roots;
+}
+
+// Writes a topological order of the nodes it can order into `order` (level by level) and returns the
+// number of levels; order.size() < g.nodes means the graph has a cycle.
+template <typename Policy>
+Index topologicalOrder(const Graph& g, std::vector<NodeId>& order, unsigned threads, Policy& obs) {
+    const Index n = g.nodes;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> indegree(new std::atomic<std::uint32_t>[n]);
+    order.resize(n);
+    std::atomic<Index> tail(0);
+    auto append = [&](const std::vector<NodeId>& local) {
+        Index at = tail.fetch_add(Index(local.size()));
+        std::copy(local.begin(), local.end(), order.begin() + at);
+    };
+    parallelFor((n + ANALYSIS_CHUNK - 1) / ANALYSIS_CHUNK, [&](Index chunk) {
+        for (Index v = chunk * ANALYSIS_CHUNK; v < std::min(n, (chunk + 1) * ANALYSIS_CHUNK); ++v) {
+            indegree[v].store(0, std::memory_order_relaxed);
+        }
+    }, threads);
+    parallelFor((n + ANALYSIS_CHUNK - 1) / ANALYSIS_CHUNK, [&](Index chunk) {
+        for (Index e = g.offsets[chunk * ANALYSIS_CHUNK]; e < g.offsets[std::min(n, (chunk + 1) * ANALYSIS_CHUNK)]; ++e) {
+            indegree[g.targets[e]].fetch_add(1, std::memory_order_relaxed);
+        }
+    }, threads);
+    parallelFor((n + ANALYSIS_CHUNK - 1) / ANALYSIS_CHUNK, [&](Index chunk) {
+        std::vector<NodeId> local;
+        for (Index v = chunk * ANALYSIS_CHUNK; v < std::min(n, (chunk + 1) * ANALYSIS_CHUNK); ++v) {
+            if (indegree[v].load(std::memory_order_relaxed) == 0) {
+                local.push_back(NodeId(v));
+            }
+        }
+        append(local);
+    }, threads);
+
+    Index levels = 0;
+    for (Index begin = 0, end = tail; begin < end; begin = end, end = tail) {
+        obs.level(order.data(), begin, end);
+        levels++;
+        parallelFor((end - begin + ANALYSIS_CHUNK - 1) / ANALYSIS_CHUNK, [&](Index chunk) {
+            std::vector<NodeId> local;
+            for (Index i = begin + chunk * ANALYSIS_CHUNK; i < std::min(end, begin + (chunk + 1) * ANALYSIS_CHUNK); ++i) {
+                NodeId u = order[i];
+                for (Index e = g.offsets[u]; e < g.offsets[u + 1]; ++e) {
+                    if (indegree[g.targets[e]].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        local.push_back(g.targets[e]);
+                    }
+                }
+            }
+            append(local);
+        }, threads);
+    }
+    order.resize(tail);
+    return levels;
+}
+
+struct QuietAnalysisHooks {
+    void components(const std::atomic<NodeId>*) {}
+    void level(const NodeId*, Index, Index) {}
+};
+
+struct NativeAnalysisPolicy : QuietAnalysisHooks {};
+
+// Colors the grid view: components by root, levels on a blue to red ramp. Pauses are honoured between
+// phases, a reset cuts the delay short but waits for the (short) parallel phase in flight to return.
+struct GridAnalysisPolicy : QuietAnalysisHooks, RunControl {
+    Index levels = 0;
+
+    void components(const std::atomic<NodeId>* parent) {
+        Index roots = 0;
+        for (Index cell = 0; cell < gridView.map.cells(); ++cell) {
+            if (gridView.map.cost[cell] > 0) {
+                gridView.label[cell] = parent[cell].load();
+                gridView.state[cell] = std::uint8_t(CellState::Component);
+                roots += parent[cell] == NodeId(cell);
+            }
+        }
+        gridView.labels = roots;
+        if (proceed()) {
+            sleep(700);
+        }
+    }
+    void level(const NodeId* order, Index begin, Index end) {
+        for (Index i = begin; i < end; ++i) {
+            if (gridView.map.cost[order[i]] > 0) { // -> walls have no edges and would all sit on level 0
+                gridView.label[order[i]] = std::uint32_t(levels);
+                gridView.state[order[i]] = std::uint8_t(CellState::Level);
+                gridView.settled++;
+            }
+        }
+        gridView.labels = ++levels;
+        visualOps += end - begin;
+        if (proceed()) {
+            sleep(15);
+        }
+    }
+};
+
+void gridComponents(int) {
+    GridAnalysisPolicy obs;
+    std::vector<NodeId> component;
+    connectedComponents(gridView.graph, component, workerCount(), obs);
+    if (runGeneration == obs.generation) {
+        traversalCompleted = true;
+    }
+}
+
+void gridTopological(int) {
+    GridAnalysisPolicy obs;
+    std::vector<NodeId> order;
+    topologicalOrder(acyclicView(gridView.graph), order, workerCount(), obs);
+    if (runGeneration == obs.generation) {
+        traversalCompleted = true;
+    }
+}
+
+//.....................................| Graph generators |.....................................//
+// Seeded graph generators for the graph benchmarks and the traversal tree, selected by name:
+//   grid -> a sqrt(n) x sqrt(n) map from makeGridMap(), 4-connected, weights are the cell costs
+//   tree -> random recursive tree: node v hangs under a uniformly drawn earlier node
+//   kary -> complete k-ary tree (--arity): the children of v are k * v + 1 .. k * v + k
+//   er   -> Erdős–Rényi G(n, p) with p = degree / (n - 1), drawn by geometric skips (Batagelj & Brandes)
+//   rmat -> R-MAT / Kronecker with the Graph500 quadrant odds a, b, c = 0.57, 0.19, 0.19, hubs at low ids
+//   ba   -> Barabási–Albert with degree / 2 edges per node, each edge copying an endpoint of an earlier
+//           edge (Sanders & Schulz): the copied position comes from a hash, not from a sequential state
+// Trees point from parent to child; er, rmat and ba are undirected, every edge stored both ways, with
+// an average degree of --degree. Every generator emits the edges of one chunk at a time from that
+// chunk's stream, and buildGraph() runs it twice, once to count degrees and once to write the edges
+// straight into the CSR arrays, then sorts each adjacency list, so the graph depends on the seed only
+// and not on the thread interleaving. Weights 1..100 are hashed from the endpoints, the same both ways.
+//
+// A generated graph can be cached (--graph-cache DIR): a header and the raw offsets, targets and
+// weights arrays in native byte order, named after the generator and its parameters; a grid adds the
+// cell costs of its map. Reloading is a few fread calls, against seconds of generation for 10^8 edges.
+#define GRAPH_KINDS(X) \
+    X(Grid, "grid") \
+    X(RandomTree, "tree") \
+    X(KaryTree, "kary") \
+    X(ErdosRenyi, "er") \
+    X(Rmat, "rmat") \
+    X(BarabasiAlbert, "ba")
+
+#define GRAPH_KIND_ID(id, name) id,
+#define GRAPH_KIND_NAME(id, name) name,
+enum class GraphKind { GRAPH_KINDS(GRAPH_KIND_ID) Count };
+const char* const graphKindNames[] = { GRAPH_KINDS(GRAPH_KIND_NAME) };
+#undef GRAPH_KIND_ID
+#undef GRAPH_KIND_NAME
+
+bool findGraphKind(const std::string& name, GraphKind& out) {
+    for (std::size_t i = 0; i < std::size_t(GraphKind::Count); ++i) {
+        if (name == graphKindNames[i]) {
+            out = GraphKind(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string graphKindList() { // -> "grid, tree, ..." for error messages
+    std::string list;
+    for (const char* name : graphKindNames) {
+        list += (list.empty() ? "" : ", ") + std::string(name);
+    }
+    return list;
+}
+
+struct GraphParams {
+    Index nodes = 1000;
+    Index degree = 8; // -> er, rmat, ba: average degree
+    Index arity = 2;  // -> kary: children per node
+    std::uint64_t seed = 1;
+};
+
+std::uint32_t edgeWeight(std::uint64_t seed, NodeId u, NodeId v) { // -> 1..100, symmetric in u and v
+    std::uint64_t key = (std::uint64_t(std::min(u, v)) << 32) | std::max(u, v);
+    return std::uint32_t(1 + SplitMix64::mix(seed ^ SplitMix64::mix(key)) % 100);
+}
+
+// emit(chunk, add) calls add(u, v) once for every edge of the chunk and must produce the same edges
+// each time it runs. Degrees are counted with atomic adds, and the second pass claims slots with
+// atomic cursors; a self-loop of a symmetric graph is stored once.
+template <typename Emit>
+Graph buildGraph(Index nodes, Index chunks, bool symmetric, std::uint64_t seed, Emit emit) {
+    Graph g;
+    g.nodes = nodes;
+    g.symmetric = symmetric;
+    std::unique_ptr<std::atomic<Index>[]> cursor(new std::atomic<Index>[nodes + 1]);
+    Index nodeChunks = (nodes + GENERATOR_CHUNK - 1) / GENERATOR_CHUNK;
+    auto forNodes = [&](auto fn) {
+        parallelFor(nodeChunks, [&](Index chunk) {
+            for (Index u = chunk * GENERATOR_CHUNK; u < std::min(nodes, (chunk + 1) * GENERATOR_CHUNK); ++u) {
+                fn(u);
+            }
+        });
+    };
+    forNodes([&](Index u) { cursor[u].store(0, std::memory_order_relaxed); });
+    parallelFor(chunks, [&](Index chunk) {
+        emit(chunk, [&](NodeId u, NodeId v) {
+            cursor[u].fetch_add(1, std::memory_order_relaxed);
+            if (symmetric && u != v) {
+                cursor[v].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    });
+    g.offsets.resize(nodes + 1);
+    forNodes([&](Index u) { g.offsets[u + 1] = cursor[u].load(std::memory_order_relaxed); });
+    degreesToOffsets(g.offsets);
+    forNodes([&](Index u) { cursor[u].store(g.offsets[u], std::memory_order_relaxed); });
+    g.targets.resize(g.offsets.back());
+    g.weights.resize(g.offsets.back());
+    parallelFor(chunks, [&](Index chunk) {
+        emit(chunk, [&](NodeId u, NodeId v) {
+            g.targets[cursor[u].fetch_add(1, std::memory_order_relaxed)] = v;
+            if (symmetric && u != v) {
+                g.targets[cursor[v].fetch_add(1, std::memory_order_relaxed)] = u;
+            }
+        });
+    });
+    forNodes([&](Index u) {
+        std::sort(g.targets.begin() + g.offsets[u], g.targets.begin() + g.offsets[u + 1]);
+        for (Index e = g.offsets[u]; e < g.offsets[u + 1]; ++e) {
+            g.weights[e] = edgeWeight(seed, NodeId(u), g.targets[e]);
+        }
+    });
+    return g;
+}
+
+// The map is returned through `map` for grids, the A* searches need its costs.
+Graph generateGraph(GraphKind kind, const GraphParams& params, GridMap* map = nullptr) {
+    const Index n = std::max<Index>(1, std::min<Index>(params.nodes, Index(NO_NODE) - 1));
+    const std::uint64_t seed = params.seed;
+    auto chunksOf = [](Index items) { return (items + GENERATOR_CHUNK - 1) / GENERATOR_CHUNK; };
+    switch (kind) {
+        case GraphKind::Grid: {
+            Index side = std::max<Index>(2, Index(std::sqrt(double(n))));
+            GridMap grid = makeGridMap(side, side, seed);
+            Graph g = gridGraph(grid);
+            if (map) {
+                *map = std::move(grid);
+            }
+            return g;
+        }
+        case GraphKind::RandomTree:
+            return buildGraph(n, chunksOf(n), false, seed, [&](Index chunk, auto add) {
+                SplitMix64 rng = SplitMix64::stream(seed, std::uint64_t(chunk));
+                for (Index v = std::max<Index>(1, chunk * GENERATOR_CHUNK); v < std::min(n, (chunk + 1) * GENERATOR_CHUNK); ++v) {
+                    add(NodeId(rng.below(std::uint64_t(v))), NodeId(v));
+                }
+            });
+        case GraphKind::KaryTree: {
+            Index arity = std::max<Index>(1, params.arity);
+            return buildGraph(n, chunksOf(n), false, seed, [&](Index chunk, auto add) {
+                for (Index v = std::max<Index>(1, chunk * GENERATOR_CHUNK); v < std::min(n, (chunk + 1) * GENERATOR_CHUNK); ++v) {
+                    add(NodeId((v - 1) / arity), NodeId(v));
+                }
+            });
+        }
+        case GraphKind::ErdosRenyi: {
+            double p = std::min(1.0, double(params.degree) / double(std::max<Index>(1, n - 1)));
+            double skipScale = p < 1.0 ? 1.0 / std::log1p(-p) : 0.0;
+            return buildGraph(n, chunksOf(n), true, seed, [&](Index chunk, auto add) {
+                SplitMix64 rng = SplitMix64::stream(seed, std::uint64_t(chunk));
+                for (Index u = chunk * GENERATOR_CHUNK; u < std::min(n, (chunk + 1) * GENERATOR_CHUNK) && p > 0.0; ++u) {
+                    for (Index v = u + 1;; ++v) { // -> the gap to the next edge u - v, v > u, is geometric
+                        if (p < 1.0) {
+                            double skip = std::floor(std::log1p(-rng.unit()) * skipScale);
+                            v = skip >= double(n) ? n : v + Index(skip);
+                        }
+                        if (v >= n) {
+                            break;
+                        }
+                        add(NodeId(u), NodeId(v));
+                    }
+                }
+            });
+        }
+        case GraphKind::Rmat: {
+            const std::uint32_t RMAT_A = 37356, RMAT_AB = 49807, RMAT_ABC = 62259; // -> 0.57, 0.76, 0.95 of 2^16
+            int scale = bitWidth(std::uint64_t(n - 1));
+            Index edges = n * params.degree / 2;
+            return buildGraph(n, chunksOf(edges), true, seed, [&](Index chunk, auto add) {
+                SplitMix64 rng = SplitMix64::stream(seed, std::uint64_t(chunk));
+                for (Index e = chunk * GENERATOR_CHUNK; e < std::min(edges, (chunk + 1) * GENERATOR_CHUNK); ++e) {
+                    std::uint64_t u, v;
+                    do { // -> drawn on the next power of two, endpoints past n are drawn again
+                        u = v = 0;
+                        std::uint64_t bits = 0;
+                        for (int level = 0; level < scale; ++level, bits >>= 16) {
+                            bits = level % 4 == 0 ? rng.next() : bits; // -> a 16-bit draw per level
+                            std::uint32_t r = std::uint32_t(bits & 0xFFFF);
+                            u = (u << 1) | (r >= RMAT_AB ? 1 : 0);                   // -> quadrant c or d
+                            v = (v << 1) | ((r >= RMAT_A && r < RMAT_AB) || r >= RMAT_ABC ? 1 : 0); // -> quadrant b or d
+                        }
+                    } while (u >= std::uint64_t(n) || v >= std::uint64_t(n));
+                    add(NodeId(u), NodeId(v));
+                }
+            });
+        }
+        case GraphKind::BarabasiAlbert: {
+            Index k = std::max<Index>(1, params.degree / 2);
+            Index edges = n * k; // -> edge j leaves node j / k; position 2j is its source, 2j + 1 its target
+            return buildGraph(n, chunksOf(edges), true, seed, [&](Index chunk, auto add) {
+                for (Index e = chunk * GENERATOR_CHUNK; e < std::min(edges, (chunk + 1) * GENERATOR_CHUNK); ++e) {
+                    std::uint64_t position = 2 * std::uint64_t(e) + 1;
+                    do { // -> a uniform earlier position; a target position is resolved by its own draw
+                        position = SplitMix64::mix(seed ^ SplitMix64::mix(position)) % position;
+                    } while (position & 1);
+                    add(NodeId(e / k), NodeId(position / 2 / std::uint64_t(k)));
+                }
+            });
+        }
+        case GraphKind::Count: break;
+    }
+    return Graph();
+}
+
+struct GraphCacheHeader {
+    char magic[8];
+    std::uint64_t nodes, edges, width, symmetric;
+    std::uint64_t mapCells; // -> cell costs stored after the weights, 0 for a graph without a map
+};
+
+const char GRAPH_CACHE_MAGIC[8] = {'A', 'L', 'G', 'R', 'A', 'P', 'H', '2'};
+
+std::string graphCachePath(const std::string& dir, GraphKind kind, const GraphParams& params) {
+    std::string name = graphKindNames[std::size_t(kind)];
+    name += "-n" + std::to_string((long long)params.nodes) + "-s" + std::to_string((unsigned long long)params.seed);
+    if (kind == GraphKind::ErdosRenyi || kind == GraphKind::Rmat || kind == GraphKind::BarabasiAlbert) {
+        name += "-d" + std::to_string((long long)params.degree);
+    } else if (kind == GraphKind::KaryTree) {
+        name += "-k" + std::to_string((long long)params.arity);
+    }
+    return dir + "/" + name + ".csr";
+}
+
+// -> written to path.tmp and renamed, never left half-written; map, when given, is the grid behind g
+bool saveGraph(const std::string& path, const Graph& g, const GridMap* map = nullptr) {
+    std::string temp = path + ".tmp";
+    std::FILE* out = std::fopen(temp.c_str(), "wb");
+    if (!out) {
+        return false;
+    }
+    GraphCacheHeader header;
+    std::memcpy(header.magic, GRAPH_CACHE_MAGIC, sizeof(header.magic));
+    header.nodes = std::uint64_t(g.nodes);
+    header.edges = std::uint64_t(g.edges());
+    header.width = std::uint64_t(g.width);
+    header.symmetric = g.symmetric ? 1 : 0;
+    header.mapCells = map ? std::uint64_t(map->cost.size()) : 0;
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+              std::fwrite(g.offsets.data(), sizeof(Index), g.offsets.size(), out) == g.offsets.size() &&
+              std::fwrite(g.targets.data(), sizeof(NodeId), g.targets.size(), out) == g.targets.size() &&
+              std::fwrite(g.weights.data(), sizeof(std::uint32_t), g.weights.size(), out) == g.weights.size() &&
+              (!map || std::fwrite(map->cost.data(), 1, map->cost.size(), out) == map->cost.size());
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// -> false for a missing, foreign or truncated file, or one without the map that was asked for
+bool loadGraph(const std::string& path, Graph& g, GridMap* map = nullptr) {
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) {
+        return false;
+    }
+    GraphCacheHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, in) == 1 && std::memcmp(header.magic, GRAPH_CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+              header.nodes < NO_NODE && header.edges < (1ULL << 40) &&
+              (!map || (header.mapCells == header.nodes && header.width > 0));
+    if (ok) {
+        g = Graph();
+        g.nodes = Index(header.nodes);
+        g.width = Index(header.width);
+        g.symmetric = header.symmetric != 0;
+        g.offsets.resize(g.nodes + 1);
+        g.targets.resize(header.edges);
+        g.weights.resize(header.edges);
+        ok = std::fread(g.offsets.data(), sizeof(Index), g.offsets.size(), in) == g.offsets.size() &&
+             std::fread(g.targets.data(), sizeof(NodeId), g.targets.size(), in) == g.targets.size() &&
+             std::fread(g.weights.data(), sizeof(std::uint32_t), g.weights.size(), in) == g.weights.size() &&
+             g.offsets.front() == 0 && g.offsets.back() == g.edges();
+    }
+    if (ok && map) {
+        map->width = g.width;
+        map->height = g.nodes / g.width;
+        map->cost.resize(header.mapCells);
+        ok = std::fread(map->cost.data(), 1, map->cost.size(), in) == map->cost.size();
+    }
+    std::fclose(in);
+    return ok;
+}
+
+void treeFromGraph(const Graph& g) { // -> the traversal tree takes the children lists of a generated tree
+    tree.assign(g.nodes, {});
+    for (Index u = 0; u < g.nodes; ++u) {
+        tree[u].assign(g.targets.begin() + g.offsets[u], g.targets.begin() + g.offsets[u + 1]);
+    }
+}
+
+//.....................................| Online sort |.....................................//
+// Keys arrive one at a time and an ordered buffer keeps them sorted as they come, while a reader
+// takes a view of the sorted order every viewMs. The Stream dropdown and --stream (below) run it.
+//   - B-tree: a B+ tree of sorted leaves of up to STREAM_LEAF keys. Every insert lands in its final
+//     place; a view walks the leaf chain under the lock, so a reader holds up the writer meanwhile.
+//   - LSM: inserts append to a memtable that is sorted into a run once it holds STREAM_MEMTABLE keys;
+//     STREAM_FANOUT runs of one level merge (loser tree) into one run of the next. A view copies the
+//     run pointers and the memtable under the lock and merges them outside of it.
+// Every insert is timed into a histogram; visible throughput is the keys covered by the reader's
+// views per second, up to the view taken once the source has run dry.
+typedef std::int64_t StreamKey;
+typedef std::shared_ptr<const std::vector<StreamKey>> StreamRun;
+const Index STREAM_LEAF = 128;
+const Index STREAM_INNER = 64;
+const Index STREAM_MEMTABLE = 4096;
+const std::size_t STREAM_FANOUT = 4;
+
+class LatencyHistogram { // -> 16 buckets per power of two, so a percentile is off by at most 1/16
+public:
+    void record(std::uint64_t ns) {
+        counts[bucket(ns)]++;
+        total++;
+        largest = std::max(largest, ns);
+    }
+    std::uint64_t percentile(double p) const { // -> upper bound of the bucket holding the p-th percentile
+        std::uint64_t rank = std::max<std::uint64_t>(1, std::uint64_t(std::ceil(p / 100 * double(total)))), seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += counts[b];
+            if (seen >= rank) {
+                return std::min(upper(b), largest);
+            }
+        }
+        return largest;
+    }
+    std::uint64_t count() const { return total; }
+    std::uint64_t max() const { return largest; }
+
+private:
+    static const int SUB = 16;
+    static const int BUCKETS = SUB + 60 * SUB;
+    static int bucket(std::uint64_t ns) {
+        if (ns < SUB) {
+            return int(ns);
+        }
+        int shift = bitWidth(ns) - 5; // -> keeps the leading 1 and four more bits
+        return SUB + shift * SUB + int((ns >> shift) & (SUB - 1));
+    }
+    static std::uint64_t upper(int b) {
+        if (b < SUB) {
+            return std::uint64_t(b);
+        }
+        int shift = (b - SUB) / SUB;
+        return ((std::uint64_t(SUB + (b - SUB) % SUB) + 1) << shift) - 1;
+    }
+    std::uint64_t counts[BUCKETS] = {};
+    std::uint64_t total = 0;
+    std::uint64_t largest = 0;
+};
+
+struct StreamOptions {
+    std::string source = "gen";
+    std::vector<std::string> buffers; // -> empty means every buffer
+    double rate = 0;
+    Index n = 1000000;          // -> keys replayed by gen
+    std::uint64_t range = 1ULL << 30;
+    Distribution distribution = Distribution::Uniform;
+    std::uint64_t seed = 1;
+    int viewMs = 50;
+    int reportMs = 1000;        // -> progress line interval, 0 for none
+};
+
+class StreamSource {
+public:
+    StreamSource() = default;
+    StreamSource(const StreamSource&) = delete;
+    StreamSource& operator=(const StreamSource&) = delete;
+    ~StreamSource() {
+        if (file != nullptr && file != stdin) {
+            std::fclose(file);
+        }
+    }
+
+    bool open(const StreamOptions& options, std::string& error) {
+        if (options.source == "gen") {
+            GeneratorParams params;
+            params.seed = options.seed;
+            params.range = options.range;
+            std::vector<std::uint64_t> keys(options.n);
+            generateInput<UInt64Kind>(keys.data(), options.n, options.distribution, params);
+            generated.assign(keys.begin(), keys.end());
+            return true;
+        }
+        file = options.source == "-" ? stdin : std::fopen(options.source.c_str(), "r");
+        if (file == nullptr) {
+            error = "cannot open " + options.source + ": " + std::strerror(errno);
+            return false;
+        }
+        return true;
+    }
+    void replay(const std::vector<StreamKey>& keys) { generated = keys; } // -> instead of open(): replays keys another source recorded
+    void record(std::vector<StreamKey>* keys) { recording = keys; }     // -> keep every key read from the file or stdin
+
+    bool next(StreamKey& key) { // -> false at the end of the source
+        if (file == nullptr) {
+            if (at == Index(generated.size())) {
+                return false;
+            }
+            key = generated[at++];
+            return true;
+        }
+        for (;;) {
+            for (; pos < end; ++pos) { // -> digits accumulate, anything else ends a number; fgets hands out
+                char c = chunk[pos];   //    what a pipe has delivered up to a newline, so keys flow as written
+                if (c >= '0' && c <= '9') {
+                    value = value * 10 + (c - '0');
+                    digits = true;
+                } else if (digits) {
+                    pos++;
+                    return emit(key);
+                } else {
+                    negative = c == '-';
+                }
+            }
+            if (std::fgets(chunk, sizeof(chunk), file) == nullptr) {
+                return digits && emit(key);
+            }
+            pos = 0;
+            end = std::strlen(chunk);
+        }
+    }
+
+private:
+    bool emit(StreamKey& key) {
+        key = negative ? -value : value;
+        value = 0;
+        digits = negative = false;
+        if (recording) {
+            recording->push_back(key);
+        }
+        return true;
+    }
+
+    std::vector<StreamKey> generated;
+    std::vector<StreamKey>* recording = nullptr;
+    Index at = 0;
+    std::FILE* file = nullptr;
+    char chunk[1 << 12];
+    std::size_t pos = 0, end = 0;
+    StreamKey value = 0;
+    bool digits = false, negative = false;
+};
+
+// Both buffers take inserts from one writer thread while one reader calls view() and sorted().
+class BTreeBuffer {
+public:
+    BTreeBuffer() { leaves.emplace_back(); }
+
+    void insert(StreamKey key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::int32_t path[32];
+        int slots[32];
+        std::int32_t node = root;
+        for (int level = height; level > 0; --level) { // -> equal keys go right, after the ones already there
+            Inner& inner = inners[node];
+            slots[level] = int(std::upper_bound(inner.separators, inner.separators + inner.count - 1, key) - inner.separators);
+            path[level] = node;
+            node = inner.children[slots[level]];
+        }
+        Leaf& leaf = leaves[node];
+        Index at = std::upper_bound(leaf.keys, leaf.keys + leaf.count, key) - leaf.keys;
+        std::copy_backward(leaf.keys + at, leaf.keys + leaf.count, leaf.keys + leaf.count + 1);
+        leaf.keys[at] = key;
+        total++;
+        if (++leaf.count < STREAM_LEAF) {
+            return;
+        }
+
+        // A full leaf hands its upper half to a new right neighbour, whose first key goes up as the
+        // separator; a full inner node splits the same way, up to a new root. An append to the
+        // rightmost leaf moves only the new key, so ascending streams leave full leaves behind.
+        Index keep = at == leaf.count - 1 && leaf.next < 0 ? leaf.count - 1 : STREAM_LEAF / 2;
+        std::int32_t child = std::int32_t(leaves.size());
+        leaves.emplace_back(); // -> a deque, so `leaf` stays valid
+        Leaf& right = leaves.back();
+        right.count = leaf.count - keep;
+        std::copy(leaf.keys + keep, leaf.keys + leaf.count, right.keys);
+        leaf.count = keep;
+        right.next = leaf.next;
+        leaf.next = child;
+        StreamKey separator = right.keys[0];
+        for (int level = 1; level <= height; ++level) {
+            Inner& inner = inners[path[level]];
+            int slot = slots[level];
+            std::copy_backward(inner.separators + slot, inner.separators + inner.count - 1, inner.separators + inner.count);
+            std::copy_backward(inner.children + slot + 1, inner.children + inner.count, inner.children + inner.count + 1);
+            inner.separators[slot] = separator;
+            inner.children[slot + 1] = child;
+            if (++inner.count < STREAM_INNER) {
+                return;
+            }
+            const Index half = STREAM_INNER / 2;
+            child = std::int32_t(inners.size());
+            inners.emplace_back();
+            Inner& sibling = inners.back();
+            sibling.count = inner.count - half;
+            std::copy(inner.children + half, inner.children + inner.count, sibling.children);
+            std::copy(inner.separators + half, inner.separators + inner.count - 1, sibling.separators);
+            separator = inner.separators[half - 1];
+            inner.count = half;
+        }
+        inners.emplace_back();
+        Inner& top = inners.back();
+        top.count = 2;
+        top.children[0] = root;
+        top.children[1] = child;
+        top.separators[0] = separator;
+        root = std::int32_t(inners.size() - 1);
+        height++;
+    }
+
+    Index view(Index samples, std::vector<StreamKey>& out) { // -> `samples` evenly spaced keys of the sorted order, returns the keys covered
+        std::lock_guard<std::mutex> lock(mutex);
+        out.clear();
+        Index base = 0, s = 0;
+        for (std::int32_t leaf = 0; leaf >= 0 && total > 0; leaf = leaves[leaf].next) { // -> leaf 0 stays leftmost
+            const Leaf& current = leaves[leaf];
+            for (Index rank; s < samples && (rank = sampleRank(s, samples, total)) < base + current.count; ++s) {
+                out.push_back(current.keys[rank - base]);
+            }
+            base += current.count;
+        }
+        return total;
+    }
+
+    void sorted(std::vector<StreamKey>& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        out.clear();
+        for (std::int32_t leaf = 0; leaf >= 0; leaf = leaves[leaf].next) {
+            out.insert(out.end(), leaves[leaf].keys, leaves[leaf].keys + leaves[leaf].count);
+        }
+    }
+
+    std::string shape() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return "height " + std::to_string(height + 1) + ", " + std::to_string(leaves.size()) + " leaves";
+    }
+
+    static Index sampleRank(Index s, Index samples, Index total) {
+        return samples > 1 ? s * (total - 1) / (samples - 1) : 0;
+    }
+
+private:
+    struct Leaf {
+        Index count = 0;
+        std::int32_t next = -1;
+        StreamKey keys[STREAM_LEAF];
+    };
+    struct Inner {
+        Index count = 0; // -> children in use, one more than the separators
+        StreamKey separators[STREAM_INNER - 1];
+        std::int32_t children[STREAM_INNER];
+    };
+
+    std::mutex mutex;
+    std::deque<Leaf> leaves;
+    std::deque<Inner> inners;
+    std::int32_t root = 0; // -> a leaf while height is 0
+    int height = 0;
+    Index total = 0;
+};
+
+template <typename Emit>
+void mergeStreamRuns(const std::vector<StreamRun>& runs, Emit emit) { // -> emit(key) in sorted order
+    std::vector<std::size_t> heads(runs.size(), 0);
+    LoserTree tree;
+    tree.reset(runs.size());
+    auto less = [&](std::size_t x, std::size_t y) { return (*runs[x])[heads[x]] < (*runs[y])[heads[y]]; };
+    for (std::size_t s = 0; s < runs.size(); ++s) {
+        if (runs[s]->empty()) {
+            tree.exhaust(s);
+        }
+    }
+    tree.build(less);
+    while (!tree.empty()) {
+        std::size_t winner = tree.winner();
+        emit((*runs[winner])[heads[winner]]);
+        if (++heads[winner] == runs[winner]->size()) {
+            tree.exhaust(winner);
+        }
+        tree.replay(less);
+    }
+}
+
+class LsmBuffer {
+public:
+    LsmBuffer() { memtable.reserve(STREAM_MEMTABLE); }
+
+    void insert(StreamKey key) {
+        std::unique_lock<std::mutex> lock(mutex);
+        memtable.push_back(key);
+        if (Index(memtable.size()) < STREAM_MEMTABLE) {
+            return;
+        }
+        std::sort(memtable.begin(), memtable.end()); // -> under the lock, a view must see these keys somewhere
+        auto run = std::make_shared<std::vector<StreamKey>>(std::move(memtable));
+        memtable.clear();
+        memtable.reserve(STREAM_MEMTABLE);
+        levels.resize(std::max<std::size_t>(levels.size(), 1));
+        levels[0].push_back(run);
+        runs++;
+
+        // Only this thread changes the levels, so a full level is merged without the lock while views
+        // keep reading its runs, and swapped for the merged run afterwards.
+        for (std::size_t level = 0; level < levels.size() && levels[level].size() == STREAM_FANOUT; ++level) {
+            std::vector<StreamRun> full = levels[level];
+            lock.unlock();
+            auto merged = std::make_shared<std::vector<StreamKey>>();
+            std::size_t size = 0;
+            for (const auto& part : full) {
+                size += part->size();
+            }
+            merged->reserve(size);
+            mergeStreamRuns(full, [&](StreamKey k) { merged->push_back(k); });
+            lock.lock();
+            levels.resize(std::max(levels.size(), level + 2));
+            levels[level].clear();
+            levels[level + 1].push_back(merged);
+            runs -= STREAM_FANOUT - 1;
+            merges++;
+        }
+    }
+
+    Index view(Index samples, std::vector<StreamKey>& out) {
+        std::vector<StreamRun> snapshot = grab();
+        Index total = 0;
+        for (const auto& run : snapshot) {
+            total += Index(run->size());
+        }
+        out.clear();
+        Index rank = 0, s = 0, next = BTreeBuffer::sampleRank(0, samples, total);
+        mergeStreamRuns(snapshot, [&](StreamKey key) { // -> merge on read, only the sampled ranks are kept
+            for (; s < samples && next == rank; next = BTreeBuffer::sampleRank(++s, samples, total)) {
+                out.push_back(key);
+            }
+            rank++;
+        });
+        return total;
+    }
+
+    void sorted(std::vector<StreamKey>& out) {
+        std::vector<StreamRun> snapshot = grab();
+        out.clear();
+        mergeStreamRuns(snapshot, [&](StreamKey key) { out.push_back(key); });
+    }
+
+    std::string shape() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::to_string(runs) + " runs in " + std::to_string(levels.size()) + " levels, " + std::to_string(merges) + " merges";
+    }
+
+private:
+    std::vector<StreamRun> grab() { // -> the runs and a sorted copy of the memtable
+        std::vector<StreamRun> snapshot;
+        std::shared_ptr<std::vector<StreamKey>> recent;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& level : levels) {
+                snapshot.insert(snapshot.end(), level.begin(), level.end());
+            }
+            recent = std::make_shared<std::vector<StreamKey>>(memtable);
+        }
+        std::sort(recent->begin(), recent->end());
+        snapshot.push_back(recent);
+        return snapshot;
+    }
+
+    std::mutex mutex;
+    std::vector<StreamKey> memtable;
+    std::vector<std::vector<StreamRun>> levels;
+    Index runs = 0;
+    Index merges = 0;
+};
+
+struct StreamStatus { // -> published by the ingest and reader threads for the window and the progress lines
+    std::atomic<long long> inserted{0};
+    std::atomic<long long> visible{0};
+    std::atomic<long long> p50Ns{0};
+    std::atomic<long long> p99Ns{0};
+    std::atomic<double> keysPerSecond{0};
+
+    void clear() {
+        inserted = 0;
+        visible = 0;
+        p50Ns = 0;
+        p99Ns = 0;
+        keysPerSecond = 0;
+    }
+};
+
+struct StreamReport {
+    Index inserted = 0;
+    double ingestSeconds = 0;
+    double visibleSeconds = 0; // -> when the view after the last insert was ready
+    double behindMs = 0;       // -> furthest the ingest fell behind the --rate schedule
+    LatencyHistogram latency;
+    Index views = 0;
+    double viewMsTotal = 0;
+    double viewMsMax = 0;
+    std::string shape;
+    bool sorted = true;
+};
+
+typedef std::function<void(const std::vector<StreamKey>& samples, Index visible)> StreamViewFn;
+
+// Ingests `source` into a fresh Buffer on this thread while a reader thread takes a view of
+// `samples` quantiles every --view-ms. A non-null control makes the run pausable and resettable.
+template <typename Buffer>
+StreamReport runStream(StreamSource& source, const StreamOptions& options, Index samples, const RunControl* control,
+                       StreamStatus& status, const StreamViewFn& onView) {
+    typedef std::chrono::steady_clock Clock;
+    Buffer buffer;
+    StreamReport report;
+    std::vector<StreamKey> ingested; // -> for the final check
+    std::mutex doneMutex;
+    std::condition_variable doneSignal;
+    bool done = false;
+    auto start = Clock::now();
+    auto seconds = [&](Clock::time_point t) { return std::chrono::duration<double>(t - start).count(); };
+
+    std::thread reader([&] {
+        traceThreadName("stream reader");
+        std::vector<StreamKey> view;
+        for (;;) {
+            bool last;
+            {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                last = done;
+            }
+            auto viewStart = Clock::now();
+            Index visible = buffer.view(samples, view);
+            auto viewEnd = Clock::now();
+            double ms = std::chrono::duration<double, std::milli>(viewEnd - viewStart).count();
+            report.views++;
+            report.viewMsTotal += ms;
+            report.viewMsMax = std::max(report.viewMsMax, ms);
+            status.visible = visible;
+            onView(view, visible);
+            if (last) {
+                report.visibleSeconds = seconds(viewEnd);
+                return;
+            }
+            std::unique_lock<std::mutex> lock(doneMutex);
+            doneSignal.wait_until(lock, viewStart + std::chrono::milliseconds(options.viewMs), [&] { return done; });
+        }
+    });
+
+    StreamKey key;
+    Clock::duration paused(0);
+    Clock::time_point published = start - std::chrono::seconds(1); // -> the first insert publishes at once
+    while (source.next(key)) {
+        if (options.rate > 0) { // -> keys go in bursts of at most a millisecond rather than one sleep each
+            auto due = start + paused + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(double(report.inserted) / options.rate));
+            auto now = Clock::now();
+            for (; due - now > std::chrono::milliseconds(1); now = Clock::now()) {
+                std::this_thread::sleep_until(std::min(due, now + std::chrono::milliseconds(20)));
+                if (control != nullptr && runGeneration != control->generation) {
+                    break;
+                }
+            }
+            report.behindMs = std::max(report.behindMs, std::chrono::duration<double, std::milli>(now - due).count());
+        }
+        if (control != nullptr) {
+            auto before = Clock::now();
+            if (!control->proceed()) {
+                break;
+            }
+            paused += Clock::now() - before; // -> a pause moves the schedule along
+        }
+        auto insertStart = Clock::now();
+        buffer.insert(key);
+        auto insertEnd = Clock::now();
+        report.latency.record(std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(insertEnd - insertStart).count()));
+        ingested.push_back(key);
+        status.inserted = ++report.inserted;
+        if (insertEnd - published >= std::chrono::milliseconds(20)) {
+            published = insertEnd;
+            status.p50Ns = (long long)report.latency.percentile(50);
+            status.p99Ns = (long long)report.latency.percentile(99);
+            status.keysPerSecond = double(report.inserted) / std::max(seconds(insertEnd), 1e-9);
+        }
+    }
+    report.ingestSeconds = seconds(Clock::now());
+    {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done = true;
+    }
+    doneSignal.notify_all();
+    reader.join();
+
+    status.p50Ns = (long long)report.latency.percentile(50);
+    status.p99Ns = (long long)report.latency.percentile(99);
+    status.keysPerSecond = double(report.inserted) / std::max(report.ingestSeconds, 1e-9);
+    std::vector<StreamKey> result;
+    buffer.sorted(result);
+    std::sort(ingested.begin(), ingested.end());
+    report.sorted = result == ingested;
+    report.shape = buffer.shape();
+    return report;
+}
+
+enum class StreamBufferId { BTree, Lsm, Count };
+
+struct StreamBufferEntry {
+    StreamBufferId id;
+    const char* name;
+    const char* label;
+    StreamReport (*run)(StreamSource&, const StreamOptions&, Index, const RunControl*, StreamStatus&, const StreamViewFn&);
+};
+
+const StreamBufferEntry streamBufferRegistry[] = {
+    {StreamBufferId::BTree, "btree", "B-tree Stream", runStream<BTreeBuffer>},
+    {StreamBufferId::Lsm, "lsm", "LSM Stream", runStream<LsmBuffer>},
+};
+
+static_assert(sizeof(streamBufferRegistry) / sizeof(streamBufferRegistry[0]) == std::size_t(StreamBufferId::Count), "one registry row per StreamBufferId");
+
+const StreamBufferEntry& streamBufferEntry(StreamBufferId id) {
+    return streamBufferRegistry[std::size_t(id)];
+}
+
+//.....................................| Tree traversal functions |.....................................//
+// Both traversals publish into `traversal` and hold no lock, so the window keeps drawing and a reset
+// interrupts the 500 ms step delay at once.
+void bfs(int start) {
+    RunControl control;
+
+    std::queue<int> q;
+    q.push(start);
+    traversal.discover(start);
+    while (!q.empty()) {
+        int node = q.front();
+        q.pop();
+        traversal.expand(node, sf::Color::Green);
+        if (!control.sleep(500)) {
+            return;
+        }
+        if (node == targetNode) {
+            traversalCompleted = true;
+            return;
+        }
+        for (int neighbor : tree[node]) {
+            if (traversal.discover(neighbor)) {
+                q.push(neighbor);
+            }
+        }
+        if (!control.proceed()) {
+            return;
+        }
+    }
+    traversalCompleted = true;
+    isTreeTraversal = false;
+}
+
+void dfs(int start) {
+    RunControl control;
+
+    std::stack<int> s;
+    s.push(start);
+    traversal.discover(start);
+    while (!s.empty()) {
+        int node = s.top();
+        s.pop();
+        traversal.expand(node, sf::Color::Blue);
+        if (!control.sleep(500)) {
+            return;
+        }
+        if (node == targetNode) {
+            traversalCompleted = true;
+            return;
+        }
+        for (int neighbor : tree[node]) {
+            if (traversal.discover(neighbor)) {
+                s.push(neighbor);
+            }
+        }
+        if (!control.proceed()) {
+            return;
+        }
+    }
+    traversalCompleted = true;
+    isTreeTraversal = false;
+}
+
+struct TraversalEntry {
+    TraversalId id;
+    const char* name;
+    const char* label;
+    void (*run)(int start);
+    bool grid; // -> runs on the weighted grid map instead of the tree
+};
+
+const TraversalEntry traversalRegistry[] = {
+    {TraversalId::Bfs, "bfs", "BFS", bfs, false},
+    {TraversalId::Dfs, "dfs", "DFS", dfs, false},
+    {TraversalId::Dijkstra, "dijkstra", "Dijkstra Heap", gridDijkstra<DaryHeap<2>>, true},
+    {TraversalId::Dijkstra4, "dijkstra-4ary", "Dijkstra 4-ary", gridDijkstra<DaryHeap<4>>, true},
+    {TraversalId::DijkstraPairing, "dijkstra-pairing", "Dijkstra Pair", gridDijkstra<PairingHeap>, true},
+    {TraversalId::DijkstraRadix, "dijkstra-radix", "Dijkstra Radix", gridDijkstra<RadixHeap>, true},
+    {TraversalId::AStar, "astar", "A* Search", gridAStar<DaryHeap<2>>, true},
+    {TraversalId::Components, "components", "Components", gridComponents, true},
+    {TraversalId::Topological, "topo", "Topo Levels", gridTopological, true},
+};
+
+static_assert(sizeof(traversalRegistry) / sizeof(traversalRegistry[0]) == std::size_t(TraversalId::Count), "one registry row per TraversalId");
+
+const TraversalEntry& traversalEntry(TraversalId id) {
+    return traversalRegistry[std::size_t(id)];
+}
+
+SortId currentSort = SortId::Bubble;
+SearchId currentSearch = SearchId::Linear;
+TraversalId currentTraversal = TraversalId::Bfs;
+SelectId currentSelect = SelectId::Quick;
+const Index VISUAL_SELECT_K = NUM_BARS / 8; // -> the window picks out the 30 shortest bars
+StreamBufferId currentStream = StreamBufferId::BTree;
+StreamStatus streamStatus;
+std::string visualStreamSource = "gen"; // -> --source in the window
+double visualStreamRate = 2000;         // -> --rate in the window, keys per second
+const Index VISUAL_STREAM_KEYS = 60000; // -> half a minute of generated keys at the default rate
+
+//.....................................| Init. funcs |.....................................//
+// These run on currentThread. They only finish the bookkeeping when the run was not abandoned by resetAll().
+void startSorting() {
+    traceThreadName("algorithm");
+    TraceSpan span(sortEntry(currentSort).label, "run");
+    SortVisualPolicy obs;
+    resetScratchStats();
+    streamSnapshot(array.data(), NUM_BARS, sortEntry(currentSort).label);
+    sortFunction<int, SortVisualPolicy>(currentSort)(array.data(), NUM_BARS, obs);
+    if (runGeneration == obs.generation) {
+        isArraySorted = true;
+    }
+    sceneDirty = true;
+    isSorting = false;
+}
+
+void startSelecting() {
+    traceThreadName("algorithm");
+    TraceSpan span(selectEntry(currentSelect).label, "run");
+    SortVisualPolicy obs;
+    resetScratchStats();
+    streamSnapshot(array.data(), NUM_BARS, selectEntry(currentSelect).label);
+    selectFunction<int, SortVisualPolicy>(currentSelect)(array.data(), NUM_BARS, VISUAL_SELECT_K, obs);
+    if (runGeneration == obs.generation) { // -> the k smallest stay green at the front
+        obs.region(0, NUM_BARS, -1);
+        obs.region(0, VISUAL_SELECT_K, 1);
+    }
+    sceneDirty = true;
+    isSorting = false;
+}
+
+void startStreaming() {
+    traceThreadName("algorithm");
+    TraceSpan span(streamBufferEntry(currentStream).label, "run");
+    RunControl control;
+    StreamOptions options;
+    options.source = visualStreamSource;
+    options.rate = visualStreamRate;
+    options.n = VISUAL_STREAM_KEYS;
+    options.range = 651;
+    options.distribution = visualDistribution;
+    options.seed = nextVisualSeed();
+    StreamSource source;
+    std::string error;
+    if (source.open(options, error)) {
+        streamStatus.clear();
+        for (int i = 0; i < NUM_BARS; ++i) { // -> the view starts empty
+            array[i] = 0;
+            bars[i].setSize(sf::Vector2f(BAR_WIDTH, 0));
+        }
+        sceneDirty = true;
+        // Every view redraws the bars as NUM_BARS quantiles of the sorted order, scaled to its range.
+        streamBufferEntry(currentStream).run(source, options, NUM_BARS, &control, streamStatus, [&](const std::vector<StreamKey>& samples, Index) {
+            if (runGeneration != control.generation || samples.empty()) {
+                return;
+            }
+            double low = double(samples.front()), range = std::max(1.0, double(samples.back()) - low);
+            for (int i = 0; i < NUM_BARS; ++i) {
+                array[i] = 50 + int((double(samples[i]) - low) * 650 / range);
+                bars[i].setSize(sf::Vector2f(BAR_WIDTH, array[i]));
+                bars[i].setPosition(i * BAR_WIDTH, WINDOW_HEIGHT - array[i]);
+            }
+            visualOps++;
+            sceneDirty = true;
+        });
+    } else {
+        std::cerr << error << "\n";
+    }
+    sceneDirty = true;
+    isSorting = false;
+}
+
+void startSearching() {
+    traceThreadName("algorithm");
+    TraceSpan span(searchEntry(currentSearch).label, "run");
+    SearchVisualPolicy obs;
+    searchFunction<int, SearchVisualPolicy>(currentSearch)(searchArray.data(), MAX_ARRAY_SIZE, searchValue, obs);
+    if (runGeneration == obs.generation) {
+        searchCompleted = true;
+    }
+    sceneDirty = true;
+    isSearching = false;
+}
+
+void startTreeTraversal() {
+    traceThreadName("algorithm");
+    TraceSpan span(traversalEntry(currentTraversal).label, "run");
+    traversalEntry(currentTraversal).run(0);
+    sceneDirty = true;
+    isTreeTraversal = false;
+}
+
+void resetAll() {
+    TraceSpan span("resetAll", "control");
+    runGeneration++; // -> the running algorithm notices at its next proceed() or sleep() and returns
+    wakeRuns();
+
+    if (currentThread.joinable()) {
+        TraceSpan join("join run thread", "control");
+        currentThread.join();
+    }
+
+    isSorting = false;
+    isSearching = false;
+    isTreeTraversal = false;
+    isPaused = false;
+    searchCompleted = false;
+    traversalCompleted = false;
+    if (visualizationType == "sort") {
+        resetArray();
+        autoDecision.choice = -1;
+    } else if (visualizationType == "select" || visualizationType == "stream") {
+        resetArray();
+        streamStatus.clear();
+    } else if (visualizationType == "tree") {
+        resetTree();
+        resetGrid();
+    } else if (visualizationType == "search") {
+        resetSearchArray();
+    }
+}
+
+//.....................................| UI widgets |.....................................//
+// The whole toolbar and the dropdown entries live in one table; a click walks it once and the
+// static chrome is rendered into an off-screen texture that is only refreshed when something changes.
+const sf::Color PASTEL_GREEN(144, 238, 144);
+const sf::Color PASTEL_PINK(255, 182, 193);
+const sf::Color PASTEL_ORANGE(255, 160, 122);
+const sf::Color PASTEL_BLUE(173, 216, 230);
+const sf::Color PASTEL_PURPLE(221, 160, 221);
+const sf::Color PASTEL_PEACH(255, 218, 185);
+
+struct Widget {
+    std::string id;
+    sf::FloatRect bounds;
+    std::string label;
+    std::string mode; // -> "" for the always visible toolbar, otherwise the visualization whose dropdown owns it
+    sf::Color color;
+    std::function<void()> action;
+};
+
+std::vector<Widget> widgets;
+sf::RenderTexture chromeTexture;
+bool uiDirty = true;
+sf::Text algorithmText;
+sf::Text searchValueText;
+sf::Text targetNodeText;
+
+void startRun() {
+    if (isSorting || isSearching || isTreeTraversal) {
+        return;
+    }
+    if (currentThread.joinable()) { // -> the previous run has already finished, just collect it
+        TraceSpan join("join run thread", "control");
+        currentThread.join();
+    }
+    if (visualizationType == "sort") {
+        isSorting = true;
+        currentThread = std::thread(startSorting);
+    } else if (visualizationType == "select") {
+        isSorting = true;
+        currentThread = std::thread(startSelecting);
+    } else if (visualizationType == "stream") {
+        isSorting = true;
+        currentThread = std::thread(startStreaming);
+    } else if (visualizationType == "search") {
+        isSearching = true;
+        searchValue = searchArray[rand() % MAX_ARRAY_SIZE];
+        searchCompleted = false;
+        currentThread = std::thread(startSearching);
+    } else if (visualizationType == "tree") {
+        resetTree();
+        clearGrid();
+        isTreeTraversal = true;
+        targetNode = rand() % tree.size();
+        traversalCompleted = false;
+        currentThread = std::thread(startTreeTraversal);
+    }
+}
+
+void selectVisualization(const std::string& type, const std::string& defaultAlgorithm) {
+    visualizationType = type;
+    currentAlgorithm = defaultAlgorithm;
+    showDropdown = true;
+}
+
+void selectAlgorithm(const std::string& name) {
+    currentAlgorithm = name;
+    showDropdown = false;
+}
+
+void addWidget(const std::string& id, float x, float y, float width, const std::string& label,
+               const std::string& mode, const sf::Color& color, std::function<void()> action) {
+    widgets.push_back({id, sf::FloatRect(x, y, width, 50), label, mode, color, std::move(action)});
+}
+
+void initWidgets() {
+    addWidget("start", 10, 50, 100, "Start", "", PASTEL_GREEN, startRun);
+    addWidget("pause", 120, 50, 100, "Pause", "", PASTEL_PINK, [] {
+        if (isSorting || isSearching || isTreeTraversal) {
+            isPaused = !isPaused;
+            wakeRuns();
+        }
+    });
+    addWidget("reset", 230, 50, 100, "Reset", "", PASTEL_ORANGE, resetAll);
+    addWidget("sort", 10, 110, 150, "Sort", "", PASTEL_BLUE, [] {
+        currentSort = SortId::Bubble;
+        selectVisualization("sort", sortEntry(currentSort).name);
+    });
+    addWidget("search", 10, 170, 150, "Search", "", PASTEL_PURPLE, [] {
+        currentSearch = SearchId::Linear;
+        selectVisualization("search", searchEntry(currentSearch).name);
+    });
+    addWidget("tree", 10, 230, 150, "Tree", "", PASTEL_PEACH, [] {
+        currentTraversal = TraversalId::Bfs;
+        selectVisualization("tree", traversalEntry(currentTraversal).name);
+    });
+    addWidget("select", 170, 110, 150, "Select", "", PASTEL_GREEN, [] {
+        currentSelect = SelectId::Quick;
+        selectVisualization("select", selectEntry(currentSelect).name);
+    });
+    addWidget("stream", 170, 170, 150, "Stream", "", PASTEL_ORANGE, [] {
+        currentStream = StreamBufferId::BTree;
+        selectVisualization("stream", streamBufferEntry(currentStream).name);
+    });
+
+    // Dropdowns are generated from the algorithm registries, stacked from y = 290 in columns of
+    // ten (eight for the tree, whose labels sit lower) and colored by walking the pastel palette
+    // from a per-dropdown offset.
+    const sf::Color palette[] = {PASTEL_BLUE, PASTEL_PURPLE, PASTEL_PINK, PASTEL_GREEN, PASTEL_ORANGE};
+    int row = 0;
+    for (const auto& entry : sortRegistry) {
+        SortId id = entry.id;
+        addWidget(entry.name, 10 + (row / 10) * 160, 290 + (row % 10) * 60, 150, entry.label, "sort", palette[row % 5], [id] {
+            currentSort = id;
+            selectAlgorithm(sortEntry(id).name);
+        });
+        row++;
+    }
+    row = 0;
+    for (const auto& entry : searchRegistry) {
+        SearchId id = entry.id;
+        addWidget(entry.name, 10, 290 + row * 60, 150, entry.label, "search", palette[(row + 4) % 5], [id] {
+            currentSearch = id;
+            selectAlgorithm(searchEntry(id).name);
+        });
+        row++;
+    }
+    row = 0;
+    for (const auto& entry : selectRegistry) {
+        SelectId id = entry.id;
+        addWidget(entry.name, 10, 290 + row * 60, 150, entry.label, "select", palette[(row + 2) % 5], [id] {
+            currentSelect = id;
+            selectAlgorithm(selectEntry(id).name);
+        });
+        row++;
+    }
+    row = 0;
+    for (const auto& entry : streamBufferRegistry) {
+        StreamBufferId id = entry.id;
+        addWidget(entry.name, 10, 290 + row * 60, 150, entry.label, "stream", palette[(row + 1) % 5], [id] {
+            currentStream = id;
+            selectAlgorithm(streamBufferEntry(id).name);
+        });
+        row++;
+    }
+    row = 0;
+    for (const auto& entry : traversalRegistry) {
+        TraversalId id = entry.id;
+        addWidget(entry.name, 10 + (row / 8) * 160, 290 + (row % 8) * 60, 150, entry.label, "tree", palette[(row + 3) % 5], [id] {
+            currentTraversal = id;
+            selectAlgorithm(traversalEntry(id).name);
+        });
+        row++;
+    }
+
+    algorithmText.setFont(font);
+    algorithmText.setCharacterSize(20);
+    algorithmText.setFillColor(sf::Color::White);
+    algorithmText.setPosition(10, 10);
+
+    searchValueText.setFont(font);
+    searchValueText.setCharacterSize(20);
+    searchValueText.setFillColor(sf::Color::White);
+    searchValueText.setPosition(10, 790);
+
+    targetNodeText.setFont(font);
+    targetNodeText.setCharacterSize(20);
+    targetNodeText.setFillColor(sf::Color::White);
+    targetNodeText.setPosition(10, 820);
+}
+
+bool isWidgetVisible(const Widget& widget) {
+    return widget.mode.empty() || (showDropdown && widget.mode == visualizationType);
+}
+
+Widget* hitTest(const sf::Vector2f& point) { // -> one pass over the table, first visible hit wins
+    for (auto& widget : widgets) {
+        if (isWidgetVisible(widget) && widget.bounds.contains(point)) {
+            return &widget;
+        }
+    }
+    return nullptr;
+}
+
+void redrawChrome() {
+    chromeTexture.clear(sf::Color::Transparent);
+
+    sf::RectangleShape shape;
+    sf::Text label;
+    label.setFont(font);
+    label.setCharacterSize(20);
+    label.setFillColor(sf::Color::Black);
+    for (const auto& widget : widgets) {
+        if (!isWidgetVisible(widget)) {
+            continue;
+        }
+        shape.setSize(sf::Vector2f(widget.bounds.width, widget.bounds.height));
+        shape.setPosition(widget.bounds.left, widget.bounds.top);
+        shape.setFillColor(widget.color);
+        chromeTexture.draw(shape);
+        label.setString(widget.label);
+        label.setPosition(widget.bounds.left + 10, widget.bounds.top + 10);
+        chromeTexture.draw(label);
+    }
+
+    algorithmText.setString("Algorithm: " + currentAlgorithm);
+    chromeTexture.draw(algorithmText);
+    if (visualizationType == "search") {
+        searchValueText.setString("Number searched: " + std::to_string(searchValue));
+        chromeTexture.draw(searchValueText);
+    }
+    if (visualizationType == "tree" && traversalEntry(currentTraversal).grid) {
+        const GridMap& map = gridView.map;
+        targetNodeText.setString("Map " + std::to_string((long long)map.width) + "x" + std::to_string((long long)map.height) +
+                                 ", goal cell (" + std::to_string(gridView.target % map.width) + ", " +
+                                 std::to_string(gridView.target / map.width) + ")");
+        chromeTexture.draw(targetNodeText);
+    } else if (visualizationType == "tree") {
+        targetNodeText.setString("Target node: " + std::to_string(targetNode));
+        chromeTexture.draw(targetNodeText);
+    }
+
+    chromeTexture.display();
+    uiDirty = false;
+}
+
+//.....................................| Frame pacing |.....................................//
+struct FrameStats {
+    double frameMs = 0.0;    // -> wall time between the last two presented frames
+    double avgFrameMs = 0.0; // -> exponential moving average of frameMs
+    double renderMs = 0.0;   // -> time spent building and submitting the last frame
+    double cpuPercent = 0.0; // -> render thread CPU time over wall time since the previous frame (100 = one full core)
+    unsigned long long framesRendered = 0;
+    unsigned long long wakeups = 0; // -> loop iterations, including the ones that had nothing to draw
+};
+
+FrameStats frameStats;
+sf::Text frameStatsText;
+sf::Text scratchStatsText; // -> auxiliary memory of the running sort, from scratchStats
+sf::Text gridStatsText;    // -> frontier and relaxations of the running path search, from gridView
+
+bool isAnimating() {
+    return (isSorting || isSearching || isTreeTraversal) && !isPaused;
+}
+
+// Performance overlay, toggled with H (--hud shows it from the start). It shows:
+//   - the frame rate and frame-time percentiles over the last HUD_HISTORY frames;
+//   - the render thread's CPU time per frame;
+//   - how busy the run thread was and the visual operations per second it issued;
+//   - the window events handled per frame and the events queued for the stream server;
+//   - the resident set size.
+// A run thread that is far from busy is mostly sleeping in its animation delays. Numbers are
+// sampled every HUD_REFRESH_MS. The panel and the frame-time sparkline form one vertex array, the
+// numbers one text, so the overlay costs two draw calls.
+const int HUD_HISTORY = 240;
+const int HUD_REFRESH_MS = 250;
+const float HUD_X = WINDOW_WIDTH - 340, HUD_Y = 32, HUD_WIDTH = 330, HUD_HEIGHT = 160;
+
+struct Hud {
+    bool visible = false;
+    double frameMs[HUD_HISTORY] = {};
+    double cpuMs[HUD_HISTORY] = {}; // -> render thread CPU time of the same frames
+    int filled = 0, next = 0;
+    unsigned events = 0;     // -> window events since the last rendered frame
+    unsigned lastEvents = 0;
+    std::chrono::steady_clock::time_point sampled = std::chrono::steady_clock::now();
+    double sampledRunCpuMs = -1.0;
+    unsigned long long sampledOps = 0;
+    double runBusy = -1.0; // -> share of the last interval the run thread was on a CPU, -1 when unknown
+    double opsPerSecond = 0.0;
+    sf::VertexArray batch = sf::VertexArray(sf::Quads);
+    sf::Text text;
+};
+
+Hud hud;
+
+double renderThreadCpuMs() { // -> CPU time of the calling thread, -1 without thread clocks
+#if defined(_WIN32)
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) {
+        return -1.0;
+    }
+    auto ms = [](const FILETIME& t) { return (double(t.dwHighDateTime) * 4294967296.0 + t.dwLowDateTime) / 1e4; };
+    return ms(kernel) + ms(user);
+#else
+    timespec t;
+    return clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t) == 0 ? t.tv_sec * 1e3 + t.tv_nsec / 1e6 : -1.0;
+#endif
+}
+
+double runThreadCpuMs() { // -> CPU time of the run thread, -1 when there is none or the platform cannot tell (Linux only)
+#if defined(__linux__)
+    clockid_t clock;
+    timespec t;
+    if (currentThread.joinable() && pthread_getcpuclockid(currentThread.native_handle(), &clock) == 0 && clock_gettime(clock, &t) == 0) {
+        return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+    }
+#endif
+    return -1.0;
+}
+
+double residentMB() { // -> from /proc/self/statm, -1 where there is no procfs
+#if defined(__linux__)
+    std::FILE* in = std::fopen("/proc/self/statm", "r");
+    if (in) {
+        unsigned long long size = 0, resident = 0;
+        int got = std::fscanf(in, "%llu %llu", &size, &resident);
+        std::fclose(in);
+        if (got == 2) {
+            return double(resident) * double(sysconf(_SC_PAGESIZE)) / (1 << 20);
+        }
+    }
+#endif
+    return -1.0;
+}
+
+void hudRecordFrame(double wallMs, double cpuMs, bool afterIdle) {
+    hud.lastEvents = hud.events;
+    hud.events = 0;
+    if (afterIdle) {
+        return;
+    }
+    hud.frameMs[hud.next] = wallMs;
+    hud.cpuMs[hud.next] = cpuMs;
+    hud.next = (hud.next + 1) % HUD_HISTORY;
+    hud.filled = std::min(hud.filled + 1, HUD_HISTORY);
+}
+
+void hudRefresh() { // -> the text, at most every HUD_REFRESH_MS
+    auto now = std::chrono::steady_clock::now();
+    double intervalMs = std::chrono::duration<double, std::milli>(now - hud.sampled).count();
+    if (intervalMs < HUD_REFRESH_MS || hud.filled == 0) {
+        return;
+    }
+    double runCpu = runThreadCpuMs();
+    unsigned long long ops = visualOps;
+    bool running = isSorting || isSearching || isTreeTraversal;
+    hud.runBusy = running && runCpu >= 0.0 && hud.sampledRunCpuMs >= 0.0 && runCpu >= hud.sampledRunCpuMs
+                      ? std::min(1.0, (runCpu - hud.sampledRunCpuMs) / intervalMs) : -1.0;
+    hud.opsPerSecond = (ops - hud.sampledOps) * 1000.0 / intervalMs;
+    hud.sampled = now;
+    hud.sampledRunCpuMs = runCpu;
+    hud.sampledOps = ops;
+
+    std::vector<double> sorted(hud.frameMs, hud.frameMs + hud.filled);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) { return sorted[std::min(sorted.size() - 1, std::size_t(p * sorted.size()))]; };
+    double wall = 0.0, cpu = 0.0;
+    for (int i = 0; i < hud.filled; ++i) {
+        wall += hud.frameMs[i];
+        cpu += hud.cpuMs[i];
+    }
+    double rss = residentMB();
+    char busy[32], resident[32];
+    std::snprintf(busy, sizeof(busy), hud.runBusy < 0.0 ? "-" : "%.0f%%", 100.0 * hud.runBusy);
+    std::snprintf(resident, sizeof(resident), rss < 0.0 ? "-" : "%.1f MB", rss);
+    char text[512];
+    std::snprintf(text, sizeof(text),
+                  "%.1f fps over %d frames\n"
+                  "frame ms p50 %.1f  p95 %.1f  p99 %.1f  max %.1f\n"
+                  "render cpu %.2f ms/frame\n"
+                  "run thread busy %s | %.0f ops/s\n"
+                  "events %u/frame | stream queue %zu\n"
+                  "rss %s",
+                  wall > 0.0 ? 1000.0 * hud.filled / wall : 0.0, hud.filled, percentile(0.50), percentile(0.95), percentile(0.99),
+                  sorted.back(), cpu / hud.filled, busy, hud.opsPerSecond, hud.lastEvents, streamDepth.load(), resident);
+    hud.text.setString(text);
+}
+
+void drawHud(sf::RenderWindow& window) {
+    hudRefresh();
+    hud.batch.clear();
+    auto quad = [](float x, float y, float w, float h, const sf::Color& color) {
+        hud.batch.append(sf::Vertex(sf::Vector2f(x, y), color));
+        hud.batch.append(sf::Vertex(sf::Vector2f(x + w, y), color));
+        hud.batch.append(sf::Vertex(sf::Vector2f(x + w, y + h), color));
+        hud.batch.append(sf::Vertex(sf::Vector2f(x, y + h), color));
+    };
+    quad(HUD_X, HUD_Y, HUD_WIDTH, HUD_HEIGHT, sf::Color(0, 0, 0, 190));
+    const float SPARK_HEIGHT = 36, SPARK_MS = 50; // -> the sparkline tops out at 50 ms
+    float step = HUD_WIDTH / HUD_HISTORY;
+    for (int i = 0; i < hud.filled; ++i) { // -> oldest frame on the left
+        double ms = hud.frameMs[(hud.next - hud.filled + i + HUD_HISTORY) % HUD_HISTORY];
+        float h = float(std::min(ms, double(SPARK_MS)) / SPARK_MS * SPARK_HEIGHT);
+        sf::Color color = ms <= 1000.0 / ANIMATION_FPS + 1.0 ? sf::Color(90, 200, 90) : ms <= 2000.0 / ANIMATION_FPS ? sf::Color(230, 200, 60) : sf::Color(230, 80, 60);
+        quad(HUD_X + i * step, HUD_Y + HUD_HEIGHT - 4 - h, std::max(1.0f, step), h, color);
+    }
+    window.draw(hud.batch);
+    window.draw(hud.text);
+}
+
+void handleEvent(sf::RenderWindow& window, const sf::Event& event) {
+    hud.events++;
+    if (event.type == sf::Event::Closed) {
+        window.close();
+    }
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::H) {
+        hud.visible = !hud.visible;
+        sceneDirty = true;
+    }
+    if (event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus) {
+        sceneDirty = true;
+    }
+    if (event.type == sf::Event::MouseButtonPressed) {
+        sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
+        if (Widget* widget = hitTest(mousePos)) {
+            widget->action();
+            uiDirty = true;
+        }
+    }
+}
+
+//.....................................| Benchmark mode |.....................................//
+// Headless run of the native instantiations, no window or font needed:
+//   algori --bench [--n 1000,10000] [--algo quick,merge,binary] [--type int32,rec64] [--dist uniform,sorted]
+//                  [--reps 5] [--seed 1] [--no-simd] [--threads N] [--scaling] [--counters] [--trace out.json]
+//                  [--save-baseline base.txt] [--baseline base.txt] [--threshold 0.05]
+//   algori --bench --paths [--n 1000000] [--graph grid,er] [--map file] [--edges file] [--algo binary,4ary,pairing,radix]
+//   algori --bench --components --topo [--n 1000000] [--graph grid,er] [--edges file] [--threads N]
+//   algori --bench --generate --graph rmat,ba [--n 10000000] [--degree 16] [--arity 2] [--graph-cache dir]
+//   algori --bench --select [--k 10,1000,median] [--n 100000,1000000] [--algo quickselect,heap-topk] [--dist uniform,sorted]
+//   algori --bench --calibrate cost-model.txt [--n 100,10000,1000000] [--type int32,str15] [--reps 3]
+// Graphs: grid, tree, kary, er, rmat, ba.
+// Element types: int32, uint64, double, str15, str48, rec64, rec128, rec256.
+// Distributions: uniform, sorted, reversed, nearly, few-unique, zipf, organ-pipe, sawtooth, runs.
+struct BenchOptions {
+    std::vector<Index> sizes{1000, 10000};
+    std::vector<std::string> algorithms; // -> empty means every registered sort and search
+    std::vector<std::string> types;      // -> empty means every element kind
+    std::vector<Distribution> distributions{Distribution::Uniform};
+    int reps = 5;
+    std::uint64_t seed = 1;
+    bool scaling = false; // -> --scaling: Sample Sort strong/weak scaling curves instead of the table
+    bool counters = false; // -> --counters: hardware counters for every sort row
+    std::string tracePath; // -> --trace: timeline of the run as Chrome trace JSON
+    std::string baselinePath; // -> --baseline: compare every row with a saved run
+    std::string saveBaselinePath; // -> --save-baseline: save this run's samples
+    double threshold = 0.05; // -> --threshold: smallest relative change reported as a regression or speedup
+    bool paths = false; // -> --paths: shortest-path searches per priority queue instead of the table
+    bool components = false; // -> --components: connected components scaling instead of the table
+    bool topo = false;       // -> --topo: topological order scaling instead of the table
+    bool generate = false;   // -> --generate: only generate (and cache) the --graph graphs
+    std::vector<std::string> graphs; // -> --graph: graph kinds for the graph modes, empty means grid and er
+    Index degree = 8; // -> --degree: average degree of er, rmat and ba graphs
+    Index arity = 2;  // -> --arity: children per node of kary trees
+    std::string graphCache; // -> --graph-cache: directory of generated graphs, reused when present
+    std::string mapPath;   // -> --map: a grid map file, used instead of the generated grid
+    std::string edgesPath; // -> --edges: an edge list file, run after the generated graphs
+    std::string calibratePath; // -> --calibrate: measure the auto sort cost model and write it here
+    bool select = false; // -> --select: selection and top-k rows instead of the table
+    std::vector<Index> ranks{10, 1000, 0}; // -> --k: the k of every selection row, 0 for the median
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::size_t begin = 0;
+    while (begin <= text.size()) {
+        std::size_t end = text.find(',', begin);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        if (end > begin) {
+            items.push_back(text.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+    return items;
+}
+
+// Command-line numbers for every mode: the whole text must be a number within [low, high], otherwise
+// "bad value for --opt" is printed and false returned, where std::stoll would throw out of main.
+template <typename Number>
+bool parseNumber(const std::string& option, const std::string& text, Number& out, Number low = std::numeric_limits<Number>::lowest(),
+                 Number high = std::numeric_limits<Number>::max()) {
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    errno = 0;
+    bool ok = !text.empty() && !std::isspace((unsigned char)text[0]);
+    Number value = Number();
+    if constexpr (std::is_floating_point<Number>::value) {
+        double parsed = std::strtod(begin, &end);
+        ok = ok && std::isfinite(parsed) && parsed >= double(low) && parsed <= double(high);
+        value = Number(parsed);
+    } else if constexpr (std::is_signed<Number>::value) {
+        long long parsed = std::strtoll(begin, &end, 10);
+        ok = ok && parsed >= (long long)low && parsed <= (long long)high;
+        value = Number(parsed);
+    } else {
+        unsigned long long parsed = std::strtoull(begin, &end, 10);
+        ok = ok && text[0] != '-' && parsed >= (unsigned long long)low && parsed <= (unsigned long long)high;
+        value = Number(parsed);
+    }
+    if (!ok || errno != 0 || *end != '\0') {
+        std::cerr << "bad value for " << option << ": " << text << "\n";
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+bool parseBenchOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--bench") {
+            continue;
+        } else if (arg == "--n" && hasValue) {
+            options.sizes.clear();
+            for (const auto& item : splitList(argv[++i])) {
+                Index n = 0;
+                if (!parseNumber(arg, item, n, Index(0))) {
+                    return false;
+                }
+                options.sizes.push_back(n);
+            }
+        } else if (arg == "--algo" && hasValue) {
+            options.algorithms = splitList(argv[++i]);
+        } else if (arg == "--type" && hasValue) {
+            options.types = splitList(argv[++i]);
+        } else if (arg == "--reps" && hasValue) {
+            if (!parseNumber(arg, argv[++i], options.reps, 1)) {
+                return false;
+            }
+        } else if (arg == "--no-simd") {
+            allowAvx2 = false;
+        } else if (arg == "--threads" && hasValue) {
+            if (!parseNumber(arg, argv[++i], sortThreads, 1u)) {
+                return false;
+            }
+        } else if (arg == "--scaling") {
+            options.scaling = true;
+        } else if (arg == "--counters") {
+            options.counters = true;
+        } else if (arg == "--paths") {
+            options.paths = true;
+        } else if (arg == "--components") {
+            options.components = true;
+        } else if (arg == "--topo") {
+            options.topo = true;
+        } else if (arg == "--edges" && hasValue) {
+            options.edgesPath = argv[++i];
+        } else if (arg == "--graph" && hasValue) {
+            options.graphs = splitList(argv[++i]);
+            for (const auto& name : options.graphs) {
+                GraphKind kind;
+                if (!findGraphKind(name, kind)) {
+                    std::cerr << "unknown graph: " << name << " (" << graphKindList() << ")\n";
+                    return false;
+                }
+            }
+        } else if (arg == "--generate") {
+            options.generate = true;
+        } else if (arg == "--degree" && hasValue) {
+            if (!parseNumber(arg, argv[++i], options.degree, Index(1))) {
+                return false;
+            }
+        } else if (arg == "--arity" && hasValue) {
+            if (!parseNumber(arg, argv[++i], options.arity, Index(1))) {
+                return false;
+            }
+        } else if (arg == "--graph-cache" && hasValue) {
+            options.graphCache = argv[++i];
+        } else if (arg == "--map" && hasValue) {
+            options.mapPath = argv[++i];
+        } else if (arg == "--select") {
+            options.select = true;
+        } else if (arg == "--k" && hasValue) {
+            options.ranks.clear();
+            for (const auto& item : splitList(argv[++i])) {
+                Index k = 0;
+                if (item != "median" && !parseNumber(arg, item, k, Index(1))) {
+                    return false;
+                }
+                options.ranks.push_back(k);
+            }
+        } else if (arg == "--calibrate" && hasValue) {
+            options.calibratePath = argv[++i];
+        } else if (arg == "--cost-model" && hasValue) {
+            costModelPath = argv[++i];
+        } else if (arg == "--trace" && hasValue) {
+            options.tracePath = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            options.baselinePath = argv[++i];
+        } else if (arg == "--save-baseline" && hasValue) {
+            options.saveBaselinePath = argv[++i];
+        } else if (arg == "--threshold" && hasValue) {
+            if (!parseNumber(arg, argv[++i], options.threshold, 0.0)) {
+                return false;
+            }
+        } else if (arg == "--seed" && hasValue) {
+            if (!parseNumber(arg, argv[++i], options.seed)) {
+                return false;
+            }
+        } else if (arg == "--dist" && hasValue) {
+            options.distributions.clear();
+            for (const auto& item : splitList(argv[++i])) {
+                Distribution distribution;
+                if (!findDistribution(item, distribution)) {
+                    std::cerr << "unknown distribution: " << item << "\n";
+                    return false;
+                }
+                options.distributions.push_back(distribution);
+            }
+        } else {
+            std::cerr << "unknown or incomplete option: " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Hardware counters around each timed run, through Linux perf_event_open. Events are opened one by
+// one (not as a group) so a PMU without, say, dTLB events still reports the rest; user space only,
+// which kernel.perf_event_paranoid <= 2 permits for the own process. inherit = 1 also counts the
+// worker threads a parallel sort starts while the counters run. When the kernel multiplexes the
+// events, each count is scaled by time enabled / time running.
+class PerfCounters {
+public:
+    static const int COUNT = 6;
+    static const char* name(int event) {
+        static const char* const names[COUNT] = {"cycles", "instr", "br-miss", "L1-miss", "LLC-miss", "dTLB-miss"};
+        return names[event];
+    }
+
+    PerfCounters() { std::fill(fd, fd + COUNT, -1); }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    ~PerfCounters() { close(); }
+
+    bool open(std::string& error) { // -> true when at least one event could be opened
+#if defined(__linux__)
+        const std::uint64_t cacheReadMiss = (std::uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) |
+                                            (std::uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+        const std::uint32_t types[COUNT] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                            PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE};
+        const std::uint64_t configs[COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+                                              PERF_COUNT_HW_CACHE_L1D | cacheReadMiss, PERF_COUNT_HW_CACHE_LL | cacheReadMiss,
+                                              PERF_COUNT_HW_CACHE_DTLB | cacheReadMiss};
+        int lastErrno = 0;
+        for (int e = 0; e < COUNT; ++e) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fd[e] = int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fd[e] < 0) {
+                lastErrno = errno;
+            }
+        }
+        if (std::any_of(fd, fd + COUNT, [](int f) { return f >= 0; })) {
+            return true;
+        }
+        error = std::string("perf_event_open: ") + std::strerror(lastErrno);
+        if (std::FILE* paranoid = std::fopen("/proc/sys/kernel/perf_event_paranoid", "r")) {
+            int level = 0;
+            if (std::fscanf(paranoid, "%d", &level) == 1) {
+                error += " (kernel.perf_event_paranoid = " + std::to_string(level) + ")";
+            }
+            std::fclose(paranoid);
+        }
+        return false;
+#else
+        error = "hardware counters need Linux perf_event_open";
+        return false;
+#endif
+    }
+
+    bool has(int event) const { return fd[event] >= 0; }
+
+    void start() {
+#if defined(__linux__)
+        for (int e = 0; e < COUNT; ++e) {
+            if (fd[e] >= 0) {
+                ioctl(fd[e], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd[e], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    void stop(double* totals) { // -> adds this run's counts to totals[COUNT]
+#if defined(__linux__)
+        for (int e = 0; e < COUNT; ++e) {
+            if (fd[e] >= 0) {
+                ioctl(fd[e], PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for (int e = 0; e < COUNT; ++e) {
+            std::uint64_t value[3]; // -> count, time enabled, time running
+            if (fd[e] >= 0 && read(fd[e], value, sizeof(value)) == ssize_t(sizeof(value)) && value[2] > 0) {
+                totals[e] += double(value[0]) * double(value[1]) / double(value[2]);
+            }
+        }
+#else
+        (void)totals;
+#endif
+    }
+
+private:
+    void close() {
+#if defined(__linux__)
+        for (int e = 0; e < COUNT; ++e) {
+            if (fd[e] >= 0) {
+                ::close(fd[e]);
+                fd[e] = -1;
+            }
+        }
+#endif
+    }
+
+    int fd[COUNT];
+};
+
+PerfCounters benchCounters;
+bool benchCountersOpen = false; // -> --counters was given and at least one event opened
+
+void printCounters(const double* totals, int reps, Index n, unsigned long long comparisons) {
+    // -> one line per element and, when the counting pass knows them, one per comparison; '-' marks
+    //    an event this PMU does not offer
+    for (int per = 0; per < 2; ++per) {
+        double divisor = per == 0 ? double(reps) * double(n) : double(reps) * double(comparisons);
+        if (divisor == 0) { // -> no elements or no comparisons to share the counts over
+            continue;
+        }
+        std::printf("%-30s %-6s", "", per == 0 ? "/n" : "/cmp");
+        for (int e = 0; e < PerfCounters::COUNT; ++e) {
+            if (benchCounters.has(e)) {
+                std::printf(" %s %.2f", PerfCounters::name(e), totals[e] / divisor);
+            } else {
+                std::printf(" %s -", PerfCounters::name(e));
+            }
+        }
+        if (per == 0 && benchCounters.has(0) && benchCounters.has(1) && totals[0] > 0) {
+            std::printf(" ipc %.2f", totals[1] / totals[0]);
+        }
+        std::printf("\n");
+    }
+}
+
+bool isSelected(const std::vector<std::string>& filter, const char* name) {
+    return filter.empty() || std::find(filter.begin(), filter.end(), name) != filter.end();
+}
+
+double medianOf(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    std::size_t mid = samples.size() / 2;
+    return samples.size() % 2 ? samples[mid] : 0.5 * (samples[mid - 1] + samples[mid]);
+}
+
+// Baselines: --save-baseline writes every row's raw timing samples, keyed by "type dist algorithm n";
+// --baseline reads such a file and compares each row of this run with its saved counterpart. The
+// verdict comes from a bootstrap confidence interval for the ratio of medians (this run / baseline):
+// a row is a regression when the whole 95% interval lies above 1 + threshold and a speedup when
+// it lies below 1 - threshold. Medians and MADs (scaled to a standard deviation) are printed along.
+struct BenchBaseline {
+    std::unordered_map<std::string, std::vector<double>> saved; // -> loaded with --baseline
+    std::vector<std::pair<std::string, std::vector<double>>> recorded; // -> this run, for --save-baseline
+    bool loaded = false;
+    double threshold = 0.05;
+    int regressions = 0;
+    int speedups = 0;
+    int unchanged = 0;
+    int unmatched = 0;
+};
+
+BenchBaseline benchBaseline;
+const int BOOTSTRAP_RESAMPLES = 2000;
+
+double madOf(const std::vector<double>& samples) { // -> median absolute deviation, x1.4826 to estimate a standard deviation
+    double median = medianOf(samples);
+    std::vector<double> deviations;
+    for (double sample : samples) {
+        deviations.push_back(std::fabs(sample - median));
+    }
+    return 1.4826 * medianOf(deviations);
+}
+
+void bootstrapRatio(const std::vector<double>& base, const std::vector<double>& current, std::uint64_t seed, double& low, double& high) {
+    SplitMix64 rng(seed);
+    std::vector<double> ratios, a(base.size()), b(current.size());
+    for (int r = 0; r < BOOTSTRAP_RESAMPLES; ++r) {
+        for (double& x : a) {
+            x = base[rng.below(base.size())];
+        }
+        for (double& x : b) {
+            x = current[rng.below(current.size())];
+        }
+        ratios.push_back(medianOf(b) / std::max(medianOf(a), 1e-9));
+    }
+    std::sort(ratios.begin(), ratios.end());
+    low = ratios[std::size_t(0.025 * (BOOTSTRAP_RESAMPLES - 1))];
+    high = ratios[std::size_t(0.975 * (BOOTSTRAP_RESAMPLES - 1))];
+}
+
+bool loadBaseline(const std::string& path, std::uint64_t seed) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "cannot open baseline " << path << "\n";
+        return false;
+    }
+    std::string text; // -> a row holds every sample, so it is as long as --reps makes it
+    while (std::getline(in, text)) {
+        const char* line = text.c_str();
+        unsigned long long savedSeed = 0;
+        if (std::sscanf(line, "# seed %llu", &savedSeed) == 1 && savedSeed != seed) {
+            std::printf("# warning: baseline was recorded with --seed %llu, this run uses %llu\n", savedSeed, (unsigned long long)seed);
+        }
+        if (line[0] == '#') {
+            continue;
+        }
+        char type[32], dist[32], algorithm[32];
+        long long n = 0;
+        int count = 0, used = 0;
+        if (std::sscanf(line, "%31s %31s %31s %lld %d%n", type, dist, algorithm, &n, &count, &used) != 5) {
+            continue;
+        }
+        std::vector<double> samples;
+        const char* cursor = line + used;
+        double sample = 0;
+        while (std::sscanf(cursor, "%lf%n", &sample, &used) == 1) {
+            samples.push_back(sample);
+            cursor += used;
+        }
+        std::string key = std::string(type) + " " + dist + " " + algorithm + " " + std::to_string(n);
+        if (count <= 0 || samples.size() != std::size_t(count)) {
+            std::printf("# warning: baseline row %s has %zu samples, not %d; skipped\n", key.c_str(), samples.size(), count);
+            continue;
+        }
+        benchBaseline.saved[key] = samples;
+    }
+    benchBaseline.loaded = true;
+    std::printf("# baseline %s: %zu rows, threshold %.0f%%\n", path.c_str(), benchBaseline.saved.size(), 100 * benchBaseline.threshold);
+    return true;
+}
+
+bool saveBaseline(const std::string& path, std::uint64_t seed) {
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        std::cerr << "cannot write baseline " << path << "\n";
+        return false;
+    }
+    std::fprintf(out, "# algori benchmark baseline: type dist algorithm n samples ms...\n# seed %llu\n", (unsigned long long)seed);
+    for (const auto& row : benchBaseline.recorded) {
+        std::fprintf(out, "%s %zu", row.first.c_str(), row.second.size());
+        for (double sample : row.second) {
+            std::fprintf(out, " %.6f", sample);
+        }
+        std::fprintf(out, "\n");
+    }
+    std::fclose(out);
+    return true;
+}
+
+void compareWithBaseline(const char* type, const char* dist, const char* algorithm, Index n, const std::vector<double>& samples) {
+    std::string key = std::string(type) + " " + dist + " " + algorithm + " " + std::to_string((long long)n);
+    benchBaseline.recorded.emplace_back(key, samples);
+    if (!benchBaseline.loaded) {
+        return;
+    }
+    auto saved = benchBaseline.saved.find(key);
+    if (saved == benchBaseline.saved.end()) {
+        benchBaseline.unmatched++;
+        std::printf("%-30s baseline: no saved row\n", "");
+        return;
+    }
+    double low = 0, high = 0;
+    bootstrapRatio(saved->second, samples, std::hash<std::string>()(key), low, high);
+    double ratio = medianOf(samples) / std::max(medianOf(saved->second), 1e-9);
+    const char* verdict = "same";
+    if (low > 1 + benchBaseline.threshold) {
+        verdict = "REGRESSION";
+        benchBaseline.regressions++;
+    } else if (high < 1 - benchBaseline.threshold) {
+        verdict = "speedup";
+        benchBaseline.speedups++;
+    } else {
+        benchBaseline.unchanged++;
+    }
+    std::printf("%-30s baseline %.3f ms (mad %.3f) -> %.3f ms (mad %.3f)  x%.3f [%.3f, %.3f]  %s\n", "", medianOf(saved->second),
+                madOf(saved->second), medianOf(samples), madOf(samples), ratio, low, high, verdict);
+}
+
+template <typename Kind>
+bool benchElementKind(const BenchOptions& options, Distribution distribution, Index n) {
+    typedef typename Kind::type T;
+    typedef std::chrono::steady_clock Clock;
+    bool allCorrect = true;
+    const char* dist = distributionNames[std::size_t(distribution)];
+
+    GeneratorParams params;
+    params.seed = options.seed;
+    std::vector<T> input(n);
+    auto genStart = Clock::now();
+    generateInput<Kind>(input.data(), n, distribution, params);
+    std::printf("# generated %s/%s n=%lld in %.3f ms\n", Kind::name(), dist, (long long)n,
+                std::chrono::duration<double, std::milli>(Clock::now() - genStart).count());
+    std::vector<T> work(input);
+
+    if (isSelected(options.algorithms, "std")) { // -> std::sort as the baseline, it has no policy to count with
+        std::vector<double> samples;
+        double events[PerfCounters::COUNT] = {};
+        for (int rep = 0; rep < options.reps; ++rep) {
+            std::copy(input.begin(), input.end(), work.begin());
+            if (benchCountersOpen) {
+                benchCounters.start();
+            }
+            auto start = Clock::now();
+            std::sort(work.begin(), work.end());
+            samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            if (benchCountersOpen) {
+                benchCounters.stop(events);
+            }
+        }
+        double median = medianOf(samples);
+        char nsPerOp[16] = "-"; // -> per-element columns stay '-' for n = 0
+        if (n > 0) {
+            std::snprintf(nsPerOp, sizeof(nsPerOp), "%.2f", 1e6 * median / double(n));
+        }
+        std::printf("%-7s %-11s %-10s %10lld %12.3f %10s %10s %10s %10s %11s %10s %s\n", Kind::name(), dist, "std", (long long)n, median,
+                    nsPerOp, "-", "-", "-", "-", "-", "ok");
+        compareWithBaseline(Kind::name(), dist, "std", n, samples);
+        if (benchCountersOpen) {
+            printCounters(events, options.reps, n, 0);
+        }
+    }
+
+    for (const auto& entry : sortRegistry) {
+        if (!isSelected(options.algorithms, entry.name)) {
+            continue;
+        }
+        SortFn<T, NativePolicy> sort = sortFunction<T, NativePolicy>(entry.id);
+        TraceSpan span(entry.name, "bench");
+        std::vector<double> samples;
+        double events[PerfCounters::COUNT] = {};
+        bool sorted = true;
+        resetScratchStats();
+        for (int rep = 0; rep < options.reps; ++rep) {
+            std::copy(input.begin(), input.end(), work.begin());
+            NativePolicy obs;
+            if (benchCountersOpen) { // -> enabled outside the timed region, the ioctls are not part of the sort
+                benchCounters.start();
+            }
+            auto start = Clock::now();
+            sort(work.data(), n, obs);
+            samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            if (benchCountersOpen) {
+                benchCounters.stop(events);
+            }
+            sorted = sorted && std::is_sorted(work.begin(), work.end());
+        }
+
+        double auxPeak = scratchStats.peak / 1e6, auxTotal = scratchStats.total / 1e6 / options.reps;
+        std::copy(input.begin(), input.end(), work.begin()); // -> one extra, untimed pass to count the data movement
+        CountingPolicy counts;
+        sortFunction<T, CountingPolicy>(entry.id)(work.data(), n, counts);
+        double moves = 3.0 * counts.swaps + counts.writes; // -> a swap is three moves, through a temporary
+
+        double median = medianOf(samples);
+        char nsPerOp[16] = "-", cmpPerN[16] = "-", movesPerN[16] = "-";
+        if (n > 0) {
+            std::snprintf(nsPerOp, sizeof(nsPerOp), "%.2f", 1e6 * median / double(n));
+            std::snprintf(cmpPerN, sizeof(cmpPerN), "%.2f", counts.comparisons / double(n));
+            std::snprintf(movesPerN, sizeof(movesPerN), "%.2f", moves / double(n));
+        }
+        std::printf("%-7s %-11s %-10s %10lld %12.3f %10s %10s %10s %10.2f %11.2f %10.2f %s\n", Kind::name(), dist, entry.name,
+                    (long long)n, median, nsPerOp, cmpPerN, movesPerN, moves * sizeof(T) / 1e6, auxPeak, auxTotal,
+                    sorted ? "ok" : "NOT SORTED");
+        compareWithBaseline(Kind::name(), dist, entry.name, n, samples);
+        if (entry.id == SortId::Auto) {
+            int choice = autoDecision.choice;
+            std::printf("%-30s auto: %s (%s cost model)\n", "", choice == int(SortId::Auto) ? "already sorted" : sortEntry(SortId(choice)).name,
+                        costModel().source.c_str());
+        }
+        if (benchCountersOpen) {
+            printCounters(events, options.reps, n, counts.comparisons);
+        }
+        allCorrect = allCorrect && sorted;
+    }
+
+    std::vector<T> haystack(input);
+    std::sort(haystack.begin(), haystack.end());
+    const int queries = 1000;
+    for (const auto& entry : searchRegistry) {
+        if (n == 0 || !isSelected(options.algorithms, entry.name)) { // -> an empty haystack has nothing to look up
+            continue;
+        }
+        SearchFn<T, NativePolicy> search = searchFunction<T, NativePolicy>(entry.id);
+        std::vector<double> samples;
+        bool correct = true;
+        std::mt19937 pick(options.seed);
+        std::vector<T> needles;
+        for (int q = 0; q < queries; ++q) {
+            needles.push_back(haystack[pick() % haystack.size()]);
+        }
+        for (int rep = 0; rep < options.reps; ++rep) {
+            NativePolicy obs;
+            Index hits = 0;
+            auto start = Clock::now();
+            for (const T& needle : needles) {
+                hits += search(haystack.data(), n, needle, obs) >= 0;
+            }
+            samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            correct = correct && hits == queries;
+        }
+        CountingPolicy counts;
+        searchFunction<T, CountingPolicy>(entry.id)(haystack.data(), n, needles[0], counts);
+
+        double median = medianOf(samples);
+        std::printf("%-7s %-11s %-10s %10lld %12.3f %10.2f %10llu %10s %10s %11s %10s %s\n", Kind::name(), dist, entry.name, (long long)n,
+                    median, 1e6 * median / queries, counts.comparisons, "-", "-", "-", "-", correct ? "ok" : "MISSED");
+        compareWithBaseline(Kind::name(), dist, entry.name, n, samples);
+        allCorrect = allCorrect && correct;
+    }
+    return allCorrect;
+}
+
+// Selection rows for --select: every k of --k against a full std::sort followed by a slice of the
+// first k, plus std::nth_element and std::partial_sort. speedup is sort+slice time over the row's time.
+template <typename Kind>
+bool benchSelection(const BenchOptions& options, Distribution distribution, Index n) {
+    typedef typename Kind::type T;
+    typedef std::chrono::steady_clock Clock;
+    bool allCorrect = true;
+    const char* dist = distributionNames[std::size_t(distribution)];
+    if (n == 0) { // -> no k satisfies 1 <= k <= n
+        std::printf("# %s/%s n=0: no selection rows\n", Kind::name(), dist);
+        return true;
+    }
+
+    GeneratorParams params;
+    params.seed = options.seed;
+    std::vector<T> input(n);
+    generateInput<Kind>(input.data(), n, distribution, params);
+    std::vector<T> reference(input), work(input), slice;
+    std::sort(reference.begin(), reference.end());
+    auto same = [](const T& x, const T& y) { return !(x < y) && !(y < x); };
+
+    for (Index rank : options.ranks) {
+        Index k = rank == 0 ? std::max<Index>(1, n / 2) : std::min(rank, n); // -> 0 stands for the median
+        double sortMs = 0;
+        auto row = [&](const char* name, auto select, double comparisons) {
+            std::vector<double> samples;
+            bool correct = true;
+            for (int rep = 0; rep < options.reps; ++rep) {
+                std::copy(input.begin(), input.end(), work.begin());
+                auto start = Clock::now();
+                select();
+                samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+                // -> a[k - 1] is the k-th smallest and a[0, k) holds the k smallest, in any order
+                std::sort(work.begin(), work.begin() + k);
+                correct = correct && std::equal(work.begin(), work.begin() + k, reference.begin(), same);
+            }
+            double median = medianOf(samples);
+            sortMs = sortMs > 0 ? sortMs : median;
+            char cmp[16] = "-";
+            if (comparisons >= 0) {
+                std::snprintf(cmp, sizeof(cmp), "%.2f", comparisons / double(n));
+            }
+            std::printf("%-7s %-11s %-12s %10lld %10lld %12.3f %10.2f %10s %9.2f %s\n", Kind::name(), dist, name, (long long)n,
+                        (long long)k, median, 1e6 * median / double(n), cmp, sortMs / std::max(median, 1e-9), correct ? "ok" : "WRONG");
+            compareWithBaseline(Kind::name(), dist, (std::string(name) + "/k" + std::to_string((long long)k)).c_str(), n, samples);
+            allCorrect = allCorrect && correct;
+        };
+
+        row("sort+slice", [&] {
+            std::sort(work.begin(), work.end());
+            slice.assign(work.begin(), work.begin() + k);
+        }, -1);
+        if (isSelected(options.algorithms, "nth_element")) {
+            row("nth_element", [&] { std::nth_element(work.begin(), work.begin() + (k - 1), work.end()); }, -1);
+        }
+        if (isSelected(options.algorithms, "partial_sort")) {
+            row("partial_sort", [&] { std::partial_sort(work.begin(), work.begin() + k, work.end()); }, -1);
+        }
+        for (const auto& entry : selectRegistry) {
+            if (!isSelected(options.algorithms, entry.name)) {
+                continue;
+            }
+            TraceSpan span(entry.name, "bench");
+            std::copy(input.begin(), input.end(), work.begin()); // -> the untimed counting pass
+            CountingPolicy counts;
+            selectFunction<T, CountingPolicy>(entry.id)(work.data(), n, k, counts);
+            SelectFn<T, NativePolicy> select = selectFunction<T, NativePolicy>(entry.id);
+            row(entry.name, [&] {
+                NativePolicy obs;
+                select(work.data(), n, k, obs);
+            }, double(counts.comparisons));
+        }
+    }
+    return allCorrect;
+}
+
+template <typename Fn>
+bool forEachElementKind(const BenchOptions& options, Fn fn) { // -> fn(Kind()) for every element kind selected by --type
+    bool allCorrect = true;
+    auto run = [&](auto kind) {
+        if (isSelected(options.types, decltype(kind)::name())) {
+            allCorrect &= fn(kind);
+        }
+    };
+    run(Int32Kind());
+    run(UInt64Kind());
+    run(DoubleKind());
+    run(ShortStringKind());
+    run(LongStringKind());
+    run(RecordKind<64>());
+    run(RecordKind<128>());
+    run(RecordKind<256>());
+    return allCorrect;
+}
+
+std::vector<unsigned> scalingWorkerCounts() { // -> 1, 2, 4, ... up to --threads, or the hardware threads
+    std::vector<unsigned> workerCounts;
+    for (unsigned t = 1; t < sortWorkers(); t *= 2) {
+        workerCounts.push_back(t);
+    }
+    workerCounts.push_back(sortWorkers());
+    return workerCounts;
+}
+
+// Scaling curves for Sample Sort, one row per worker count from 1 up to the hardware threads
+// (or --threads).
+// Strong scaling sorts the largest --n with more and more workers (ideal: speedup = workers), weak
+// scaling gives each worker the smallest --n (ideal: constant time, efficiency 1).
+template <typename Kind>
+bool benchScaling(const BenchOptions& options, Distribution distribution) {
+    typedef typename Kind::type T;
+    typedef std::chrono::steady_clock Clock;
+    const char* dist = distributionNames[std::size_t(distribution)];
+    std::vector<unsigned> workerCounts = scalingWorkerCounts();
+
+    bool allCorrect = true;
+    unsigned savedThreads = sortThreads;
+    for (int weak = 0; weak < 2; ++weak) {
+        double baseline = 0;
+        for (unsigned workers : workerCounts) {
+            Index n = weak ? options.sizes.front() * Index(workers) : options.sizes.back();
+            GeneratorParams params;
+            params.seed = options.seed;
+            std::vector<T> input(n), work(n);
+            generateInput<Kind>(input.data(), n, distribution, params);
+
+            sortThreads = workers;
+            std::vector<double> samples;
+            bool sorted = true;
+            for (int rep = 0; rep < options.reps; ++rep) {
+                std::copy(input.begin(), input.end(), work.begin());
+                NativePolicy obs;
+                auto start = Clock::now();
+                sampleSort(work.data(), n, obs);
+                samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+                sorted = sorted && std::is_sorted(work.begin(), work.end());
+            }
+            double median = medianOf(samples);
+            baseline = workers == 1 ? median : baseline;
+            double speedup = weak ? baseline * workers / median : baseline / median;
+            std::printf("%-7s %-11s %-7s %8u %12lld %12.3f %9.2f %11.2f %s\n", Kind::name(), dist, weak ? "weak" : "strong", workers,
+                        (long long)n, median, speedup, speedup / workers, sorted ? "ok" : "NOT SORTED");
+            allCorrect = allCorrect && sorted;
+        }
+    }
+    sortThreads = savedThreads;
+    return allCorrect;
+}
+
+// Graphs for --paths, --components, --topo and --generate: every --graph kind at every --n, then the
+// --edges file. The --map file replaces the generated grid (it has one size). A generated graph is
+// read from --graph-cache when it is there and saved to it when not; a "# graph" line reports where
+// it came from and how long that took. fn(kind, graph, map) gets the map behind a grid, null otherwise.
+template <typename Fn>
+bool forEachBenchGraph(const BenchOptions& options, const GridMap* loadedMap, const Graph* loadedEdges, Fn fn) {
+    typedef std::chrono::steady_clock Clock;
+    auto elapsedMs = [](Clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+    };
+    std::vector<std::string> kinds = options.graphs;
+    if (kinds.empty() && !loadedEdges) {
+        kinds = {"grid", "er"};
+    }
+    bool allCorrect = true;
+    for (const auto& name : kinds) {
+        GraphKind kind = GraphKind::Grid;
+        findGraphKind(name, kind);
+        for (Index n : options.sizes) {
+            if (kind == GraphKind::Grid && loadedMap) {
+                if (n == options.sizes.front()) {
+                    GridMap map = *loadedMap;
+                    allCorrect &= fn(name, gridGraph(map), &map);
                 }
+                continue;
             }
+            GraphParams params;
+            params.nodes = n;
+            params.degree = options.degree;
+            params.arity = options.arity;
+            params.seed = options.seed;
+            GridMap map;
+            Graph graph;
+            std::string cachePath = options.graphCache.empty() ? std::string() : graphCachePath(options.graphCache, kind, params);
+            auto start = Clock::now();
+            GridMap* gridMap = kind == GraphKind::Grid ? &map : nullptr; // -> a grid caches its cell costs with the CSR arrays
+            bool cached = !cachePath.empty() && loadGraph(cachePath, graph, gridMap);
+            if (cached) {
+                std::printf("# graph %s: %lld nodes, %lld edges, loaded from %s in %.1f ms\n", name.c_str(), (long long)graph.nodes,
+                            (long long)graph.edges(), cachePath.c_str(), elapsedMs(start));
+            } else {
+                graph = generateGraph(kind, params, &map);
+                std::printf("# graph %s: %lld nodes, %lld edges, generated in %.1f ms", name.c_str(), (long long)graph.nodes,
+                            (long long)graph.edges(), elapsedMs(start));
+                if (!cachePath.empty()) {
+                    std::printf(saveGraph(cachePath, graph, gridMap) ? ", saved to %s" : ", cannot save %s", cachePath.c_str());
+                }
+                std::printf("\n");
+            }
+            std::fflush(stdout);
+            allCorrect &= fn(name, graph, gridMap);
+        }
+    }
+    if (loadedEdges) {
+        allCorrect &= fn(std::string("edges"), *loadedEdges, nullptr);
+    }
+    return allCorrect;
+}
 
-            while (item == array[pos]) {
-                pos++;
+// Shortest paths per priority queue: every selected queue runs Dijkstra from the first open node to
+// all others (sssp) and, on grids, Dijkstra and A* from corner to corner (p2p, astar). relax/n and
+// settled come from the counting pass; Mrelax/s is relaxations over the median time. Distances are
+// checked against a binary heap reference run.
+bool benchPaths(const BenchOptions& options, const std::string& kind, const Graph& graph, const GridMap* map) {
+    typedef std::chrono::steady_clock Clock;
+    NodeId source = 0, target = NO_NODE;
+    if (map) {
+        gridEndpoints(*map, source, target);
+    }
+
+    PathSearch reference;
+    {
+        DaryHeap<2> queue;
+        NativeGraphPolicy obs;
+        shortestPath(graph, source, NO_NODE, NoHeuristic(), queue, reference, obs);
+    }
+    const char* searches[] = {"sssp", "p2p", "astar"};
+    bool allCorrect = true;
+    forEachPathQueue([&](const char* name, auto queue) {
+        if (!isSelected(options.algorithms, name)) {
+            return;
+        }
+        for (const char* searchName : searches) {
+            std::string mode = searchName;
+            if (mode != "sssp" && !map) {
+                continue;
+            }
+            NodeId goal = mode == "sssp" ? NO_NODE : target;
+            auto run = [&](PathSearch& search, auto& obs) {
+                return mode == "astar" ? shortestPath(graph, source, goal, gridHeuristic(*map, goal), queue, search, obs)
+                                       : shortestPath(graph, source, goal, NoHeuristic(), queue, search, obs);
+            };
+            PathSearch search;
+            CountingGraphPolicy counting;
+            run(search, counting);
+            std::vector<double> samples;
+            bool correct = true;
+            for (int rep = 0; rep < options.reps; ++rep) {
+                NativeGraphPolicy obs;
+                auto start = Clock::now();
+                Distance distance = run(search, obs);
+                samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+                correct = correct && (goal == NO_NODE ? search.distance == reference.distance : distance == reference.distance[goal]);
+            }
+            double median = medianOf(samples);
+            std::string algorithm = std::string(name) + "-" + mode;
+            std::printf("%-7s %12lld %12lld %-8s %-6s %12.3f %9.2f %10.2f %12llu %s\n", kind.c_str(), (long long)graph.nodes,
+                        (long long)graph.edges(), name, searchName, median, double(counting.relaxations) / double(graph.nodes),
+                        double(counting.relaxations) / (median * 1000.0), counting.settles, correct ? "ok" : "WRONG DISTANCE");
+            compareWithBaseline("path", kind.c_str(), algorithm.c_str(), graph.nodes, samples);
+            allCorrect = allCorrect && correct;
+        }
+    });
+    return allCorrect;
+}
+
+// Components and topological order at 1, 2, 4, ... workers. Generated graphs are sorted
+// topologically through acyclicView(), an --edges graph as it is (a cycle leaves nodes unordered,
+// which is a result, not an error). Components are checked against a sequential union-find, the
+// order by its length against a sequential Kahn and by every edge pointing forward.
+bool benchAnalysis(const BenchOptions& options, const std::string& kind, const Graph& graph) {
+    typedef std::chrono::steady_clock Clock;
+    bool allCorrect = true;
+    if (options.components) {
+        std::vector<NodeId> reference(graph.nodes);
+        for (Index v = 0; v < graph.nodes; ++v) {
+            reference[v] = NodeId(v);
+        }
+        auto find = [&](NodeId v) {
+            while (reference[v] != v) {
+                v = reference[v] = reference[reference[v]];
+            }
+            return v;
+        };
+        for (Index u = 0; u < graph.nodes; ++u) {
+            for (Index e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+                NodeId a = find(NodeId(u)), b = find(graph.targets[e]);
+                reference[std::max(a, b)] = std::min(a, b);
+            }
+        }
+        for (Index v = 0; v < graph.nodes; ++v) {
+            reference[v] = find(NodeId(v));
+        }
+
+        double single = 0;
+        for (unsigned workers : scalingWorkerCounts()) {
+            std::vector<NodeId> component;
+            std::vector<double> samples;
+            Index count = 0;
+            bool correct = true;
+            for (int rep = 0; rep < options.reps; ++rep) {
+                NativeAnalysisPolicy obs;
+                auto start = Clock::now();
+                count = connectedComponents(graph, component, workers, obs);
+                samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+                correct = correct && component == reference;
+            }
+            double median = medianOf(samples);
+            single = workers == 1 ? median : single;
+            std::string result = std::to_string((long long)count) + " components";
+            std::printf("%-7s %12lld %12lld %-10s %8u %12.3f %9.2f %11.2f %-22s %s\n", kind.c_str(), (long long)graph.nodes,
+                        (long long)graph.edges(), "components", workers, median, single / median, single / median / workers,
+                        result.c_str(), correct ? "ok" : "WRONG LABELS");
+            compareWithBaseline("graph", kind.c_str(), ("components-" + std::to_string(workers)).c_str(), graph.nodes, samples);
+            allCorrect = allCorrect && correct;
+        }
+    }
+    if (options.topo) {
+        Graph dag = kind == "edges" ? graph : acyclicView(graph);
+        std::vector<Index> indegree(dag.nodes, 0), position(dag.nodes, -1);
+        for (NodeId v : dag.targets) {
+            indegree[v]++;
+        }
+        std::vector<NodeId> queue;
+        for (Index v = 0; v < dag.nodes; ++v) {
+            if (indegree[v] == 0) {
+                queue.push_back(NodeId(v));
+            }
+        }
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            for (Index e = dag.offsets[queue[head]]; e < dag.offsets[queue[head] + 1]; ++e) {
+                if (--indegree[dag.targets[e]] == 0) {
+                    queue.push_back(dag.targets[e]);
+                }
+            }
+        }
+
+        double single = 0;
+        for (unsigned workers : scalingWorkerCounts()) {
+            std::vector<NodeId> order;
+            std::vector<double> samples;
+            Index levels = 0;
+            for (int rep = 0; rep < options.reps; ++rep) {
+                NativeAnalysisPolicy obs;
+                auto start = Clock::now();
+                levels = topologicalOrder(dag, order, workers, obs);
+                samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            }
+            std::fill(position.begin(), position.end(), -1);
+            for (std::size_t i = 0; i < order.size(); ++i) {
+                position[order[i]] = Index(i);
+            }
+            bool correct = order.size() == queue.size();
+            for (Index u = 0; correct && u < dag.nodes; ++u) {
+                for (Index e = dag.offsets[u]; e < dag.offsets[u + 1] && position[u] >= 0; ++e) {
+                    correct = correct && (position[dag.targets[e]] > position[u] || position[dag.targets[e]] < 0); // -> or behind a cycle
+                }
+            }
+            double median = medianOf(samples);
+            single = workers == 1 ? median : single;
+            std::string result = std::to_string((long long)levels) + " levels";
+            if (Index(order.size()) < dag.nodes) {
+                result += ", " + std::to_string((long long)(dag.nodes - Index(order.size()))) + " cyclic";
+            }
+            std::printf("%-7s %12lld %12lld %-10s %8u %12.3f %9.2f %11.2f %-22s %s\n", kind.c_str(), (long long)dag.nodes,
+                        (long long)dag.edges(), "topo", workers, median, single / median, single / median / workers,
+                        result.c_str(), correct ? "ok" : "WRONG ORDER");
+            compareWithBaseline("graph", kind.c_str(), ("topo-" + std::to_string(workers)).c_str(), dag.nodes, samples);
+            allCorrect = allCorrect && correct;
+        }
+    }
+    return allCorrect;
+}
+
+int finishBenchmark(const BenchOptions& options, bool allCorrect) { // -> 0 ok, 1 wrong result, 3 regression against --baseline
+    if (!options.tracePath.empty() && !writeTrace(options.tracePath)) {
+        std::cerr << "cannot write trace " << options.tracePath << "\n";
+    }
+    if (!options.saveBaselinePath.empty() && saveBaseline(options.saveBaselinePath, options.seed)) {
+        std::printf("# saved %zu rows to %s\n", benchBaseline.recorded.size(), options.saveBaselinePath.c_str());
+    }
+    if (benchBaseline.loaded) {
+        std::printf("# against baseline: %d regressions, %d speedups, %d unchanged, %d without a saved row\n",
+                    benchBaseline.regressions, benchBaseline.speedups, benchBaseline.unchanged, benchBaseline.unmatched);
+    }
+    if (!allCorrect) {
+        return 1;
+    }
+    return benchBaseline.regressions > 0 ? 3 : 0;
+}
+
+// Calibration of the auto sort cost model (--calibrate FILE). Every element kind and size is
+// generated in every distribution, plus two narrow integer ranges ("narrow": n / 16 distinct keys,
+// "bars": the 651 bar heights of the window), profiled like autoSort does, and sorted by each candidate.
+// Above AUTO_PROBE elements a candidate is first timed on AUTO_PROBE / 16 and AUTO_PROBE keys taken
+// at even strides (a stride sample keeps the shape of the whole input, where a prefix of an organ
+// pipe or a sawtooth is just sorted), best of three each. When that grows more than 64x (n log n
+// grows about 22x, quadratic 256x) and takes over AUTO_PROBE_MS, the candidate is quadratic on this
+// input and left out of the row instead of being run at full size.
+const Index AUTO_PROBE = 16384;
+const double AUTO_PROBE_MS = 1.0;
+
+template <typename Kind>
+bool calibrateElementKind(const BenchOptions& options, Index n, std::string& rows) {
+    typedef typename Kind::type T;
+    typedef std::chrono::steady_clock Clock;
+    struct CalibrationInput {
+        const char* name;
+        Distribution distribution;
+        std::uint64_t range; // -> 0 keeps the generator's default range
+    };
+    std::vector<CalibrationInput> inputs;
+    for (std::size_t d = 0; d < std::size_t(Distribution::Count); ++d) {
+        inputs.push_back({distributionNames[d], Distribution(d), 0});
+    }
+    inputs.push_back({"narrow", Distribution::Uniform, std::uint64_t(std::max<Index>(1, n / 16))});
+    inputs.push_back({"bars", Distribution::Uniform, 651});
+
+    bool allCorrect = true;
+    std::vector<T> input(n), work(n);
+    for (const CalibrationInput& spec : inputs) {
+        GeneratorParams params;
+        params.seed = options.seed;
+        params.range = spec.range > 0 ? spec.range : params.range;
+        generateInput<Kind>(input.data(), n, spec.distribution, params);
+        SortProfile profile = profileInput(input.data(), n);
+        double f[AUTO_FEATURES];
+        profile.features(f);
+
+        auto timeSort = [&](SortFn<T, NativePolicy> sort, Index length) { // -> ms of one run on `length` evenly strided keys
+            for (Index i = 0; i < length; ++i) {
+                work[i] = input[i * n / length];
+            }
+            NativePolicy obs;
+            auto start = Clock::now();
+            sort(work.data(), length, obs);
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        };
+        char text[64];
+        std::string row = std::string(Kind::name()) + " " + spec.name + " " + std::to_string((long long)n);
+        for (double feature : f) {
+            std::snprintf(text, sizeof(text), " %.3f", feature);
+            row += text;
+        }
+        std::printf("%-7s %-11s %10lld %8lld %8.2f %8.2f %10.2f", Kind::name(), spec.name, (long long)n, (long long)profile.runs,
+                    profile.disorder, profile.duplicates, f[4]);
+        SortId best = SortId::Auto;
+        double bestNs = std::numeric_limits<double>::infinity();
+        for (SortId id : AUTO_CANDIDATES) {
+            SortFn<T, NativePolicy> sort = sortFunction<T, NativePolicy>(id);
+            TraceSpan span(sortEntry(id).name, "calibrate");
+            bool quadratic = false;
+            if (n > AUTO_PROBE) {
+                double small = std::min({timeSort(sort, AUTO_PROBE / 16), timeSort(sort, AUTO_PROBE / 16), timeSort(sort, AUTO_PROBE / 16)});
+                double large = std::min({timeSort(sort, AUTO_PROBE), timeSort(sort, AUTO_PROBE), timeSort(sort, AUTO_PROBE)});
+                quadratic = large > AUTO_PROBE_MS && large > 64 * small;
+            }
+            if (quadratic) {
+                row += " -";
+                std::printf(" %10s", "-");
+                continue;
+            }
+            std::vector<double> samples;
+            for (int rep = 0; rep < options.reps; ++rep) {
+                samples.push_back(timeSort(sort, n));
+            }
+            bool sorted = std::is_sorted(work.begin(), work.end());
+            allCorrect = allCorrect && sorted;
+            double ns = 1e6 * medianOf(samples) / double(n);
+            std::snprintf(text, sizeof(text), " %.3f", ns);
+            row += text;
+            std::printf(" %10.2f%s", ns, sorted ? "" : "!");
+            if (sorted && ns < bestNs) {
+                bestNs = ns;
+                best = id;
+            }
+        }
+        std::printf(" %s\n", best == SortId::Auto ? "-" : sortEntry(best).name);
+        rows += row + "\n";
+    }
+    return allCorrect;
+}
+
+int runCalibration(const BenchOptions& options) {
+    // runs, disorder and dup come from the profile, log2_range is log2((max - min + 1) / n) clamped
+    // to [-8, 8] (8 for keys that are not integers); the rest is ns per element, "-" for quadratic
+    std::printf("%-7s %-11s %10s %8s %8s %8s %10s", "type", "dist", "n", "runs", "disorder", "dup", "log2_range");
+    for (SortId id : AUTO_CANDIDATES) {
+        std::printf(" %10s", sortEntry(id).name);
+    }
+    std::printf(" best\n");
+    std::string rows;
+    bool allCorrect = true;
+    for (Index n : options.sizes) {
+        allCorrect &= forEachElementKind(options, [&](auto kind) { return calibrateElementKind<decltype(kind)>(options, n, rows); });
+    }
+
+    std::FILE* out = std::fopen(options.calibratePath.c_str(), "w");
+    if (!out) {
+        std::cerr << "cannot write cost model " << options.calibratePath << "\n";
+        return 2;
+    }
+    std::fprintf(out, "# algori auto sort cost model: type dist n, log2 n, log2 runs, 8 disorder, 8 duplicates, log2 range, log2 bytes,\n"
+                      "# indirect, then ns per element of each candidate\n# seed %llu\n# candidates",
+                 (unsigned long long)options.seed);
+    for (SortId id : AUTO_CANDIDATES) {
+        std::fprintf(out, " %s", sortEntry(id).name);
+    }
+    std::fprintf(out, "\n%s", rows.c_str());
+    std::fclose(out);
+    std::printf("# wrote the cost model to %s\n", options.calibratePath.c_str());
+    return finishBenchmark(options, allCorrect);
+}
+
+int runBenchmark(const BenchOptions& options) {
+    traceThreadName("bench");
+    traceEnabled = !options.tracePath.empty();
+    std::printf("# seed %llu\n", (unsigned long long)options.seed);
+    benchBaseline.threshold = options.threshold;
+    if (!options.baselinePath.empty() && !loadBaseline(options.baselinePath, options.seed)) {
+        return 2;
+    }
+    std::printf("# simd kernels: %s\n", useAvx2() ? "avx2" : cpuHasAvx2() ? "scalar (--no-simd)" : "scalar (no avx2)");
+    if (options.counters) {
+        std::string error;
+        benchCountersOpen = benchCounters.open(error);
+        if (!benchCountersOpen) {
+            std::printf("# hardware counters unavailable, timing only: %s\n", error.c_str());
+        }
+    }
+    if (!options.calibratePath.empty()) {
+        return runCalibration(options);
+    }
+    bool allCorrect = true;
+    if (options.paths || options.components || options.topo || options.generate) {
+        GridMap map;
+        Graph edges;
+        std::string error;
+        if ((!options.mapPath.empty() && !loadGridMap(options.mapPath, map, error)) ||
+            (!options.edgesPath.empty() && !loadEdgeList(options.edgesPath, edges, error))) {
+            std::cerr << error << "\n";
+            return 2;
+        }
+        const GridMap* loadedMap = options.mapPath.empty() ? nullptr : &map;
+        const Graph* loadedEdges = options.edgesPath.empty() ? nullptr : &edges;
+        if (options.paths) {
+            std::printf("%-7s %12s %12s %-8s %-6s %12s %9s %10s %12s %s\n", "graph", "nodes", "edges", "queue", "search", "median_ms",
+                        "relax/n", "Mrelax/s", "settled", "check");
+            allCorrect &= forEachBenchGraph(options, loadedMap, loadedEdges, [&](const std::string& kind, const Graph& graph, const GridMap* grid) {
+                return benchPaths(options, kind, graph, grid);
+            });
+        }
+        if (options.components || options.topo) {
+            std::printf("# %u hardware threads\n", workerCount());
+            std::printf("%-7s %12s %12s %-10s %8s %12s %9s %11s %-22s %s\n", "graph", "nodes", "edges", "algorithm", "workers",
+                        "median_ms", "speedup", "efficiency", "result", "check");
+            allCorrect &= forEachBenchGraph(options, loadedMap, loadedEdges, [&](const std::string& kind, const Graph& graph, const GridMap*) {
+                return benchAnalysis(options, kind, graph);
+            });
+        }
+        if (options.generate && !options.paths && !options.components && !options.topo) {
+            forEachBenchGraph(options, loadedMap, loadedEdges, [](const std::string&, const Graph&, const GridMap*) { return true; });
+        }
+        return finishBenchmark(options, allCorrect);
+    }
+    if (options.select) {
+        std::printf("%-7s %-11s %-12s %10s %10s %12s %10s %10s %9s %s\n", "type", "dist", "algorithm", "n", "k", "median_ms", "ns/elem",
+                    "cmp/n", "speedup", "check");
+        for (Distribution distribution : options.distributions) {
+            for (Index n : options.sizes) {
+                allCorrect &= forEachElementKind(options, [&](auto kind) { return benchSelection<decltype(kind)>(options, distribution, n); });
+            }
+        }
+        return finishBenchmark(options, allCorrect);
+    }
+    if (options.scaling) {
+        // speedup is against one worker, for weak scaling it counts the extra keys sorted in the same time
+        std::printf("# %u hardware threads\n", workerCount());
+        std::printf("%-7s %-11s %-7s %8s %12s %12s %9s %11s %s\n", "type", "dist", "mode", "workers", "n", "median_ms", "speedup",
+                    "efficiency", "check");
+        for (Distribution distribution : options.distributions) {
+            allCorrect &= forEachElementKind(options, [&](auto kind) { return benchScaling<decltype(kind)>(options, distribution); });
+        }
+        return finishBenchmark(options, allCorrect);
+    }
+
+    // ns/op is per element for sorts and per query for searches; cmp/n and moves/n come from the
+    // counting pass (for searches cmp/n is the comparisons of one query, a swap counts as three moves), moved_MB is
+    // moves times the element size.
+    // aux_peak_MB is the most scratch memory held at once and aux_MB the scratch handed out per sort.
+    std::printf("%-7s %-11s %-10s %10s %12s %10s %10s %10s %10s %11s %10s %s\n", "type", "dist", "algorithm", "n", "median_ms", "ns/op",
+                "cmp/n", "moves/n", "moved_MB", "aux_peak_MB", "aux_MB", "check");
+    for (Distribution distribution : options.distributions) {
+        for (Index n : options.sizes) {
+            allCorrect &= forEachElementKind(options, [&](auto kind) { return benchElementKind<decltype(kind)>(options, distribution, n); });
+        }
+    }
+    return finishBenchmark(options, allCorrect);
+}
+
+//.....................................| Memory-mapped datasets |.....................................//
+// Binary key dumps (native endian, fixed 4 or 8 byte unsigned keys) are mapped straight into the
+// address space and sorted or searched in place, the file is never copied into a vector.
+//   algori --dataset keys.bin --key-width 8 --sort quick [--output sorted.bin]
+//   algori --dataset keys.bin --key-width 8 --search binary --value 123456
+//   algori --dataset keys.bin --key-width 8 --make 100000000 [--dist uniform] [--seed 1]
+class MappedFile {
+public:
+    MappedFile() {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& path, bool writable, std::string& error) { // -> maps an existing file
+        close();
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ | (writable ? GENERIC_WRITE : 0), FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size;
+        if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size)) {
+            error = "cannot open " + path;
+            return false;
+        }
+        return map(std::size_t(size.QuadPart), writable, error);
+#else
+        fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            error = "cannot open " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        return map(std::size_t(info.st_size), writable, error);
+#endif
+    }
+
+    bool create(const std::string& path, std::size_t size, std::string& error) { // -> new file of `size` bytes, mapped writable
+        close();
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER length;
+        length.QuadPart = LONGLONG(size);
+        if (file == INVALID_HANDLE_VALUE || !SetFilePointerEx(file, length, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+            error = "cannot create " + path;
+            return false;
+        }
+#else
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || ftruncate(fd, off_t(size)) != 0) {
+            error = "cannot create " + path + ": " + std::strerror(errno);
+            return false;
+        }
+#endif
+        return map(size, true, error);
+    }
+
+    void advise(AccessPattern pattern, bool willNeed) { // -> kernel hints, no-ops where unsupported
+#if !defined(_WIN32)
+        if (bytes == 0) {
+            return;
+        }
+        int advice = pattern == AccessPattern::Sequential ? MADV_SEQUENTIAL
+                   : pattern == AccessPattern::Random ? MADV_RANDOM : MADV_NORMAL;
+        madvise(base, bytes, advice);
+        if (willNeed) {
+            madvise(base, bytes, MADV_WILLNEED);
+        }
+#else
+        (void)pattern;
+        (void)willNeed;
+#endif
+    }
+
+    bool flush() {
+        if (bytes == 0) {
+            return true;
+        }
+#if defined(_WIN32)
+        return FlushViewOfFile(base, 0) != 0;
+#else
+        return msync(base, bytes, MS_SYNC) == 0;
+#endif
+    }
+
+    void close() {
+#if defined(_WIN32)
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap(base, bytes);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        base = nullptr;
+        bytes = 0;
+    }
+
+    void* data() const { return base; }
+    std::size_t size() const { return bytes; }
+
+private:
+    bool map(std::size_t size, bool writable, std::string& error) {
+        bytes = size;
+        if (size == 0) {
+            return true; // -> an empty dataset is valid, there is just nothing to map
+        }
+#if defined(_WIN32)
+        mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+        base = mapping ? MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!base) {
+            error = "cannot map file";
+            bytes = 0;
+            return false;
+        }
+#else
+        void* address = mmap(nullptr, size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) {
+            error = std::string("cannot map file: ") + std::strerror(errno);
+            bytes = 0;
+            return false;
+        }
+        base = address;
+#endif
+        return true;
+    }
+
+    void* base = nullptr;
+    std::size_t bytes = 0;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+struct DatasetOptions {
+    std::string path;
+    std::string output;    // -> sort into this file instead of in place
+    int keyWidth = 8;
+    std::string sort;      // -> sort algorithm name
+    std::string search;    // -> search algorithm name
+    std::uint64_t value = 0;
+    Index make = -1;       // -> write a generated dataset of this many keys
+    Distribution distribution = Distribution::Uniform;
+    std::uint64_t seed = 1;
+};
+
+bool parseDatasetOptions(int argc, char** argv, DatasetOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--dataset") {
+            options.path = value;
+        } else if (arg == "--output") {
+            options.output = value;
+        } else if (arg == "--key-width") {
+            if (!parseNumber(arg, value, options.keyWidth)) {
+                return false;
             }
+        } else if (arg == "--sort") {
+            options.sort = value;
+        } else if (arg == "--search") {
+            options.search = value;
+        } else if (arg == "--value") {
+            if (!parseNumber(arg, value, options.value)) {
+                return false;
+            }
+        } else if (arg == "--make") {
+            if (!parseNumber(arg, value, options.make, Index(0))) {
+                return false;
+            }
+        } else if (arg == "--seed") {
+            if (!parseNumber(arg, value, options.seed)) {
+                return false;
+            }
+        } else if (arg == "--dist") {
+            if (!findDistribution(value, options.distribution)) {
+                std::cerr << "unknown distribution: " << value << "\n";
+                return false;
+            }
+        } else {
+            std::cerr << "unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.keyWidth != 4 && options.keyWidth != 8) {
+        std::cerr << "--key-width must be 4 or 8\n";
+        return false;
+    }
+    return true;
+}
+
+template <typename Key>
+int runDatasetKeys(const DatasetOptions& options) {
+    typedef std::chrono::steady_clock Clock;
+    std::string error;
+    MappedFile file;
+    auto start = Clock::now();
+
+    if (options.make >= 0) {
+        if (!file.create(options.path, std::size_t(options.make) * sizeof(Key), error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        GeneratorParams params;
+        params.seed = options.seed;
+        params.range = sizeof(Key) == 4 ? 1ULL << 32 : ~0ULL;
+        typedef typename std::conditional<sizeof(Key) == 4, UInt32Kind, UInt64Kind>::type Kind;
+        generateInput<Kind>(static_cast<Key*>(file.data()), options.make, options.distribution, params);
+        file.flush();
+        std::printf("wrote %lld keys to %s in %.1f ms\n", (long long)options.make, options.path.c_str(),
+                    std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        return 0;
+    }
+
+    bool inPlace = !options.sort.empty() && options.output.empty();
+    if (!file.open(options.path, inPlace, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    if (file.size() % sizeof(Key) != 0) {
+        std::cerr << options.path << " is not a whole number of " << sizeof(Key) << "-byte keys\n";
+        return 1;
+    }
+    Index n = Index(file.size() / sizeof(Key));
+
+    if (!options.sort.empty()) {
+        const SortEntry* entry = findSort(options.sort);
+        if (!entry) {
+            std::cerr << "unknown sort: " << options.sort << "\n";
+            return 1;
+        }
+        MappedFile output;
+        Key* keys = static_cast<Key*>(file.data());
+        if (!inPlace) { // -> page-to-page copy into the mapped output, then sort that mapping in place
+            if (!output.create(options.output, file.size(), error)) {
+                std::cerr << error << "\n";
+                return 1;
+            }
+            file.advise(AccessPattern::Sequential, true);
+            if (n > 0) {
+                std::memcpy(output.data(), file.data(), file.size());
+            }
+            keys = static_cast<Key*>(output.data());
+        }
+        MappedFile& target = inPlace ? file : output;
+        target.advise(entry->access, true);
+
+        auto sortStart = Clock::now();
+        NativePolicy obs;
+        sortFunction<Key, NativePolicy>(entry->id)(keys, n, obs);
+        double sortMs = std::chrono::duration<double, std::milli>(Clock::now() - sortStart).count();
+        target.advise(AccessPattern::Sequential, false);
+        bool sorted = std::is_sorted(keys, keys + n);
+        target.flush();
+        std::printf("%s: sorted %lld keys of %d bytes in %.1f ms (%.1f MB/s) -> %s [%s]\n", entry->name, (long long)n,
+                    int(sizeof(Key)), sortMs, file.size() / 1e3 / std::max(sortMs, 1e-3),
+                    inPlace ? options.path.c_str() : options.output.c_str(), sorted ? "ok" : "NOT SORTED");
+        return sorted ? 0 : 1;
+    }
+
+    if (!options.search.empty()) {
+        const SearchEntry* entry = findSearch(options.search);
+        if (!entry) {
+            std::cerr << "unknown search: " << options.search << "\n";
+            return 1;
+        }
+        file.advise(entry->access, false);
+        const Key* keys = static_cast<const Key*>(file.data());
+        Key needle = Key(options.value);
+        auto searchStart = Clock::now();
+        NativePolicy obs;
+        Index found = searchFunction<Key, NativePolicy>(entry->id)(keys, n, needle, obs);
+        double searchUs = std::chrono::duration<double, std::micro>(Clock::now() - searchStart).count();
+        if (found >= 0) {
+            std::printf("%s: %llu found at index %lld in %.1f us\n", entry->name, (unsigned long long)needle, (long long)found, searchUs);
+        } else {
+            std::printf("%s: %llu not found among %lld keys in %.1f us\n", entry->name, (unsigned long long)needle, (long long)n, searchUs);
+        }
+        return found >= 0 ? 0 : 1;
+    }
+
+    std::cerr << "nothing to do: pass --sort, --search or --make\n";
+    return 2;
+}
 
-            if (item != array[pos]) {
-                std::swap(item, array[pos]);
-                bars[pos].setFillColor(sf::Color::Red);
-                bars[pos].setSize(sf::Vector2f(BAR_WIDTH, array[pos]));
-                bars[pos].setPosition(pos * BAR_WIDTH, WINDOW_HEIGHT - array[pos]);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                bars[pos].setFillColor(sf::Color::White);
+int runDataset(const DatasetOptions& options) {
+    return options.keyWidth == 4 ? runDatasetKeys<std::uint32_t>(options) : runDatasetKeys<std::uint64_t>(options);
+}
+
+//.....................................| External merge sort |.....................................//
+// Sorts key dumps larger than RAM within a fixed memory budget:
+//   algori --external-sort keys.bin --output sorted.bin --key-width 8 [--memory-mb 256] [--fan-in K]
+//                          [--temp-dir DIR] [--run-sort quick] [--verify] [--probe-disk]
+// Phase 1 cuts the input into runs of half the budget, sorts each in memory and writes it while the
+// next one is read and sorted. Phase 2 merges up to K runs per pass; every input run and the output
+// are double buffered, so the next block is read (or the previous one written) while the current
+// block is merged.
+struct ExternalSortOptions {
+    std::string input;
+    std::string output;
+    std::string tempDir;  // -> defaults to the directory of the output
+    std::string runSort;  // -> registry sort used for the runs, empty means std::sort
+    int keyWidth = 8;
+    std::size_t memoryBytes = std::size_t(256) << 20;
+    std::size_t fanIn = 0; // -> 0 picks the widest merge that keeps blocks >= 256 KiB
+    bool verify = false;
+    bool probeDisk = false; // -> --probe-disk: measure the raw disk bandwidth first, for the final report
+};
+
+bool parseExternalSortOptions(int argc, char** argv, ExternalSortOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--verify") {
+            options.verify = true;
+            continue;
+        }
+        if (arg == "--probe-disk") {
+            options.probeDisk = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--external-sort") {
+            options.input = value;
+        } else if (arg == "--output") {
+            options.output = value;
+        } else if (arg == "--temp-dir") {
+            options.tempDir = value;
+        } else if (arg == "--run-sort") {
+            options.runSort = value;
+        } else if (arg == "--key-width") {
+            if (!parseNumber(arg, value, options.keyWidth)) {
+                return false;
             }
-
-            if (isPaused) {
-                while (isPaused) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                }
+        } else if (arg == "--memory-mb") {
+            std::size_t megabytes = 0;
+            if (!parseNumber(arg, value, megabytes, std::size_t(1), std::numeric_limits<std::size_t>::max() >> 20)) {
+                return false;
             }
-            if (resetRequested) {
-                resetRequested = false;
-                return;
+            options.memoryBytes = megabytes << 20;
+        } else if (arg == "--fan-in") {
+            if (!parseNumber(arg, value, options.fanIn)) {
+                return false;
             }
+        } else {
+            std::cerr << "unknown option: " << arg << "\n";
+            return false;
         }
     }
-    isArraySorted = true;
+    if (options.input.empty() || options.output.empty()) {
+        std::cerr << "--external-sort needs an input and --output\n";
+        return false;
+    }
+    if (options.keyWidth != 4 && options.keyWidth != 8) {
+        std::cerr << "--key-width must be 4 or 8\n";
+        return false;
+    }
+    if (options.tempDir.empty()) {
+        std::size_t slash = options.output.find_last_of("/\\");
+        options.tempDir = slash == std::string::npos ? "." : options.output.substr(0, slash);
+    }
+    return true;
 }
 
-//.....................................| Search functions |.....................................//
-void linearSearch() {
-    for (int i = 0; i < MAX_ARRAY_SIZE; ++i) {
-        if (array[i] == searchValue) {
-            boxes[i].setFillColor(sf::Color::Green);
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
-            searchCompleted = true;
-            return;
+class IoThread { // -> one background thread that runs queued reads in order, shared by all readers of a merge
+public:
+    IoThread() : worker([this] { serve(); }) {}
+    IoThread(const IoThread&) = delete;
+    IoThread& operator=(const IoThread&) = delete;
+    ~IoThread() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
         }
-        boxes[i].setFillColor(sf::Color::Red);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        if (isPaused) {
-            while (isPaused) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
+        wake.notify_one();
+        worker.join();
+    }
+
+    std::future<std::size_t> submit(std::function<std::size_t()> job) {
+        std::packaged_task<std::size_t()> task(std::move(job));
+        std::future<std::size_t> result = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(task));
         }
-        if (resetRequested) {
-            resetRequested = false;
-            return;
+        wake.notify_one();
+        return result;
+    }
+
+private:
+    void serve() {
+        for (;;) {
+            std::packaged_task<std::size_t()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) {
+                    return;
+                }
+                task = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            task();
         }
     }
-    searchCompleted = true;
-}
 
-void binarySearch() {
-    int left = 0, right = MAX_ARRAY_SIZE - 1;
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
-        boxes[mid].setFillColor(sf::Color::Yellow);
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        if (array[mid] == searchValue) {
-            boxes[mid].setFillColor(sf::Color::Green);
-            searchCompleted = true;
-            return;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::packaged_task<std::size_t()>> jobs;
+    bool stopping = false;
+    std::thread worker; // -> last, so it starts once the queue exists
+};
+
+template <typename Key>
+class RunReader { // -> streams one sorted run, the next block is read in the background by `io`
+public:
+    RunReader() {}
+    RunReader(const RunReader&) = delete;
+    RunReader& operator=(const RunReader&) = delete;
+    ~RunReader() { close(); }
+
+    bool open(const std::string& path, std::size_t blockKeys, IoThread& thread) {
+        io = &thread;
+        file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
         }
-        if (array[mid] < searchValue) {
-            left = mid + 1;
-        } else {
-            right = mid - 1;
+        buffers[0].resize(blockKeys);
+        buffers[1].resize(blockKeys);
+        current = 0;
+        position = 0;
+        count = std::fread(buffers[0].data(), sizeof(Key), blockKeys, file);
+        if (count == blockKeys) {
+            prefetch();
         }
-        if (isPaused) {
-            while (isPaused) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
+        return true;
+    }
+    bool empty() const { return position >= count; }
+    const Key& head() const { return buffers[current][position]; }
+    void pop() {
+        if (++position == count) {
+            advance();
         }
-        if (resetRequested) {
-            resetRequested = false;
-            return;
+    }
+    void close() {
+        if (pending.valid()) {
+            pending.wait();
+        }
+        if (file) {
+            std::fclose(file);
+            file = nullptr;
         }
     }
-    searchCompleted = true;
-}
 
-void ternarySearch() {
-    int left = 0, right = MAX_ARRAY_SIZE - 1;
-    while (left <= right) {
-        int mid1 = left + (right - left) / 3;
-        int mid2 = right - (right - left) / 3;
-        boxes[mid1].setFillColor(sf::Color::Yellow);
-        boxes[mid2].setFillColor(sf::Color::Yellow);
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        if (array[mid1] == searchValue) {
-            boxes[mid1].setFillColor(sf::Color::Green);
-            searchCompleted = true;
+private:
+    void prefetch() {
+        std::vector<Key>& next = buffers[current ^ 1];
+        std::FILE* source = file;
+        pending = io->submit([&next, source] { return std::fread(next.data(), sizeof(Key), next.size(), source); });
+    }
+    void advance() {
+        position = 0;
+        count = 0;
+        if (!pending.valid()) {
             return;
         }
-        if (array[mid2] == searchValue) {
-            boxes[mid2].setFillColor(sf::Color::Green);
-            searchCompleted = true;
-            return;
+        count = pending.get();
+        current ^= 1;
+        if (count == buffers[current].size()) {
+            prefetch();
         }
-        if (searchValue < array[mid1]) {
-            right = mid1 - 1;
-        } else if (searchValue > array[mid2]) {
-            left = mid2 + 1;
-        } else {
-            left = mid1 + 1;
-            right = mid2 - 1;
+    }
+
+    IoThread* io = nullptr;
+    std::FILE* file = nullptr;
+    std::vector<Key> buffers[2];
+    std::future<std::size_t> pending;
+    int current = 0;
+    std::size_t position = 0;
+    std::size_t count = 0;
+};
+
+template <typename Key>
+class BlockWriter { // -> collects keys into a block, full blocks are written in the background
+public:
+    BlockWriter() {}
+    BlockWriter(const BlockWriter&) = delete;
+    BlockWriter& operator=(const BlockWriter&) = delete;
+    ~BlockWriter() { close(); }
+
+    bool open(const std::string& path, std::size_t blockKeys) {
+        file = std::fopen(path.c_str(), "wb");
+        buffers[0].resize(blockKeys);
+        buffers[1].resize(blockKeys);
+        fill = 0;
+        ok = file != nullptr;
+        return ok;
+    }
+    void push(const Key& key) {
+        buffers[current][fill++] = key;
+        if (fill == buffers[current].size()) {
+            flushBlock();
         }
-        if (isPaused) {
-            while (isPaused) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    bool close() {
+        if (file) {
+            if (fill > 0) {
+                flushBlock();
             }
+            wait();
+            ok = std::fclose(file) == 0 && ok;
+            file = nullptr;
         }
-        if (resetRequested) {
-            resetRequested = false;
-            return;
+        return ok;
+    }
+
+private:
+    void wait() {
+        if (pending.valid()) {
+            ok = pending.get() && ok;
+        }
+    }
+    void flushBlock() {
+        wait(); // -> the other buffer must be on disk before it is refilled
+        const Key* data = buffers[current].data();
+        std::size_t keys = fill;
+        std::FILE* target = file;
+        pending = std::async(std::launch::async, [data, keys, target] {
+            return std::fwrite(data, sizeof(Key), keys, target) == keys;
+        });
+        current ^= 1;
+        fill = 0;
+    }
+
+    std::FILE* file = nullptr;
+    std::vector<Key> buffers[2];
+    std::future<bool> pending;
+    int current = 0;
+    std::size_t fill = 0;
+    bool ok = false;
+};
+
+struct DiskBandwidth {
+    double readMBs = 0.0;
+    double writeMBs = 0.0;
+};
+
+// Raw sequential throughput of the disk under the run files, as the reference for the sort (--probe-disk):
+// `bytes` of a scratch file are written and flushed, dropped from the page cache, then read back. The
+// input itself is not read, so the probe neither measures cached pages nor warms them for phase 1.
+DiskBandwidth probeDiskBandwidth(const std::string& scratch, std::size_t bytes) {
+    typedef std::chrono::steady_clock Clock;
+    DiskBandwidth result;
+    const std::size_t blockBytes = std::size_t(8) << 20;
+    std::vector<char> block(blockBytes);
+    std::FILE* file = std::fopen(scratch.c_str(), "wb");
+    if (!file) {
+        return result;
+    }
+    auto start = Clock::now();
+    bool ok = true;
+    for (std::size_t done = 0; ok && done < bytes; done += blockBytes) {
+        std::size_t size = std::min(blockBytes, bytes - done);
+        ok = std::fwrite(block.data(), 1, size, file) == size;
+    }
+    ok = std::fflush(file) == 0 && ok;
+#if !defined(_WIN32)
+    ok = fsync(fileno(file)) == 0 && ok;
+#endif
+    ok = std::fclose(file) == 0 && ok;
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (ok) {
+        result.writeMBs = bytes / 1e6 / std::max(seconds, 1e-9);
+    }
+
+#if defined(_WIN32)
+    // -> unbuffered reads bypass the cache; they need sector-aligned sizes and a page-aligned buffer
+    HANDLE handle = ok ? CreateFileA(scratch.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING,
+                                     nullptr)
+                       : INVALID_HANDLE_VALUE;
+    void* aligned = VirtualAlloc(nullptr, blockBytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (handle != INVALID_HANDLE_VALUE && aligned) {
+        start = Clock::now();
+        std::size_t total = 0;
+        DWORD got = 0;
+        while (ReadFile(handle, aligned, DWORD(blockBytes), &got, nullptr) && got > 0) {
+            total += got;
+        }
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.readMBs = total / 1e6 / std::max(seconds, 1e-9);
+    }
+    if (aligned) {
+        VirtualFree(aligned, 0, MEM_RELEASE);
+    }
+    if (handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(handle);
+    }
+#else
+    int fd = ok ? ::open(scratch.c_str(), O_RDONLY) : -1;
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED); // -> the pages are clean after fsync, so this empties the cache
+        start = Clock::now();
+        std::size_t total = 0;
+        ssize_t got;
+        while ((got = ::read(fd, block.data(), blockBytes)) > 0) {
+            total += std::size_t(got);
         }
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.readMBs = total / 1e6 / std::max(seconds, 1e-9);
+        ::close(fd);
     }
-    searchCompleted = true;
+#endif
+    std::remove(scratch.c_str());
+    return result;
 }
 
-//.....................................| Tree traversal functions |.....................................//
-void bfs(int start) {
-    std::lock_guard<std::mutex> guard(mtx);
+// Moves a finished file into place, replacing `to` only once the new contents are complete. A plain
+// rename fails across filesystems (a --temp-dir on another disk), so that case copies next to `to` first.
+bool moveFile(const std::string& from, const std::string& to) {
+    std::error_code error;
+    std::filesystem::rename(from, to, error);
+    if (!error) {
+        return true;
+    }
+    std::string temp = to + ".tmp";
+    std::filesystem::copy_file(from, temp, std::filesystem::copy_options::overwrite_existing, error);
+    if (!error) {
+        std::filesystem::rename(temp, to, error);
+    }
+    if (error) {
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    std::filesystem::remove(from, error);
+    return true;
+}
 
-    std::queue<int> q;
-    q.push(start);
-    visited[start] = true;
-    traversalPath.push_back(start);
-    while (!q.empty()) {
-        int node = q.front();
-        q.pop();
-        nodes[node].setFillColor(sf::Color::Green);
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        if (node == targetNode) {
-            traversalCompleted = true;
-            return;
+// Merges `inputs` into `output`. `progress` is called with the number of keys written so far.
+template <typename Key, typename Progress>
+bool mergeRunFiles(const std::vector<std::string>& inputs, const std::string& output, std::size_t blockKeys, Progress progress) {
+    IoThread io; // -> declared first, so the readers finish their reads before it stops
+    std::vector<std::unique_ptr<RunReader<Key>>> readers;
+    for (const auto& path : inputs) {
+        readers.emplace_back(new RunReader<Key>());
+        if (!readers.back()->open(path, blockKeys, io)) {
+            std::cerr << "cannot open run " << path << "\n";
+            return false;
         }
-        for (int neighbor : tree[node]) {
-            if (!visited[neighbor]) {
-                visited[neighbor] = true;
-                q.push(neighbor);
-                traversalPath.push_back(neighbor);
-            }
+    }
+    BlockWriter<Key> writer;
+    if (!writer.open(output, blockKeys)) {
+        std::cerr << "cannot create " << output << "\n";
+        return false;
+    }
+
+    // The loser tree costs one comparison per level on the winner's path, where a binary heap
+    // pays two per level on pop plus the sift-up of the push.
+    LoserTree tree;
+    tree.reset(readers.size());
+    for (std::size_t r = 0; r < readers.size(); ++r) {
+        if (readers[r]->empty()) {
+            tree.exhaust(r);
         }
-        if (isPaused) {
-            while (isPaused) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
+    }
+    auto less = [&](std::size_t x, std::size_t y) { return readers[x]->head() < readers[y]->head(); };
+    tree.build(less);
+    unsigned long long written = 0;
+    while (!tree.empty()) {
+        std::size_t r = tree.winner();
+        writer.push(readers[r]->head());
+        readers[r]->pop();
+        if (readers[r]->empty()) {
+            tree.exhaust(r);
         }
-        if (resetRequested) {
-            resetRequested = false;
-            return;
+        tree.replay(less);
+        if ((++written & 0xFFFFF) == 0) {
+            progress(written);
         }
     }
-    traversalCompleted = true;
-    isTreeTraversal = false;
+    progress(written);
+    return writer.close();
 }
 
-void dfs(int start) {
-    std::lock_guard<std::mutex> guard(mtx);
+template <typename Key>
+int runExternalSortKeys(const ExternalSortOptions& options) {
+    typedef std::chrono::steady_clock Clock;
+    auto start = Clock::now();
+    auto elapsedMs = [](Clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+    };
 
-    std::stack<int> s;
-    s.push(start);
-    visited[start] = true;
-    traversalPath.push_back(start);
-    while (!s.empty()) {
-        int node = s.top();
-        s.pop();
-        nodes[node].setFillColor(sf::Color::Blue);
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        if (node == targetNode) {
-            traversalCompleted = true;
-            return;
+    std::FILE* input = std::fopen(options.input.c_str(), "rb");
+    if (!input) {
+        std::cerr << "cannot open " << options.input << "\n";
+        return 1;
+    }
+    // ftell returns a 32-bit long on MinGW, which cannot describe the >2 GiB inputs this mode is for.
+    std::error_code sizeError;
+    unsigned long long inputBytes = std::filesystem::file_size(options.input, sizeError);
+    if (sizeError) {
+        std::cerr << "cannot size " << options.input << ": " << sizeError.message() << "\n";
+        std::fclose(input);
+        return 1;
+    }
+    if (inputBytes % sizeof(Key) != 0) {
+        std::cerr << options.input << " is not a whole number of " << sizeof(Key) << "-byte keys\n";
+        std::fclose(input);
+        return 1;
+    }
+    const SortEntry* runSort = options.runSort.empty() ? nullptr : findSort(options.runSort);
+    if (!options.runSort.empty() && !runSort) {
+        std::cerr << "unknown sort: " << options.runSort << "\n";
+        std::fclose(input);
+        return 1;
+    }
+
+    std::string stem = options.tempDir + "/" + options.output.substr(options.output.find_last_of("/\\") + 1);
+    DiskBandwidth disk;
+    if (options.probeDisk) {
+        std::size_t probeBytes = std::size_t(std::min<unsigned long long>(inputBytes, 1ULL << 30));
+        disk = probeDiskBandwidth(stem + ".probe", std::max<std::size_t>(probeBytes, std::size_t(64) << 20));
+        std::printf("disk: sequential read %.1f MB/s, write %.1f MB/s\n", disk.readMBs, disk.writeMBs);
+        start = Clock::now(); // -> the probe is not part of the sort's time
+    }
+
+    // Phase 1: run generation. Two buffers of half the budget: one is sorted while the other is written.
+    std::size_t runKeys = std::max<std::size_t>(1, options.memoryBytes / 2 / sizeof(Key));
+    std::vector<Key> buffers[2];
+    std::future<bool> pendingWrite;
+    std::vector<std::string> runs;
+    unsigned long long totalRuns = (inputBytes / sizeof(Key) + runKeys - 1) / runKeys;
+    auto phaseStart = Clock::now();
+    bool ok = true;
+    for (int current = 0;; current ^= 1) {
+        buffers[current].resize(runKeys);
+        std::size_t got = std::fread(buffers[current].data(), sizeof(Key), runKeys, input);
+        if (got == 0) {
+            break;
         }
-        for (int neighbor : tree[node]) {
-            if (!visited[neighbor]) {
-                visited[neighbor] = true;
-                s.push(neighbor);
-                traversalPath.push_back(neighbor);
-            }
+        buffers[current].resize(got);
+        auto sortStart = Clock::now();
+        if (runSort) {
+            NativePolicy obs;
+            sortFunction<Key, NativePolicy>(runSort->id)(buffers[current].data(), Index(got), obs);
+        } else {
+            std::sort(buffers[current].begin(), buffers[current].end());
         }
-        if (isPaused) {
-            while (isPaused) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        double sortMs = elapsedMs(sortStart);
+        if (pendingWrite.valid()) {
+            ok = pendingWrite.get() && ok;
+        }
+        std::string path = stem + ".run0." + std::to_string(runs.size());
+        runs.push_back(path);
+        const std::vector<Key>* block = &buffers[current];
+        pendingWrite = std::async(std::launch::async, [block, path] {
+            std::FILE* file = std::fopen(path.c_str(), "wb");
+            bool written = file && std::fwrite(block->data(), sizeof(Key), block->size(), file) == block->size();
+            return file && std::fclose(file) == 0 && written;
+        });
+        std::printf("run %zu/%llu: %zu keys sorted in %.1f ms\n", runs.size(), totalRuns, got, sortMs);
+        std::fflush(stdout);
+    }
+    if (pendingWrite.valid()) {
+        ok = pendingWrite.get() && ok;
+    }
+    std::fclose(input);
+    buffers[0] = std::vector<Key>();
+    buffers[1] = std::vector<Key>();
+    if (!ok) {
+        std::cerr << "failed to write runs to " << options.tempDir << "\n";
+        return 1;
+    }
+    double runMs = elapsedMs(phaseStart);
+    std::printf("run generation: %zu runs in %.1f ms (%.1f MB/s)\n", runs.size(), runMs, inputBytes / 1e3 / std::max(runMs, 1e-3));
+
+    // Phase 2: merge passes, fanIn runs at a time, until one run is left.
+    const std::size_t minBlockBytes = std::size_t(256) << 10;
+    std::size_t fanIn = options.fanIn >= 2 ? options.fanIn
+                      : std::max<std::size_t>(2, options.memoryBytes / (2 * minBlockBytes) - 1);
+    int pass = 0;
+    unsigned long long totalKeys = inputBytes / sizeof(Key);
+    while (runs.size() > 1) {
+        pass++;
+        auto passStart = Clock::now();
+        std::size_t groups = (runs.size() + fanIn - 1) / fanIn;
+        bool last = groups == 1;
+        std::size_t width = std::min(fanIn, runs.size());
+        std::size_t blockKeys = std::max<std::size_t>(1, options.memoryBytes / (2 * (width + 1)) / sizeof(Key));
+        std::printf("pass %d: merging %zu runs into %zu (fan-in %zu, %zu KiB blocks)\n", pass, runs.size(), groups,
+                    width, blockKeys * sizeof(Key) >> 10);
+        std::vector<std::string> next;
+        unsigned long long mergedBefore = 0;
+        for (std::size_t g = 0; g < groups; ++g) {
+            std::vector<std::string> group(runs.begin() + g * fanIn, runs.begin() + std::min(runs.size(), (g + 1) * fanIn));
+            std::string target = last ? options.output : stem + ".run" + std::to_string(pass) + "." + std::to_string(g);
+            if (group.size() == 1) { // -> a lone trailing run moves to the next pass untouched
+                next.push_back(group[0]);
+                continue;
             }
+            int lastPercent = -1;
+            unsigned long long base = mergedBefore;
+            ok = mergeRunFiles<Key>(group, target, blockKeys, [&](unsigned long long written) {
+                int percent = int(100.0 * (base + written) / std::max(1ULL, totalKeys));
+                if (percent / 10 != lastPercent / 10) {
+                    std::printf("  pass %d: %3d%%\n", pass, percent);
+                    std::fflush(stdout);
+                    lastPercent = percent;
+                }
+                mergedBefore = base + written;
+            });
+            for (const auto& path : group) {
+                std::remove(path.c_str());
+            }
+            if (!ok) {
+                std::cerr << "merge pass " << pass << " failed\n";
+                return 1;
+            }
+            next.push_back(target);
         }
-        if (resetRequested) {
-            resetRequested = false;
-            return;
+        runs.swap(next);
+        double passMs = elapsedMs(passStart);
+        std::printf("pass %d: done in %.1f ms (%.1f MB/s)\n", pass, passMs, inputBytes / 1e3 / std::max(passMs, 1e-3));
+    }
+    if (runs.size() == 1 && runs[0] != options.output) { // -> the input fit in a single run
+        if (!moveFile(runs[0], options.output)) {
+            std::cerr << "cannot move " << runs[0] << " to " << options.output << "\n";
+            return 1;
+        }
+    } else if (runs.empty()) {
+        std::FILE* empty = std::fopen(options.output.c_str(), "wb");
+        if (empty) {
+            std::fclose(empty);
         }
     }
-    traversalCompleted = true;
-    isTreeTraversal = false;
-}
 
-//.....................................| Init. funcs |.....................................//
-void startSorting() {
-    
-    if (currentThread.joinable()) {
-        currentThread.join();
+    double totalMs = elapsedMs(start);
+    double sustained = inputBytes / 1e3 / std::max(totalMs, 1e-3);
+    double ioVolume = 2.0 * inputBytes * (1 + pass); // -> every pass reads and writes everything once
+    std::printf("external sort: %llu keys, %d merge pass%s, %.1f ms\n", totalKeys, pass, pass == 1 ? "" : "es", totalMs);
+    std::printf("sustained %.1f MB/s of input, %.1f MB/s of I/O", sustained, ioVolume / 1e3 / std::max(totalMs, 1e-3));
+    if (options.probeDisk) {
+        std::printf("; raw disk read %.1f MB/s, write %.1f MB/s", disk.readMBs, disk.writeMBs);
     }
-    
-    if (currentAlgorithm == "bubble") {
-        bubbleSort();
-    } else if (currentAlgorithm == "insertion") {
-        insertionSort();
-    } else if (currentAlgorithm == "selection") {
-        selectionSort();
-    } else if (currentAlgorithm == "quick") {
-        quickSort(0, NUM_BARS - 1);
-    } else if (currentAlgorithm == "merge") {
-        mergeSort(0, NUM_BARS - 1);
-    } else if (currentAlgorithm == "heap") {
-        heapSort();
-    } else if (currentAlgorithm == "bucket") {
-        bucketSort();
-    } else if (currentAlgorithm == "gnome") {
-        gnomeSort();
-    } else if (currentAlgorithm == "tim") {
-        timSort();
-    } else if (currentAlgorithm == "cycle") {
-        cycleSort();
+    std::printf("\n");
+
+    if (options.verify) {
+        IoThread io;
+        RunReader<Key> check;
+        bool sorted = check.open(options.output, std::size_t(1) << 20, io);
+        unsigned long long count = 0;
+        Key previous = Key();
+        for (; sorted && !check.empty(); check.pop(), ++count) {
+            sorted = count == 0 || !(check.head() < previous);
+            previous = check.head();
+        }
+        sorted = sorted && count == totalKeys;
+        std::printf("verify: %s\n", sorted ? "ok" : "NOT SORTED");
+        return sorted ? 0 : 1;
     }
-    isSorting = false;
+    return 0;
 }
 
-void startSearching() {
+int runExternalSort(const ExternalSortOptions& options) {
+    return options.keyWidth == 4 ? runExternalSortKeys<std::uint32_t>(options) : runExternalSortKeys<std::uint64_t>(options);
+}
 
-    if (currentThread.joinable()) {
-        currentThread.join();
+//.....................................| Streaming mode |.....................................//
+// Headless online sort, one row per buffer:
+//   algori --stream gen|FILE|- [--buffer btree,lsm] [--rate 100000] [--n 1000000] [--dist uniform]
+//                  [--seed 1] [--view-ms 50] [--report-ms 1000]
+// gen replays --n keys generated from --dist; a FILE or - (stdin) is read as integers separated by
+// anything else, up to its end. Stdin feeds the first buffer as it arrives and is replayed to the rest. --rate paces the ingest in keys per second, 0 is as fast as possible.
+bool parseStreamOptions(int argc, char** argv, StreamOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--stream") {
+            options.source = value;
+        } else if (arg == "--buffer") {
+            options.buffers = splitList(value);
+        } else if (arg == "--rate") {
+            if (!parseNumber(arg, value, options.rate, 0.0)) {
+                return false;
+            }
+        } else if (arg == "--n") {
+            if (!parseNumber(arg, value, options.n, Index(0))) {
+                return false;
+            }
+        } else if (arg == "--seed") {
+            if (!parseNumber(arg, value, options.seed)) {
+                return false;
+            }
+        } else if (arg == "--view-ms") {
+            if (!parseNumber(arg, value, options.viewMs, 1)) {
+                return false;
+            }
+        } else if (arg == "--report-ms") {
+            if (!parseNumber(arg, value, options.reportMs, 0)) {
+                return false;
+            }
+        } else if (arg == "--dist") {
+            if (!findDistribution(value, options.distribution)) {
+                std::cerr << "unknown distribution: " << value << "\n";
+                return false;
+            }
+        } else {
+            std::cerr << "unknown option: " << arg << "\n";
+            return false;
+        }
     }
-
-    if (currentAlgorithm == "linear") {
-        linearSearch();
-    } else if (currentAlgorithm == "binary") {
-        binarySearch();
-    } else if (currentAlgorithm == "ternary") {
-        ternarySearch();
+    for (const auto& name : options.buffers) {
+        if (std::none_of(std::begin(streamBufferRegistry), std::end(streamBufferRegistry), [&](const StreamBufferEntry& entry) { return name == entry.name; })) {
+            std::cerr << "unknown buffer: " << name << " (btree, lsm)\n";
+            return false;
+        }
     }
-    isSearching = false;
+    return true;
 }
 
-void startTreeTraversal() {
-
-    if (currentThread.joinable()) {
-        currentThread.join();
+int runStreamMode(const StreamOptions& options) { // -> 0 ok, 1 a buffer lost or misordered keys, 2 unreadable source
+    traceThreadName("stream");
+    std::printf("# stream %s", options.source.c_str());
+    if (options.source == "gen") {
+        std::printf(" (%s, n=%lld, seed %llu)", distributionNames[std::size_t(options.distribution)], (long long)options.n,
+                    (unsigned long long)options.seed);
     }
-
-    if (currentAlgorithm == "bfs") {
-        bfs(0);
-    } else if (currentAlgorithm == "dfs") {
-        dfs(0);
+    std::printf(", rate %s, view every %d ms\n", options.rate > 0 ? std::to_string((long long)options.rate).c_str() : "unlimited", options.viewMs);
+    std::fflush(stdout);
+
+    // ingest/s counts inserts over the ingest time; visible/s counts the keys of the final view over
+    // the time until it was ready; the percentiles are insert latencies; behind_ms is the largest lag
+    // behind the --rate schedule; view_ms is the reader's time per view.
+    std::vector<std::string> rows;
+    bool allSorted = true;
+    std::vector<StreamKey> piped; // -> stdin can be read only once: the first buffer takes it live, the others replay it
+    bool pipedRead = false;
+    for (const auto& entry : streamBufferRegistry) {
+        if (!isSelected(options.buffers, entry.name)) {
+            continue;
+        }
+        StreamSource source;
+        std::string error;
+        if (pipedRead) {
+            source.replay(piped);
+        } else if (!source.open(options, error)) {
+            std::cerr << error << "\n";
+            return 2;
+        } else if (options.source == "-") {
+            source.record(&piped);
+        }
+        TraceSpan span(entry.name, "stream");
+        StreamStatus status;
+        auto lastReport = std::chrono::steady_clock::now();
+        StreamReport report = entry.run(source, options, NUM_BARS, nullptr, status, [&](const std::vector<StreamKey>&, Index visible) {
+            auto now = std::chrono::steady_clock::now();
+            if (options.reportMs > 0 && now - lastReport >= std::chrono::milliseconds(options.reportMs)) {
+                lastReport = now;
+                std::printf("# %s: %lld keys, %lld visible, %.0f keys/s, insert p50 %lld ns, p99 %lld ns\n", entry.name, status.inserted.load(),
+                            (long long)visible, status.keysPerSecond.load(), status.p50Ns.load(), status.p99Ns.load());
+                std::fflush(stdout);
+            }
+        });
+        pipedRead = options.source == "-";
+        const LatencyHistogram& latency = report.latency;
+        char row[320];
+        std::snprintf(row, sizeof(row), "%-6s %11lld %11.0f %11.0f %8llu %8llu %8llu %9llu %10llu %10.2f %7lld %8.3f %8.3f  %-36s %s",
+                      entry.name, (long long)report.inserted, report.inserted / std::max(report.ingestSeconds, 1e-9),
+                      report.inserted / std::max(report.visibleSeconds, 1e-9), (unsigned long long)latency.percentile(50),
+                      (unsigned long long)latency.percentile(90), (unsigned long long)latency.percentile(99),
+                      (unsigned long long)latency.percentile(99.9), (unsigned long long)latency.max(), report.behindMs, (long long)report.views,
+                      report.viewMsTotal / std::max<Index>(1, report.views), report.viewMsMax, report.shape.c_str(), report.sorted ? "ok" : "NOT SORTED");
+        rows.push_back(row);
+        allSorted = allSorted && report.sorted;
     }
-    isTreeTraversal = false;
+    std::printf("%-6s %11s %11s %11s %8s %8s %8s %9s %10s %10s %7s %8s %8s  %-36s %s\n", "buffer", "keys", "ingest/s", "visible/s", "p50_ns",
+                "p90_ns", "p99_ns", "p99.9_ns", "max_ns", "behind_ms", "views", "view_ms", "max_view", "shape", "check");
+    for (const auto& row : rows) {
+        std::printf("%s\n", row.c_str());
+    }
+    return allSorted ? 0 : 1;
 }
 
-void resetAll() {
-    
-    resetRequested = true;
-
-    if (currentThread.joinable()) {
-        currentThread.join();
+//.....................................| Main function |.....................................//
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        BenchOptions options;
+        if (!parseBenchOptions(argc, argv, options)) {
+            return 2;
+        }
+        return runBenchmark(options);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--dataset") {
+        DatasetOptions options;
+        if (!parseDatasetOptions(argc, argv, options)) {
+            return 2;
+        }
+        return runDataset(options);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--stream") {
+        StreamOptions options;
+        if (!parseStreamOptions(argc, argv, options)) {
+            return 2;
+        }
+        return runStreamMode(options);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--external-sort") {
+        ExternalSortOptions options;
+        if (!parseExternalSortOptions(argc, argv, options)) {
+            return 2;
+        }
+        return runExternalSort(options);
     }
 
-    isSorting = false;
-    isSearching = false;
-    isTreeTraversal = false;
-    isPaused = false;
-    searchCompleted = false;
-    traversalCompleted = false;
-    if (visualizationType == "sort") {
-        resetArray();
-    } else if (visualizationType == "tree") {
-        resetTree();
-    } else if (visualizationType == "search") {
-        resetSearchArray();
+    visualSeed = std::random_device()();
+    std::string tracePath;
+    int servePort = 0;
+    GraphKind treeKind = GraphKind::KaryTree;
+    GraphParams treeParams;
+    treeParams.nodes = 7;
+    // -> window mode accepts --seed N, --dist name, --trace file, --serve port, --map file, --hud, --cost-model file,
+    //    --source gen|FILE|- and --rate N for the Stream view,
+    //    and --tree kary|tree, --tree-nodes N (1..127) and --arity K for the traversal tree
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--hud") {
+            hud.visible = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            break;
+        }
+        const char* value = argv[++i];
+        if (arg == "--tree" && (!findGraphKind(value, treeKind) || (treeKind != GraphKind::KaryTree && treeKind != GraphKind::RandomTree))) {
+            std::cerr << "unknown tree: " << value << " (kary, tree)\n";
+            return 2;
+        } else if (arg == "--tree-nodes" && !parseNumber(arg, value, treeParams.nodes, Index(1), Index(127))) {
+            return 2;
+        } else if (arg == "--arity" && !parseNumber(arg, value, treeParams.arity, Index(1))) {
+            return 2;
+        } else if (arg == "--map") {
+            std::string error;
+            if (!loadGridMap(value, gridView.map, error)) {
+                std::cerr << error << "\n";
+                return 2;
+            }
+            gridView.loaded = true;
+        } else if (arg == "--cost-model") {
+            costModelPath = value;
+        } else if (arg == "--source") {
+            visualStreamSource = value;
+        } else if (arg == "--rate" && !parseNumber(arg, value, visualStreamRate, 0.0)) {
+            return 2;
+        } else if (arg == "--trace") {
+            tracePath = value;
+        } else if (arg == "--serve" && !parseNumber(arg, value, servePort, 0, 65535)) {
+            return 2;
+        } else if (arg == "--seed" && !parseNumber(arg, value, visualSeed)) {
+            return 2;
+        } else if (arg == "--dist" && !findDistribution(value, visualDistribution)) {
+            std::cerr << "unknown distribution: " << value << "\n";
+            return 2;
+        }
     }
-}
+    std::cout << "seed " << visualSeed << " (rerun with --seed " << visualSeed << " to replay these inputs)" << std::endl;
+    traceThreadName("render");
+    traceEnabled = !tracePath.empty();
 
-//.....................................| Main function |.....................................//
-int main() {
     sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), " ALGORI @FECORO | Algorithm Visualizer");
     if (!font.loadFromFile("arial.ttf")) {
         return -1;
     }
+    if (!chromeTexture.create(WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        return -1;
+    }
+    sf::Sprite chromeSprite(chromeTexture.getTexture());
 
-    sf::Text algorithmText;
-    algorithmText.setFont(font);
-    algorithmText.setCharacterSize(20);
-    algorithmText.setFillColor(sf::Color::White);
-    algorithmText.setPosition(10, 10);
-
-    sf::RectangleShape startButton(sf::Vector2f(100, 50));
-    startButton.setPosition(10, 50);
-    startButton.setFillColor(sf::Color(144, 238, 144)); // ... pastel green ...
-
-    sf::Text startText;
-    startText.setFont(font);
-    startText.setString("Start");
-    startText.setCharacterSize(20);
-    startText.setFillColor(sf::Color::Black);
-    startText.setPosition(20, 60);
-
-    sf::RectangleShape pauseButton(sf::Vector2f(100, 50));
-    pauseButton.setPosition(120, 50);
-    pauseButton.setFillColor(sf::Color(255, 182, 193)); // ... pastel pink ...
-
-    sf::Text pauseText;
-    pauseText.setFont(font);
-    pauseText.setString("Pause");
-    pauseText.setCharacterSize(20);
-    pauseText.setFillColor(sf::Color::Black);
-    pauseText.setPosition(130, 60);
-
-    sf::RectangleShape resetButton(sf::Vector2f(100, 50));
-    resetButton.setPosition(230, 50);
-    resetButton.setFillColor(sf::Color(255, 160, 122)); // ... pastel orange ...
-
-    sf::Text resetText;
-    resetText.setFont(font);
-    resetText.setString("Reset");
-    resetText.setCharacterSize(20);
-    resetText.setFillColor(sf::Color::Black);
-    resetText.setPosition(240, 60);
-
-    sf::RectangleShape sortButton(sf::Vector2f(150, 50));
-    sortButton.setPosition(10, 110);
-    sortButton.setFillColor(sf::Color(173, 216, 230)); // ... pastel blue ...
-
-    sf::Text sortText;
-    sortText.setFont(font);
-    sortText.setString("Sort");
-    sortText.setCharacterSize(20);
-    sortText.setFillColor(sf::Color::Black);
-    sortText.setPosition(20, 120);
-
-    sf::RectangleShape searchButton(sf::Vector2f(150, 50));
-    searchButton.setPosition(10, 170);
-    searchButton.setFillColor(sf::Color(221, 160, 221)); // ... pastel purple ...
-
-    sf::Text searchText;
-    searchText.setFont(font);
-    searchText.setString("Search");
-    searchText.setCharacterSize(20);
-    searchText.setFillColor(sf::Color::Black);
-    searchText.setPosition(20, 180);
-
-    sf::RectangleShape treeButton(sf::Vector2f(150, 50));
-    treeButton.setPosition(10, 230);
-    treeButton.setFillColor(sf::Color(255, 218, 185)); // ... pastel peach ...
-
-    sf::Text treeText;
-    treeText.setFont(font);
-    treeText.setString("Tree");
-    treeText.setCharacterSize(20);
-    treeText.setFillColor(sf::Color::Black);
-    treeText.setPosition(20, 240);
-
-    sf::RectangleShape bubbleSortButton(sf::Vector2f(150, 50));
-    bubbleSortButton.setPosition(10, 290);
-    bubbleSortButton.setFillColor(sf::Color(173, 216, 230)); // ... pastel blue ...
-
-    sf::Text bubbleSortText;
-    bubbleSortText.setFont(font);
-    bubbleSortText.setString("Bubble Sort");
-    bubbleSortText.setCharacterSize(20);
-    bubbleSortText.setFillColor(sf::Color::Black);
-    bubbleSortText.setPosition(20, 300);
-
-    sf::RectangleShape quickSortButton(sf::Vector2f(150, 50));
-    quickSortButton.setPosition(10, 350);
-    quickSortButton.setFillColor(sf::Color(221, 160, 221)); // ... pastel purple ...
-
-    sf::Text quickSortText;
-    quickSortText.setFont(font);
-    quickSortText.setString("Quick Sort");
-    quickSortText.setCharacterSize(20);
-    quickSortText.setFillColor(sf::Color::Black);
-    quickSortText.setPosition(20, 360);
-
-    sf::RectangleShape insertionSortButton(sf::Vector2f(150, 50));
-    insertionSortButton.setPosition(10, 410);
-    insertionSortButton.setFillColor(sf::Color(255, 182, 193)); // ... pastel pink ...
-
-    sf::Text insertionSortText;
-    insertionSortText.setFont(font);
-    insertionSortText.setString("Insertion Sort");
-    insertionSortText.setCharacterSize(20);
-    insertionSortText.setFillColor(sf::Color::Black);
-    insertionSortText.setPosition(20, 420);
-
-    sf::RectangleShape selectionSortButton(sf::Vector2f(150, 50));
-    selectionSortButton.setPosition(10, 470);
-    selectionSortButton.setFillColor(sf::Color(144, 238, 144)); // ... pastel green ...
-
-    sf::Text selectionSortText;
-    selectionSortText.setFont(font);
-    selectionSortText.setString("Selection Sort");
-    selectionSortText.setCharacterSize(20);
-    selectionSortText.setFillColor(sf::Color::Black);
-    selectionSortText.setPosition(20, 480);
-
-    sf::RectangleShape mergeSortButton(sf::Vector2f(150, 50));
-    mergeSortButton.setPosition(10, 530);
-    mergeSortButton.setFillColor(sf::Color(255, 160, 122)); // ... pastel orange ...
-
-    sf::Text mergeSortText;
-    mergeSortText.setFont(font);
-    mergeSortText.setString("Merge Sort");
-    mergeSortText.setCharacterSize(20);
-    mergeSortText.setFillColor(sf::Color::Black);
-    mergeSortText.setPosition(20, 540);
-
-    sf::RectangleShape heapSortButton(sf::Vector2f(150, 50));
-    heapSortButton.setPosition(10, 590);
-    heapSortButton.setFillColor(sf::Color(173, 216, 230)); // ... pastel blue ...
-
-    sf::Text heapSortText;
-    heapSortText.setFont(font);
-    heapSortText.setString("Heap Sort");
-    heapSortText.setCharacterSize(20);
-    heapSortText.setFillColor(sf::Color::Black);
-    heapSortText.setPosition(20, 600);
-
-    sf::RectangleShape bucketSortButton(sf::Vector2f(150, 50));
-    bucketSortButton.setPosition(10, 650);
-    bucketSortButton.setFillColor(sf::Color(221, 160, 221)); // ... pastel purple ...
-
-    sf::Text bucketSortText;
-    bucketSortText.setFont(font);
-    bucketSortText.setString("Bucket Sort");
-    bucketSortText.setCharacterSize(20);
-    bucketSortText.setFillColor(sf::Color::Black);
-    bucketSortText.setPosition(20, 660);
-
-    sf::RectangleShape gnomeSortButton(sf::Vector2f(150, 50));
-    gnomeSortButton.setPosition(10, 710);
-    gnomeSortButton.setFillColor(sf::Color(255, 182, 193)); // ... pastel pink ...
-
-    sf::Text gnomeSortText;
-    gnomeSortText.setFont(font);
-    gnomeSortText.setString("Gnome Sort");
-    gnomeSortText.setCharacterSize(20);
-    gnomeSortText.setFillColor(sf::Color::Black);
-    gnomeSortText.setPosition(20, 720);
-
-    sf::RectangleShape timSortButton(sf::Vector2f(150, 50));
-    timSortButton.setPosition(10, 770);
-    timSortButton.setFillColor(sf::Color(144, 238, 144)); // ... pastel green ...
-
-    sf::Text timSortText;
-    timSortText.setFont(font);
-    timSortText.setString("Tim Sort");
-    timSortText.setCharacterSize(20);
-    timSortText.setFillColor(sf::Color::Black);
-    timSortText.setPosition(20, 780);
-
-    sf::RectangleShape cycleSortButton(sf::Vector2f(150, 50));
-    cycleSortButton.setPosition(10, 830);
-    cycleSortButton.setFillColor(sf::Color(255, 160, 122)); // ... pastel orange ...
-
-    sf::Text cycleSortText;
-    cycleSortText.setFont(font);
-    cycleSortText.setString("Cycle Sort");
-    cycleSortText.setCharacterSize(20);
-    cycleSortText.setFillColor(sf::Color::Black);
-    cycleSortText.setPosition(20, 840);
-
-    sf::RectangleShape linearSearchButton(sf::Vector2f(150, 50));
-    linearSearchButton.setPosition(10, 290);
-    linearSearchButton.setFillColor(sf::Color(255, 160, 122)); // ... pastel orange ...
-
-    sf::Text linearSearchText;
-    linearSearchText.setFont(font);
-    linearSearchText.setString("Linear Search");
-    linearSearchText.setCharacterSize(20);
-    linearSearchText.setFillColor(sf::Color::Black);
-    linearSearchText.setPosition(20, 300);
-
-    sf::RectangleShape binarySearchButton(sf::Vector2f(150, 50));
-    binarySearchButton.setPosition(10, 350);
-    binarySearchButton.setFillColor(sf::Color(173, 216, 230)); // ... pastel blue ...
-
-    sf::Text binarySearchText;
-    binarySearchText.setFont(font);
-    binarySearchText.setString("Binary Search");
-    binarySearchText.setCharacterSize(20);
-    binarySearchText.setFillColor(sf::Color::Black);
-    binarySearchText.setPosition(20, 360);
-
-    sf::RectangleShape ternarySearchButton(sf::Vector2f(150, 50));
-    ternarySearchButton.setPosition(10, 410);
-    ternarySearchButton.setFillColor(sf::Color(221, 160, 221)); // ... pastel purple ...
-
-    sf::Text ternarySearchText;
-    ternarySearchText.setFont(font);
-    ternarySearchText.setString("Ternary Search");
-    ternarySearchText.setCharacterSize(20);
-    ternarySearchText.setFillColor(sf::Color::Black);
-    ternarySearchText.setPosition(20, 420);
-
-    sf::RectangleShape bfsButton(sf::Vector2f(150, 50));
-    bfsButton.setPosition(10, 290);
-    bfsButton.setFillColor(sf::Color(144, 238, 144)); // ... pastel green ...
-
-    sf::Text bfsText;
-    bfsText.setFont(font);
-    bfsText.setString("BFS");
-    bfsText.setCharacterSize(20);
-    bfsText.setFillColor(sf::Color::Black);
-    bfsText.setPosition(20, 300);
-
-    sf::RectangleShape dfsButton(sf::Vector2f(150, 50));
-    dfsButton.setPosition(10, 350);
-    dfsButton.setFillColor(sf::Color(255, 160, 122)); // ... pastel orange ...
-
-    sf::Text dfsText;
-    dfsText.setFont(font);
-    dfsText.setString("DFS");
-    dfsText.setCharacterSize(20);
-    dfsText.setFillColor(sf::Color::Black);
-    dfsText.setPosition(20, 360);
-
-    sf::Text searchValueText;
-    searchValueText.setFont(font);
-    searchValueText.setCharacterSize(20);
-    searchValueText.setFillColor(sf::Color::White);
-    searchValueText.setPosition(10, 790);
-
-    sf::Text targetNodeText;
-    targetNodeText.setFont(font);
-    targetNodeText.setCharacterSize(20);
-    targetNodeText.setFillColor(sf::Color::White);
-    targetNodeText.setPosition(10, 820);
+    initWidgets();
 
     resetArray();
     resetSearchArray();
-    tree = {
-        {1, 2}, {3, 4}, {5, 6}, {}, {}, {}, {}
-    };
+    treeParams.seed = visualSeed;
+    treeFromGraph(generateGraph(treeKind, treeParams));
     resetTree();
+    resetGrid();
+    if (servePort > 0 && startStreamServer(servePort)) {
+        streamSnapshot(array.data(), NUM_BARS, currentAlgorithm);
+    }
 
 //.....................................| Main loop |.....................................//
+    // Idle frames block in waitEvent, so a paused or finished run costs no CPU; while an algorithm
+    // is animating, the framerate limit paces display() instead of spinning.
+    window.setFramerateLimit(ANIMATION_FPS);
+    frameStatsText.setFont(font);
+    frameStatsText.setCharacterSize(14);
+    frameStatsText.setFillColor(sf::Color(160, 160, 160));
+    frameStatsText.setPosition(WINDOW_WIDTH - 330, 10);
+    scratchStatsText.setFont(font);
+    scratchStatsText.setCharacterSize(14);
+    scratchStatsText.setFillColor(sf::Color(160, 160, 160));
+    scratchStatsText.setPosition(345, 68); // -> right of the Reset button
+    gridStatsText.setFont(font);
+    gridStatsText.setCharacterSize(14);
+    gridStatsText.setFillColor(sf::Color(160, 160, 160));
+    gridStatsText.setPosition(345, 68);
+    hud.text.setFont(font);
+    hud.text.setCharacterSize(13);
+    hud.text.setFillColor(sf::Color(220, 220, 220));
+    hud.text.setPosition(HUD_X + 8, HUD_Y + 4);
+
+    auto lastFrame = std::chrono::steady_clock::now();
+    double lastRenderCpu = renderThreadCpuMs();
+    bool waited = false; // -> the loop blocked in waitEvent since the last frame, whose time is then not a frame time
     while (window.isOpen()) {
         sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-            }
-            if (event.type == sf::Event::MouseButtonPressed) {
-                sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
-                if (startButton.getGlobalBounds().contains(mousePos) && !isSorting && !isSearching && !isTreeTraversal) {
-                    if (visualizationType == "sort") {
-                        isSorting = true;
-                        std::thread sortingThread(startSorting);
-                        sortingThread.detach();
-                    } else if (visualizationType == "search") {
-                        isSearching = true;
-                        searchValue = array[rand() % MAX_ARRAY_SIZE];
-                        searchCompleted = false;
-                        std::thread searchThread(startSearching);
-                        searchThread.detach();
-                    } else if (visualizationType == "tree") {
-                        resetTree();
-                        isTreeTraversal = true;
-                        targetNode = rand() % tree.size();
-                        traversalCompleted = false;
-                        std::thread traversalThread(startTreeTraversal);
-                        traversalThread.detach();
-                    }
-                }
-                if (pauseButton.getGlobalBounds().contains(mousePos) && (isSorting || isSearching || isTreeTraversal)) {
-                    isPaused = !isPaused;
-                }
-                if (resetButton.getGlobalBounds().contains(mousePos)) {
-                    resetAll();
-                }
-                if (sortButton.getGlobalBounds().contains(mousePos)) {
-                    visualizationType = "sort";
-                    currentAlgorithm = "bubble";
-                    showDropdown = true;
-                }
-                if (searchButton.getGlobalBounds().contains(mousePos)) {
-                    visualizationType = "search";
-                    currentAlgorithm = "linear";
-                    showDropdown = true;
-                }
-                if (treeButton.getGlobalBounds().contains(mousePos)) {
-                    visualizationType = "tree";
-                    currentAlgorithm = "bfs";
-                    showDropdown = true;
-                }
-                if (bubbleSortButton.getGlobalBounds().contains(mousePos) && visualizationType == "sort") {
-                    currentAlgorithm = "bubble";
-                    showDropdown = false;
-                }
-                if (quickSortButton.getGlobalBounds().contains(mousePos) && visualizationType == "sort") {
-                    currentAlgorithm = "quick";
-                    showDropdown = false;
-                }
-                if (insertionSortButton.getGlobalBounds().contains(mousePos) && visualizationType == "sort") {
-                    currentAlgorithm = "insertion";
-                    showDropdown = false;
-                }
-                if (selectionSortButton.getGlobalBounds().contains(mousePos) && visualizationType == "sort") {
-                    currentAlgorithm = "selection";
-                    showDropdown = false;
-                }
-                if (mergeSortButton.getGlobalBounds().contains(mousePos) && visualizationType == "sort") {
-                    currentAlgorithm = "merge";
-                    showDropdown = false;
-                }
-                if (heapSortButton.getGlobalBounds().contains(mousePos) && visualizationType == "sort") {
-                    currentAlgorithm = "heap";
-                    showDropdown = false;
-                }
-                if (bucketSortButton.getGlobalBounds().contains(mousePos) && visualizationType == "sort") {
-                    currentAlgorithm = "bucket";
-                    showDropdown = false;
-                }
-                if (gnomeSortButton.getGlobalBounds().contains(mousePos) && visualizationType == "sort") {
-                    currentAlgorithm = "gnome";
-                    showDropdown = false;
-                }
-                if (timSortButton.getGlobalBounds().contains(mousePos) && visualizationType == "sort") {
-                    currentAlgorithm = "tim";
-                    showDropdown = false;
-                }
-                if (cycleSortButton.getGlobalBounds().contains(mousePos) && visualizationType == "sort") {
-                    currentAlgorithm = "cycle";
-                    showDropdown = false;
-                }
-                if (linearSearchButton.getGlobalBounds().contains(mousePos) && visualizationType == "search") {
-                    currentAlgorithm = "linear";
-                    showDropdown = false;
-                }
-                if (binarySearchButton.getGlobalBounds().contains(mousePos) && visualizationType == "search") {
-                    currentAlgorithm = "binary";
-                    showDropdown = false;
-                }
-                if (ternarySearchButton.getGlobalBounds().contains(mousePos) && visualizationType == "search") {
-                    currentAlgorithm = "ternary";
-                    showDropdown = false;
-                }
-                if (bfsButton.getGlobalBounds().contains(mousePos) && visualizationType == "tree") {
-                    currentAlgorithm = "bfs";
-                    showDropdown = false;
-                }
-                if (dfsButton.getGlobalBounds().contains(mousePos) && visualizationType == "tree") {
-                    currentAlgorithm = "dfs";
-                    showDropdown = false;
-                }
+        if (!isAnimating() && !uiDirty && !sceneDirty) {
+            TraceSpan idle("wait event", "frame");
+            waited = true;
+            if (window.waitEvent(event)) {
+                handleEvent(window, event);
             }
+            lastFrame = std::chrono::steady_clock::now(); // -> the idle stretch is not part of the next frame's time or CPU share
+            lastRenderCpu = renderThreadCpuMs();
+        }
+        while (window.pollEvent(event)) {
+            TraceSpan span("event", "frame");
+            handleEvent(window, event);
+        }
+        frameStats.wakeups++;
+        if (!window.isOpen()) {
+            break;
         }
 
-        algorithmText.setString("Algorithm: " + currentAlgorithm);
-        searchValueText.setString("Number searched: " + std::to_string(searchValue));
-        targetNodeText.setString("Target node: " + std::to_string(targetNode));
+        bool dirty = sceneDirty.exchange(false);
+        if (!isAnimating() && !uiDirty && !dirty) {
+            continue;
+        }
 
-        window.clear(sf::Color(30, 30, 30)); // ... dark background ...
-
-        if (visualizationType == "sort") {
-            drawArray(window);
-        } else if (visualizationType == "tree") {
-            drawTree(window);
-        } else if (visualizationType == "search") {
-            drawBoxes(window);
-            window.draw(searchValueText);
-        }
-
-        window.draw(startButton); // -> drawing stuff on screen
-        window.draw(startText);
-        window.draw(pauseButton);
-        window.draw(pauseText);
-        window.draw(resetButton);
-        window.draw(resetText);
-        window.draw(sortButton);
-        window.draw(sortText);
-        window.draw(searchButton);
-        window.draw(searchText);
-        window.draw(treeButton);
-        window.draw(treeText);
-
-        if (showDropdown) {
-            if (visualizationType == "sort") {
-                window.draw(bubbleSortButton);
-                window.draw(bubbleSortText);
-                window.draw(quickSortButton);
-                window.draw(quickSortText);
-                window.draw(insertionSortButton);
-                window.draw(insertionSortText);
-                window.draw(selectionSortButton);
-                window.draw(selectionSortText);
-                window.draw(mergeSortButton);
-                window.draw(mergeSortText);
-                window.draw(heapSortButton);
-                window.draw(heapSortText);
-                window.draw(bucketSortButton);
-                window.draw(bucketSortText);
-                window.draw(gnomeSortButton);
-                window.draw(gnomeSortText);
-                window.draw(timSortButton);
-                window.draw(timSortText);
-                window.draw(cycleSortButton);
-                window.draw(cycleSortText);
-            } else if (visualizationType == "search") {
-                window.draw(linearSearchButton);
-                window.draw(linearSearchText);
-                window.draw(binarySearchButton);
-                window.draw(binarySearchText);
-                window.draw(ternarySearchButton);
-                window.draw(ternarySearchText);
+        auto renderStart = std::chrono::steady_clock::now();
+        {
+            TraceSpan draw("draw", "frame");
+            char line[192]; // -> overlay texts are built before drawing, so they show this frame's counters
+            std::snprintf(line, sizeof(line), "frame %.1f ms (avg %.1f) | render %.2f ms | cpu %.0f%%",
+                          frameStats.frameMs, frameStats.avgFrameMs, frameStats.renderMs, frameStats.cpuPercent);
+            frameStatsText.setString(line);
+            std::snprintf(line, sizeof(line), "scratch %.1f KB live, %.1f KB peak | %.1f KB total, %zu heap blocks",
+                          scratchStats.live / 1024.0, scratchStats.peak / 1024.0, scratchStats.total / 1024.0, scratchStats.blocks.load());
+            int choice = autoDecision.choice;
+            if (visualizationType == "sort" && currentSort == SortId::Auto && choice >= 0) {
+                std::size_t used = std::strlen(line);
+                std::snprintf(line + used, sizeof(line) - used, " | auto: %s (%lld runs, %d%% dup)",
+                              choice == int(SortId::Auto) ? "already sorted" : sortEntry(SortId(choice)).label, (long long)autoDecision.runs.load(),
+                              autoDecision.duplicatePercent.load());
+            }
+            if (visualizationType == "stream") {
+                std::snprintf(line, sizeof(line), "stream %lld keys, %lld visible | %.0f keys/s | insert p50 %lld ns, p99 %lld ns",
+                              streamStatus.inserted.load(), streamStatus.visible.load(), streamStatus.keysPerSecond.load(),
+                              streamStatus.p50Ns.load(), streamStatus.p99Ns.load());
+            }
+            scratchStatsText.setString(line);
+            Distance cost = gridView.cost;
+            if (currentTraversal == TraversalId::Components) {
+                std::snprintf(line, sizeof(line), "components %lld", (long long)gridView.labels.load());
+            } else if (currentTraversal == TraversalId::Topological) {
+                std::snprintf(line, sizeof(line), "levels %lld | ordered %lld cells", (long long)gridView.labels.load(),
+                              (long long)gridView.settled.load());
+            } else {
+                std::snprintf(line, sizeof(line), "frontier %lld | settled %lld | relaxations %llu | path cost %s",
+                              (long long)gridView.frontier.load(), (long long)gridView.settled.load(), gridView.relaxations.load(),
+                              cost == UNREACHED ? "-" : std::to_string(cost).c_str());
+            }
+            gridStatsText.setString(line);
+
+            if (uiDirty) {
+                TraceSpan chrome("redraw chrome", "frame");
+                redrawChrome();
+            }
+
+            window.clear(sf::Color(30, 30, 30)); // ... dark background ...
+
+            if (visualizationType == "sort" || visualizationType == "select" || visualizationType == "stream") {
+                drawArray(window);
+                drawTournament(window);
+                drawNetwork(window);
+            } else if (visualizationType == "tree" && traversalEntry(currentTraversal).grid) {
+                drawGrid(window);
             } else if (visualizationType == "tree") {
-                window.draw(bfsButton);
-                window.draw(bfsText);
-                window.draw(dfsButton);
-                window.draw(dfsText);
+                drawTree(window);
+            } else if (visualizationType == "search") {
+                drawBoxes(window);
             }
-        }
 
-        window.draw(algorithmText);
-        if (visualizationType == "search") {
-            window.draw(searchValueText);
+            window.draw(chromeSprite); // -> the cached toolbar, dropdown and labels in one draw call
+            window.draw(frameStatsText);
+            if (visualizationType == "sort" || visualizationType == "select" || visualizationType == "stream") {
+                window.draw(scratchStatsText);
+            } else if (visualizationType == "tree" && traversalEntry(currentTraversal).grid) {
+                window.draw(gridStatsText);
+            }
+            if (hud.visible) {
+                drawHud(window);
+            }
         }
-        if (visualizationType == "tree") {
-            window.draw(targetNodeText);
+
+        auto renderEnd = std::chrono::steady_clock::now();
+        {
+            TraceSpan present("display", "frame");
+            window.display();
         }
 
-        window.display();
+        auto now = std::chrono::steady_clock::now();
+        double wallMs = std::chrono::duration<double, std::milli>(now - lastFrame).count();
+        double renderCpu = renderThreadCpuMs();
+        double cpuMs = renderCpu >= 0.0 && lastRenderCpu >= 0.0 ? renderCpu - lastRenderCpu : 0.0;
+        frameStats.frameMs = wallMs;
+        frameStats.avgFrameMs = frameStats.framesRendered == 0 ? wallMs : 0.9 * frameStats.avgFrameMs + 0.1 * wallMs;
+        frameStats.renderMs = std::chrono::duration<double, std::milli>(renderEnd - renderStart).count();
+        frameStats.cpuPercent = wallMs > 0.0 ? 100.0 * cpuMs / wallMs : 0.0;
+        frameStats.framesRendered++;
+        traceCounter("frame ms", wallMs);
+        hudRecordFrame(wallMs, cpuMs, waited);
+        waited = false;
+        lastFrame = now;
+        lastRenderCpu = renderCpu;
+
+    }
+
+    runGeneration++; // -> let a running algorithm wind down before its globals are destroyed
+    wakeRuns();
+    if (currentThread.joinable()) {
+        currentThread.join();
+    }
+    stopStreamServer();
+    if (traceEnabled) {
+        if (writeTrace(tracePath)) {
+            std::cout << "trace written to " << tracePath << std::endl;
+        } else {
+            std::cerr << "cannot write trace " << tracePath << "\n";
+        }
     }
 
     return 0;
@@ -1534,4 +9342,4 @@ int main() {
 //@Feri, 2025. All rights reserved.
 
 //.....................................| Generic Compile command |.....................................//
-// g++ -o main29.exe algori.cpp -lsfml-graphics -lsfml-window -lsfml-system -lopengl32 -lglu32 -mwindows
+// g++ -std=c++17 -O2 -o main29.exe algori.cpp -lsfml-graphics -lsfml-window -lsfml-system -lopengl32 -lglu32 -mwindows